@@ -129,6 +129,110 @@
 //   </e>
 #endif /* LPUART1_IT_ENABLE */
 
+//   <e> Enable LPUART1 Hardware FIFO
+//   <i>  8-byte Tx and Rx FIFO of USART, the interrupt moves a whole
+//   <i>  threshold level instead of one byte. Needs LPUART1 interrupt.
+#define LPUART1_FIFO_ENABLE        0
+
+#if LPUART1_FIFO_ENABLE
+
+//     <o LPUART1_RX_FIFO_THRESHOLD> Rx FIFO Threshold
+//      <UART_RXFIFO_THRESHOLD_1_8=>1/8
+//      <UART_RXFIFO_THRESHOLD_1_4=>1/4
+//      <UART_RXFIFO_THRESHOLD_1_2=>1/2
+//      <UART_RXFIFO_THRESHOLD_3_4=>3/4
+//      <UART_RXFIFO_THRESHOLD_7_8=>7/8
+//      <UART_RXFIFO_THRESHOLD_8_8=>8/8
+//     <i>  Rx interrupt when the FIFO reaches this level
+#define LPUART1_RX_FIFO_THRESHOLD  UART_RXFIFO_THRESHOLD_1_2
+
+//     <o LPUART1_TX_FIFO_THRESHOLD> Tx FIFO Threshold
+//      <UART_TXFIFO_THRESHOLD_1_8=>1/8
+//      <UART_TXFIFO_THRESHOLD_1_4=>1/4
+//      <UART_TXFIFO_THRESHOLD_1_2=>1/2
+//      <UART_TXFIFO_THRESHOLD_3_4=>3/4
+//      <UART_TXFIFO_THRESHOLD_7_8=>7/8
+//      <UART_TXFIFO_THRESHOLD_8_8=>8/8
+//     <i>  Tx interrupt when the FIFO drops to this level
+#define LPUART1_TX_FIFO_THRESHOLD  UART_TXFIFO_THRESHOLD_1_2
+
+//   </e>
+#endif /* LPUART1_FIFO_ENABLE */
+
+//   <e> Enable LPUART1 Interrupt RX
+//   <i>  Receive into the fifo by Rx interrupt when DMA Rx is disabled,
+//   <i>  `uart_dmarx_read` works the same way. Needs LPUART1 interrupt.
+#define LPUART1_RX_IT              0
+
+#if LPUART1_RX_IT
+
+//     <o> The size of Receive FIFO [byte] (Must be power of 2)
+#define LPUART1_RX_IT_FIFO_SIZE    256
+
+//   </e>
+#endif /* LPUART1_RX_IT */
+
+//   <o> LPUART1 Bus Mode
+//       <0=>Full duplex <1=>RS-485 <2=>Single-wire half-duplex
+//   <i>  RS-485: RTS pin is the hardware driver enable (DE).
+//   <i>  Single-wire: TX pin (open drain) is used for both directions.
+//   <i>  Rx is suspended while transmitting in both modes.
+#define LPUART1_BUS_MODE           0
+
+#if (LPUART1_BUS_MODE == 1)
+
+//   <o> DE assertion time [1/16 bit] <0-31>
+//   <i>  Time from DE active to the start bit
+#define LPUART1_DE_ASSERT_TIME     8
+
+//   <o> DE deassertion time [1/16 bit] <0-31>
+//   <i>  Time from the end of last stop bit to DE inactive
+#define LPUART1_DE_DEASSERT_TIME   8
+
+#endif /* LPUART1_BUS_MODE */
+
+//   <e> Enable LPUART1 Mute Mode
+//   <i>  The receiver stays muted until a frame for this node, other
+//   <i>  frames never reach DMA Rx or wake the CPU.
+#define LPUART1_MUTE_MODE          0
+
+#if LPUART1_MUTE_MODE
+
+//     <o> Wakeup Method <0=>Address mark <1=>Idle line
+//     <i>  Address mark: bytes with MSB set are addresses, the receiver
+//     <i>  wakes on its own address and mutes on the others.
+//     <i>  Idle line: wakes on idle line, mute again by `uart_mute`.
+#define LPUART1_MUTE_WAKEUP        0
+
+//     <o> Address Length <0=>4-bit <1=>7-bit
+#define LPUART1_MUTE_ADDR_7BIT     1
+
+//     <o> Node Address <0-127>
+#define LPUART1_MUTE_ADDRESS       1
+
+//   </e>
+#endif /* LPUART1_MUTE_MODE */
+
+//   <e> Enable LPUART1 Character Match
+//   <i>  Deliver the received data as soon as this character arrives,
+//   <i>  without waiting for the idle line. Needs LPUART1 interrupt.
+#define LPUART1_CHAR_MATCH         0
+
+#if LPUART1_CHAR_MATCH
+
+//     <o> Match Character <0x00-0xFF>
+//     <i>  Such as 0x0A ('\n') or the frame terminator.
+#define LPUART1_MATCH_CHAR         0x0A
+
+//   </e>
+#endif /* LPUART1_CHAR_MATCH */
+
+//   <q> Retarget stdio to LPUART1
+//   <i>  newlib `printf`, `puts`, `fgets`... use LPUART1 by `_write`,
+//   <i>  `_read` and `_isatty`, on DMA Tx and Rx if they are enabled.
+//   <i>  Only one UART can be selected.
+#define LPUART1_STDIO              0
+
 //   <e> Enable LPUART1 DMA RX
 #define LPUART1_RX_DMA             0
 
@@ -166,6 +270,11 @@
 //     <i>  Using FIFO and Buf to implement high reliable UART Receive
 #define LPUART1_RX_DMA_FIFO_SIZE   256
 
+//     <q> Zero-copy receive
+//     <i>  Read straight from the DMA buffer by `uart_dmarx_peek` and
+//     <i>  `uart_dmarx_commit`, the receive FIFO is not allocated.
+#define LPUART1_RX_DMA_ZERO_COPY   0
+
 //   </e>
 
 #endif  /* LPUART1_RX_DMA */
@@ -201,6 +310,8 @@
 
 //     <o> The size of transmit buf [byte]
 //     <i>  Write data to Send buf, and sending with thread safety
+//     <i>  Two banks of this size are allocated, one is written while DMA
+//     <i>  is transferring the other. Needs LPUART1 Interrupt enabled.
 #define LPUART1_TX_DMA_BUF_SIZE    256
 
 //   </e>
@@ -315,6 +426,110 @@
 //   </e>
 #endif /* USART1_IT_ENABLE */
 
+//   <e> Enable USART1 Hardware FIFO
+//   <i>  8-byte Tx and Rx FIFO of USART, the interrupt moves a whole
+//   <i>  threshold level instead of one byte. Needs USART1 interrupt.
+#define USART1_FIFO_ENABLE        0
+
+#if USART1_FIFO_ENABLE
+
+//     <o USART1_RX_FIFO_THRESHOLD> Rx FIFO Threshold
+//      <UART_RXFIFO_THRESHOLD_1_8=>1/8
+//      <UART_RXFIFO_THRESHOLD_1_4=>1/4
+//      <UART_RXFIFO_THRESHOLD_1_2=>1/2
+//      <UART_RXFIFO_THRESHOLD_3_4=>3/4
+//      <UART_RXFIFO_THRESHOLD_7_8=>7/8
+//      <UART_RXFIFO_THRESHOLD_8_8=>8/8
+//     <i>  Rx interrupt when the FIFO reaches this level
+#define USART1_RX_FIFO_THRESHOLD  UART_RXFIFO_THRESHOLD_1_2
+
+//     <o USART1_TX_FIFO_THRESHOLD> Tx FIFO Threshold
+//      <UART_TXFIFO_THRESHOLD_1_8=>1/8
+//      <UART_TXFIFO_THRESHOLD_1_4=>1/4
+//      <UART_TXFIFO_THRESHOLD_1_2=>1/2
+//      <UART_TXFIFO_THRESHOLD_3_4=>3/4
+//      <UART_TXFIFO_THRESHOLD_7_8=>7/8
+//      <UART_TXFIFO_THRESHOLD_8_8=>8/8
+//     <i>  Tx interrupt when the FIFO drops to this level
+#define USART1_TX_FIFO_THRESHOLD  UART_TXFIFO_THRESHOLD_1_2
+
+//   </e>
+#endif /* USART1_FIFO_ENABLE */
+
+//   <e> Enable USART1 Interrupt RX
+//   <i>  Receive into the fifo by Rx interrupt when DMA Rx is disabled,
+//   <i>  `uart_dmarx_read` works the same way. Needs USART1 interrupt.
+#define USART1_RX_IT              0
+
+#if USART1_RX_IT
+
+//     <o> The size of Receive FIFO [byte] (Must be power of 2)
+#define USART1_RX_IT_FIFO_SIZE    256
+
+//   </e>
+#endif /* USART1_RX_IT */
+
+//   <o> USART1 Bus Mode
+//       <0=>Full duplex <1=>RS-485 <2=>Single-wire half-duplex
+//   <i>  RS-485: RTS pin is the hardware driver enable (DE).
+//   <i>  Single-wire: TX pin (open drain) is used for both directions.
+//   <i>  Rx is suspended while transmitting in both modes.
+#define USART1_BUS_MODE           0
+
+#if (USART1_BUS_MODE == 1)
+
+//   <o> DE assertion time [1/16 bit] <0-31>
+//   <i>  Time from DE active to the start bit
+#define USART1_DE_ASSERT_TIME     8
+
+//   <o> DE deassertion time [1/16 bit] <0-31>
+//   <i>  Time from the end of last stop bit to DE inactive
+#define USART1_DE_DEASSERT_TIME   8
+
+#endif /* USART1_BUS_MODE */
+
+//   <e> Enable USART1 Mute Mode
+//   <i>  The receiver stays muted until a frame for this node, other
+//   <i>  frames never reach DMA Rx or wake the CPU.
+#define USART1_MUTE_MODE          0
+
+#if USART1_MUTE_MODE
+
+//     <o> Wakeup Method <0=>Address mark <1=>Idle line
+//     <i>  Address mark: bytes with MSB set are addresses, the receiver
+//     <i>  wakes on its own address and mutes on the others.
+//     <i>  Idle line: wakes on idle line, mute again by `uart_mute`.
+#define USART1_MUTE_WAKEUP        0
+
+//     <o> Address Length <0=>4-bit <1=>7-bit
+#define USART1_MUTE_ADDR_7BIT     1
+
+//     <o> Node Address <0-127>
+#define USART1_MUTE_ADDRESS       1
+
+//   </e>
+#endif /* USART1_MUTE_MODE */
+
+//   <e> Enable USART1 Character Match
+//   <i>  Deliver the received data as soon as this character arrives,
+//   <i>  without waiting for the idle line. Needs USART1 interrupt.
+#define USART1_CHAR_MATCH         0
+
+#if USART1_CHAR_MATCH
+
+//     <o> Match Character <0x00-0xFF>
+//     <i>  Such as 0x0A ('\n') or the frame terminator.
+#define USART1_MATCH_CHAR         0x0A
+
+//   </e>
+#endif /* USART1_CHAR_MATCH */
+
+//   <q> Retarget stdio to USART1
+//   <i>  newlib `printf`, `puts`, `fgets`... use USART1 by `_write`,
+//   <i>  `_read` and `_isatty`, on DMA Tx and Rx if they are enabled.
+//   <i>  Only one UART can be selected.
+#define USART1_STDIO              0
+
 //   <e> Enable USART1 DMA RX
 #define USART1_RX_DMA             0
 
@@ -352,6 +567,11 @@
 //     <i>  Using FIFO and Buf to implement high reliable UART Receive
 #define USART1_RX_DMA_FIFO_SIZE   256
 
+//     <q> Zero-copy receive
+//     <i>  Read straight from the DMA buffer by `uart_dmarx_peek` and
+//     <i>  `uart_dmarx_commit`, the receive FIFO is not allocated.
+#define USART1_RX_DMA_ZERO_COPY   0
+
 //   </e>
 
 #endif  /* USART1_RX_DMA */
@@ -387,6 +607,8 @@
 
 //     <o> The size of transmit buf [byte]
 //     <i>  Write data to Send buf, and sending with thread safety
+//     <i>  Two banks of this size are allocated, one is written while DMA
+//     <i>  is transferring the other. Needs USART1 Interrupt enabled.
 #define USART1_TX_DMA_BUF_SIZE    256
 
 //   </e>
@@ -505,6 +727,110 @@
 //   </e>
 #endif /* USART2_IT_ENABLE */
 
+//   <e> Enable USART2 Hardware FIFO
+//   <i>  8-byte Tx and Rx FIFO of USART, the interrupt moves a whole
+//   <i>  threshold level instead of one byte. Needs USART2 interrupt.
+#define USART2_FIFO_ENABLE        0
+
+#if USART2_FIFO_ENABLE
+
+//     <o USART2_RX_FIFO_THRESHOLD> Rx FIFO Threshold
+//      <UART_RXFIFO_THRESHOLD_1_8=>1/8
+//      <UART_RXFIFO_THRESHOLD_1_4=>1/4
+//      <UART_RXFIFO_THRESHOLD_1_2=>1/2
+//      <UART_RXFIFO_THRESHOLD_3_4=>3/4
+//      <UART_RXFIFO_THRESHOLD_7_8=>7/8
+//      <UART_RXFIFO_THRESHOLD_8_8=>8/8
+//     <i>  Rx interrupt when the FIFO reaches this level
+#define USART2_RX_FIFO_THRESHOLD  UART_RXFIFO_THRESHOLD_1_2
+
+//     <o USART2_TX_FIFO_THRESHOLD> Tx FIFO Threshold
+//      <UART_TXFIFO_THRESHOLD_1_8=>1/8
+//      <UART_TXFIFO_THRESHOLD_1_4=>1/4
+//      <UART_TXFIFO_THRESHOLD_1_2=>1/2
+//      <UART_TXFIFO_THRESHOLD_3_4=>3/4
+//      <UART_TXFIFO_THRESHOLD_7_8=>7/8
+//      <UART_TXFIFO_THRESHOLD_8_8=>8/8
+//     <i>  Tx interrupt when the FIFO drops to this level
+#define USART2_TX_FIFO_THRESHOLD  UART_TXFIFO_THRESHOLD_1_2
+
+//   </e>
+#endif /* USART2_FIFO_ENABLE */
+
+//   <e> Enable USART2 Interrupt RX
+//   <i>  Receive into the fifo by Rx interrupt when DMA Rx is disabled,
+//   <i>  `uart_dmarx_read` works the same way. Needs USART2 interrupt.
+#define USART2_RX_IT              0
+
+#if USART2_RX_IT
+
+//     <o> The size of Receive FIFO [byte] (Must be power of 2)
+#define USART2_RX_IT_FIFO_SIZE    256
+
+//   </e>
+#endif /* USART2_RX_IT */
+
+//   <o> USART2 Bus Mode
+//       <0=>Full duplex <1=>RS-485 <2=>Single-wire half-duplex
+//   <i>  RS-485: RTS pin is the hardware driver enable (DE).
+//   <i>  Single-wire: TX pin (open drain) is used for both directions.
+//   <i>  Rx is suspended while transmitting in both modes.
+#define USART2_BUS_MODE           0
+
+#if (USART2_BUS_MODE == 1)
+
+//   <o> DE assertion time [1/16 bit] <0-31>
+//   <i>  Time from DE active to the start bit
+#define USART2_DE_ASSERT_TIME     8
+
+//   <o> DE deassertion time [1/16 bit] <0-31>
+//   <i>  Time from the end of last stop bit to DE inactive
+#define USART2_DE_DEASSERT_TIME   8
+
+#endif /* USART2_BUS_MODE */
+
+//   <e> Enable USART2 Mute Mode
+//   <i>  The receiver stays muted until a frame for this node, other
+//   <i>  frames never reach DMA Rx or wake the CPU.
+#define USART2_MUTE_MODE          0
+
+#if USART2_MUTE_MODE
+
+//     <o> Wakeup Method <0=>Address mark <1=>Idle line
+//     <i>  Address mark: bytes with MSB set are addresses, the receiver
+//     <i>  wakes on its own address and mutes on the others.
+//     <i>  Idle line: wakes on idle line, mute again by `uart_mute`.
+#define USART2_MUTE_WAKEUP        0
+
+//     <o> Address Length <0=>4-bit <1=>7-bit
+#define USART2_MUTE_ADDR_7BIT     1
+
+//     <o> Node Address <0-127>
+#define USART2_MUTE_ADDRESS       1
+
+//   </e>
+#endif /* USART2_MUTE_MODE */
+
+//   <e> Enable USART2 Character Match
+//   <i>  Deliver the received data as soon as this character arrives,
+//   <i>  without waiting for the idle line. Needs USART2 interrupt.
+#define USART2_CHAR_MATCH         0
+
+#if USART2_CHAR_MATCH
+
+//     <o> Match Character <0x00-0xFF>
+//     <i>  Such as 0x0A ('\n') or the frame terminator.
+#define USART2_MATCH_CHAR         0x0A
+
+//   </e>
+#endif /* USART2_CHAR_MATCH */
+
+//   <q> Retarget stdio to USART2
+//   <i>  newlib `printf`, `puts`, `fgets`... use USART2 by `_write`,
+//   <i>  `_read` and `_isatty`, on DMA Tx and Rx if they are enabled.
+//   <i>  Only one UART can be selected.
+#define USART2_STDIO              0
+
 //   <e> Enable USART2 DMA RX
 #define USART2_RX_DMA             0
 
@@ -542,6 +868,11 @@
 //     <i>  Using FIFO and Buf to implement high reliable UART Receive
 #define USART2_RX_DMA_FIFO_SIZE   256
 
+//     <q> Zero-copy receive
+//     <i>  Read straight from the DMA buffer by `uart_dmarx_peek` and
+//     <i>  `uart_dmarx_commit`, the receive FIFO is not allocated.
+#define USART2_RX_DMA_ZERO_COPY   0
+
 //   </e>
 
 #endif  /* USART2_RX_DMA */
@@ -577,6 +908,8 @@
 
 //     <o> The size of transmit buf [byte]
 //     <i>  Write data to Send buf, and sending with thread safety
+//     <i>  Two banks of this size are allocated, one is written while DMA
+//     <i>  is transferring the other. Needs USART2 Interrupt enabled.
 #define USART2_TX_DMA_BUF_SIZE    256
 
 //   </e>
@@ -707,6 +1040,110 @@
 //   </e>
 #endif /* USART3_IT_ENABLE */
 
+//   <e> Enable USART3 Hardware FIFO
+//   <i>  8-byte Tx and Rx FIFO of USART, the interrupt moves a whole
+//   <i>  threshold level instead of one byte. Needs USART3 interrupt.
+#define USART3_FIFO_ENABLE        0
+
+#if USART3_FIFO_ENABLE
+
+//     <o USART3_RX_FIFO_THRESHOLD> Rx FIFO Threshold
+//      <UART_RXFIFO_THRESHOLD_1_8=>1/8
+//      <UART_RXFIFO_THRESHOLD_1_4=>1/4
+//      <UART_RXFIFO_THRESHOLD_1_2=>1/2
+//      <UART_RXFIFO_THRESHOLD_3_4=>3/4
+//      <UART_RXFIFO_THRESHOLD_7_8=>7/8
+//      <UART_RXFIFO_THRESHOLD_8_8=>8/8
+//     <i>  Rx interrupt when the FIFO reaches this level
+#define USART3_RX_FIFO_THRESHOLD  UART_RXFIFO_THRESHOLD_1_2
+
+//     <o USART3_TX_FIFO_THRESHOLD> Tx FIFO Threshold
+//      <UART_TXFIFO_THRESHOLD_1_8=>1/8
+//      <UART_TXFIFO_THRESHOLD_1_4=>1/4
+//      <UART_TXFIFO_THRESHOLD_1_2=>1/2
+//      <UART_TXFIFO_THRESHOLD_3_4=>3/4
+//      <UART_TXFIFO_THRESHOLD_7_8=>7/8
+//      <UART_TXFIFO_THRESHOLD_8_8=>8/8
+//     <i>  Tx interrupt when the FIFO drops to this level
+#define USART3_TX_FIFO_THRESHOLD  UART_TXFIFO_THRESHOLD_1_2
+
+//   </e>
+#endif /* USART3_FIFO_ENABLE */
+
+//   <e> Enable USART3 Interrupt RX
+//   <i>  Receive into the fifo by Rx interrupt when DMA Rx is disabled,
+//   <i>  `uart_dmarx_read` works the same way. Needs USART3 interrupt.
+#define USART3_RX_IT              0
+
+#if USART3_RX_IT
+
+//     <o> The size of Receive FIFO [byte] (Must be power of 2)
+#define USART3_RX_IT_FIFO_SIZE    256
+
+//   </e>
+#endif /* USART3_RX_IT */
+
+//   <o> USART3 Bus Mode
+//       <0=>Full duplex <1=>RS-485 <2=>Single-wire half-duplex
+//   <i>  RS-485: RTS pin is the hardware driver enable (DE).
+//   <i>  Single-wire: TX pin (open drain) is used for both directions.
+//   <i>  Rx is suspended while transmitting in both modes.
+#define USART3_BUS_MODE           0
+
+#if (USART3_BUS_MODE == 1)
+
+//   <o> DE assertion time [1/16 bit] <0-31>
+//   <i>  Time from DE active to the start bit
+#define USART3_DE_ASSERT_TIME     8
+
+//   <o> DE deassertion time [1/16 bit] <0-31>
+//   <i>  Time from the end of last stop bit to DE inactive
+#define USART3_DE_DEASSERT_TIME   8
+
+#endif /* USART3_BUS_MODE */
+
+//   <e> Enable USART3 Mute Mode
+//   <i>  The receiver stays muted until a frame for this node, other
+//   <i>  frames never reach DMA Rx or wake the CPU.
+#define USART3_MUTE_MODE          0
+
+#if USART3_MUTE_MODE
+
+//     <o> Wakeup Method <0=>Address mark <1=>Idle line
+//     <i>  Address mark: bytes with MSB set are addresses, the receiver
+//     <i>  wakes on its own address and mutes on the others.
+//     <i>  Idle line: wakes on idle line, mute again by `uart_mute`.
+#define USART3_MUTE_WAKEUP        0
+
+//     <o> Address Length <0=>4-bit <1=>7-bit
+#define USART3_MUTE_ADDR_7BIT     1
+
+//     <o> Node Address <0-127>
+#define USART3_MUTE_ADDRESS       1
+
+//   </e>
+#endif /* USART3_MUTE_MODE */
+
+//   <e> Enable USART3 Character Match
+//   <i>  Deliver the received data as soon as this character arrives,
+//   <i>  without waiting for the idle line. Needs USART3 interrupt.
+#define USART3_CHAR_MATCH         0
+
+#if USART3_CHAR_MATCH
+
+//     <o> Match Character <0x00-0xFF>
+//     <i>  Such as 0x0A ('\n') or the frame terminator.
+#define USART3_MATCH_CHAR         0x0A
+
+//   </e>
+#endif /* USART3_CHAR_MATCH */
+
+//   <q> Retarget stdio to USART3
+//   <i>  newlib `printf`, `puts`, `fgets`... use USART3 by `_write`,
+//   <i>  `_read` and `_isatty`, on DMA Tx and Rx if they are enabled.
+//   <i>  Only one UART can be selected.
+#define USART3_STDIO              0
+
 //   <e> Enable USART3 DMA RX
 #define USART3_RX_DMA             0
 
@@ -744,6 +1181,11 @@
 //     <i>  Using FIFO and Buf to implement high reliable UART Receive
 #define USART3_RX_DMA_FIFO_SIZE   256
 
+//     <q> Zero-copy receive
+//     <i>  Read straight from the DMA buffer by `uart_dmarx_peek` and
+//     <i>  `uart_dmarx_commit`, the receive FIFO is not allocated.
+#define USART3_RX_DMA_ZERO_COPY   0
+
 //   </e>
 
 #endif  /* USART3_RX_DMA */
@@ -779,6 +1221,8 @@
 
 //     <o> The size of transmit buf [byte]
 //     <i>  Write data to Send buf, and sending with thread safety
+//     <i>  Two banks of this size are allocated, one is written while DMA
+//     <i>  is transferring the other. Needs USART3 Interrupt enabled.
 #define USART3_TX_DMA_BUF_SIZE    256
 
 //   </e>
@@ -865,6 +1309,110 @@
 //   </e>
 #endif /* UART4_IT_ENABLE */
 
+//   <e> Enable UART4 Hardware FIFO
+//   <i>  8-byte Tx and Rx FIFO of USART, the interrupt moves a whole
+//   <i>  threshold level instead of one byte. Needs UART4 interrupt.
+#define UART4_FIFO_ENABLE        0
+
+#if UART4_FIFO_ENABLE
+
+//     <o UART4_RX_FIFO_THRESHOLD> Rx FIFO Threshold
+//      <UART_RXFIFO_THRESHOLD_1_8=>1/8
+//      <UART_RXFIFO_THRESHOLD_1_4=>1/4
+//      <UART_RXFIFO_THRESHOLD_1_2=>1/2
+//      <UART_RXFIFO_THRESHOLD_3_4=>3/4
+//      <UART_RXFIFO_THRESHOLD_7_8=>7/8
+//      <UART_RXFIFO_THRESHOLD_8_8=>8/8
+//     <i>  Rx interrupt when the FIFO reaches this level
+#define UART4_RX_FIFO_THRESHOLD  UART_RXFIFO_THRESHOLD_1_2
+
+//     <o UART4_TX_FIFO_THRESHOLD> Tx FIFO Threshold
+//      <UART_TXFIFO_THRESHOLD_1_8=>1/8
+//      <UART_TXFIFO_THRESHOLD_1_4=>1/4
+//      <UART_TXFIFO_THRESHOLD_1_2=>1/2
+//      <UART_TXFIFO_THRESHOLD_3_4=>3/4
+//      <UART_TXFIFO_THRESHOLD_7_8=>7/8
+//      <UART_TXFIFO_THRESHOLD_8_8=>8/8
+//     <i>  Tx interrupt when the FIFO drops to this level
+#define UART4_TX_FIFO_THRESHOLD  UART_TXFIFO_THRESHOLD_1_2
+
+//   </e>
+#endif /* UART4_FIFO_ENABLE */
+
+//   <e> Enable UART4 Interrupt RX
+//   <i>  Receive into the fifo by Rx interrupt when DMA Rx is disabled,
+//   <i>  `uart_dmarx_read` works the same way. Needs UART4 interrupt.
+#define UART4_RX_IT              0
+
+#if UART4_RX_IT
+
+//     <o> The size of Receive FIFO [byte] (Must be power of 2)
+#define UART4_RX_IT_FIFO_SIZE    256
+
+//   </e>
+#endif /* UART4_RX_IT */
+
+//   <o> UART4 Bus Mode
+//       <0=>Full duplex <1=>RS-485 <2=>Single-wire half-duplex
+//   <i>  RS-485: RTS pin is the hardware driver enable (DE).
+//   <i>  Single-wire: TX pin (open drain) is used for both directions.
+//   <i>  Rx is suspended while transmitting in both modes.
+#define UART4_BUS_MODE           0
+
+#if (UART4_BUS_MODE == 1)
+
+//   <o> DE assertion time [1/16 bit] <0-31>
+//   <i>  Time from DE active to the start bit
+#define UART4_DE_ASSERT_TIME     8
+
+//   <o> DE deassertion time [1/16 bit] <0-31>
+//   <i>  Time from the end of last stop bit to DE inactive
+#define UART4_DE_DEASSERT_TIME   8
+
+#endif /* UART4_BUS_MODE */
+
+//   <e> Enable UART4 Mute Mode
+//   <i>  The receiver stays muted until a frame for this node, other
+//   <i>  frames never reach DMA Rx or wake the CPU.
+#define UART4_MUTE_MODE          0
+
+#if UART4_MUTE_MODE
+
+//     <o> Wakeup Method <0=>Address mark <1=>Idle line
+//     <i>  Address mark: bytes with MSB set are addresses, the receiver
+//     <i>  wakes on its own address and mutes on the others.
+//     <i>  Idle line: wakes on idle line, mute again by `uart_mute`.
+#define UART4_MUTE_WAKEUP        0
+
+//     <o> Address Length <0=>4-bit <1=>7-bit
+#define UART4_MUTE_ADDR_7BIT     1
+
+//     <o> Node Address <0-127>
+#define UART4_MUTE_ADDRESS       1
+
+//   </e>
+#endif /* UART4_MUTE_MODE */
+
+//   <e> Enable UART4 Character Match
+//   <i>  Deliver the received data as soon as this character arrives,
+//   <i>  without waiting for the idle line. Needs UART4 interrupt.
+#define UART4_CHAR_MATCH         0
+
+#if UART4_CHAR_MATCH
+
+//     <o> Match Character <0x00-0xFF>
+//     <i>  Such as 0x0A ('\n') or the frame terminator.
+#define UART4_MATCH_CHAR         0x0A
+
+//   </e>
+#endif /* UART4_CHAR_MATCH */
+
+//   <q> Retarget stdio to UART4
+//   <i>  newlib `printf`, `puts`, `fgets`... use UART4 by `_write`,
+//   <i>  `_read` and `_isatty`, on DMA Tx and Rx if they are enabled.
+//   <i>  Only one UART can be selected.
+#define UART4_STDIO              0
+
 //   <e> Enable UART4 DMA RX
 #define UART4_RX_DMA             0
 
@@ -902,6 +1450,11 @@
 //     <i>  Using FIFO and Buf to implement high reliable UART Receive
 #define UART4_RX_DMA_FIFO_SIZE   256
 
+//     <q> Zero-copy receive
+//     <i>  Read straight from the DMA buffer by `uart_dmarx_peek` and
+//     <i>  `uart_dmarx_commit`, the receive FIFO is not allocated.
+#define UART4_RX_DMA_ZERO_COPY   0
+
 //   </e>
 
 #endif  /* UART4_RX_DMA */
@@ -937,6 +1490,8 @@
 
 //     <o> The size of transmit buf [byte]
 //     <i>  Write data to Send buf, and sending with thread safety
+//     <i>  Two banks of this size are allocated, one is written while DMA
+//     <i>  is transferring the other. Needs UART4 Interrupt enabled.
 #define UART4_TX_DMA_BUF_SIZE    256
 
 //   </e>
@@ -1023,6 +1578,110 @@
 //   </e>
 #endif /* UART5_IT_ENABLE */
 
+//   <e> Enable UART5 Hardware FIFO
+//   <i>  8-byte Tx and Rx FIFO of USART, the interrupt moves a whole
+//   <i>  threshold level instead of one byte. Needs UART5 interrupt.
+#define UART5_FIFO_ENABLE        0
+
+#if UART5_FIFO_ENABLE
+
+//     <o UART5_RX_FIFO_THRESHOLD> Rx FIFO Threshold
+//      <UART_RXFIFO_THRESHOLD_1_8=>1/8
+//      <UART_RXFIFO_THRESHOLD_1_4=>1/4
+//      <UART_RXFIFO_THRESHOLD_1_2=>1/2
+//      <UART_RXFIFO_THRESHOLD_3_4=>3/4
+//      <UART_RXFIFO_THRESHOLD_7_8=>7/8
+//      <UART_RXFIFO_THRESHOLD_8_8=>8/8
+//     <i>  Rx interrupt when the FIFO reaches this level
+#define UART5_RX_FIFO_THRESHOLD  UART_RXFIFO_THRESHOLD_1_2
+
+//     <o UART5_TX_FIFO_THRESHOLD> Tx FIFO Threshold
+//      <UART_TXFIFO_THRESHOLD_1_8=>1/8
+//      <UART_TXFIFO_THRESHOLD_1_4=>1/4
+//      <UART_TXFIFO_THRESHOLD_1_2=>1/2
+//      <UART_TXFIFO_THRESHOLD_3_4=>3/4
+//      <UART_TXFIFO_THRESHOLD_7_8=>7/8
+//      <UART_TXFIFO_THRESHOLD_8_8=>8/8
+//     <i>  Tx interrupt when the FIFO drops to this level
+#define UART5_TX_FIFO_THRESHOLD  UART_TXFIFO_THRESHOLD_1_2
+
+//   </e>
+#endif /* UART5_FIFO_ENABLE */
+
+//   <e> Enable UART5 Interrupt RX
+//   <i>  Receive into the fifo by Rx interrupt when DMA Rx is disabled,
+//   <i>  `uart_dmarx_read` works the same way. Needs UART5 interrupt.
+#define UART5_RX_IT              0
+
+#if UART5_RX_IT
+
+//     <o> The size of Receive FIFO [byte] (Must be power of 2)
+#define UART5_RX_IT_FIFO_SIZE    256
+
+//   </e>
+#endif /* UART5_RX_IT */
+
+//   <o> UART5 Bus Mode
+//       <0=>Full duplex <1=>RS-485 <2=>Single-wire half-duplex
+//   <i>  RS-485: RTS pin is the hardware driver enable (DE).
+//   <i>  Single-wire: TX pin (open drain) is used for both directions.
+//   <i>  Rx is suspended while transmitting in both modes.
+#define UART5_BUS_MODE           0
+
+#if (UART5_BUS_MODE == 1)
+
+//   <o> DE assertion time [1/16 bit] <0-31>
+//   <i>  Time from DE active to the start bit
+#define UART5_DE_ASSERT_TIME     8
+
+//   <o> DE deassertion time [1/16 bit] <0-31>
+//   <i>  Time from the end of last stop bit to DE inactive
+#define UART5_DE_DEASSERT_TIME   8
+
+#endif /* UART5_BUS_MODE */
+
+//   <e> Enable UART5 Mute Mode
+//   <i>  The receiver stays muted until a frame for this node, other
+//   <i>  frames never reach DMA Rx or wake the CPU.
+#define UART5_MUTE_MODE          0
+
+#if UART5_MUTE_MODE
+
+//     <o> Wakeup Method <0=>Address mark <1=>Idle line
+//     <i>  Address mark: bytes with MSB set are addresses, the receiver
+//     <i>  wakes on its own address and mutes on the others.
+//     <i>  Idle line: wakes on idle line, mute again by `uart_mute`.
+#define UART5_MUTE_WAKEUP        0
+
+//     <o> Address Length <0=>4-bit <1=>7-bit
+#define UART5_MUTE_ADDR_7BIT     1
+
+//     <o> Node Address <0-127>
+#define UART5_MUTE_ADDRESS       1
+
+//   </e>
+#endif /* UART5_MUTE_MODE */
+
+//   <e> Enable UART5 Character Match
+//   <i>  Deliver the received data as soon as this character arrives,
+//   <i>  without waiting for the idle line. Needs UART5 interrupt.
+#define UART5_CHAR_MATCH         0
+
+#if UART5_CHAR_MATCH
+
+//     <o> Match Character <0x00-0xFF>
+//     <i>  Such as 0x0A ('\n') or the frame terminator.
+#define UART5_MATCH_CHAR         0x0A
+
+//   </e>
+#endif /* UART5_CHAR_MATCH */
+
+//   <q> Retarget stdio to UART5
+//   <i>  newlib `printf`, `puts`, `fgets`... use UART5 by `_write`,
+//   <i>  `_read` and `_isatty`, on DMA Tx and Rx if they are enabled.
+//   <i>  Only one UART can be selected.
+#define UART5_STDIO              0
+
 //   <e> Enable UART5 DMA RX
 #define UART5_RX_DMA             0
 
@@ -1060,6 +1719,11 @@
 //     <i>  Using FIFO and Buf to implement high reliable UART Receive
 #define UART5_RX_DMA_FIFO_SIZE   256
 
+//     <q> Zero-copy receive
+//     <i>  Read straight from the DMA buffer by `uart_dmarx_peek` and
+//     <i>  `uart_dmarx_commit`, the receive FIFO is not allocated.
+#define UART5_RX_DMA_ZERO_COPY   0
+
 //   </e>
 
 #endif  /* UART5_RX_DMA */
@@ -1095,6 +1759,8 @@
 
 //     <o> The size of transmit buf [byte]
 //     <i>  Write data to Send buf, and sending with thread safety
+//     <i>  Two banks of this size are allocated, one is written while DMA
+//     <i>  is transferring the other. Needs UART5 Interrupt enabled.
 #define UART5_TX_DMA_BUF_SIZE    256
 
 //   </e>
@@ -1104,6 +1770,108 @@
 #endif  /* UART5_ENABLE */
 // </e>
 
+// <h> UART Common Configuration
+
+//   <o> Depth of DMA Tx descriptor queue <1-255>
+//   <i>  The number of caller-owned buffers which can be queued by
+//   <i>  `uart_dmatx_enqueue` on each UART.
+#define UART_TX_DMA_QUEUE_SIZE     8
+
+//   <o> Policy of `uart_printf` when the Tx buffer is full
+//      <0=>Drop <1=>Truncate <2=>Block
+//   <i>  Drop: discard the whole line. Truncate: send what fits.
+//   <i>  Block: wait for the other bank once (never in interrupt), at
+//   <i>  most twice the time to send a bank, then truncate.
+#define UART_PRINTF_FULL_POLICY    1
+
+//   <e> Baud rate planner
+//   <i>  `*_init` searches the kernel clock source, prescaler and
+//   <i>  oversampling for the lowest baud rate error instead of PCLK, no
+//   <i>  prescaler and 16x oversampling. `uart_set_baud` always uses it.
+#define UART_BAUD_PLANNER          0
+
+//   </e>
+
+//   <o> Max baud rate error [ppm] <0-100000>
+//   <i>  Baud rates with larger error are refused by the planner.
+#define UART_BAUD_MAX_ERROR        20000
+
+//   <q> Statistics
+//   <i>  Count bytes, drops, DMA events and errors of each UART, read them
+//   <i>  with `uart_get_stats`.
+#define UART_STATS_ENABLE          0
+
+//   <e> Use compact formatter for `uart_printf`
+//   <i>  Built-in integer formatter instead of newlib `vsnprintf`.
+//   <i>  Supports %d %i %u %x %X %o %c %s %p %% and fixed-point %f, with
+//   <i>  flags (- + space 0 #), width, precision and length (hh h l ll z).
+//   <i>  %f computes 9 fraction digits at most, %e %g %a are not supported.
+#define UART_PRINTF_COMPACT        0
+
+//     <o> Default precision of %f <0-9>
+//     <i>  Used when %f has no precision.
+#define UART_PRINTF_FLOAT_PRECISION 3
+
+//   </e>
+
+//   <e> Binary log
+//   <i>  `uart_log` sends records of format ID, timestamp and raw arguments
+//   <i>  through DMA Tx, `Tools/uart_log_decode.py` expands them with the
+//   <i>  format strings in the ELF file.
+#define UART_LOG_ENABLE            0
+
+//     <o> Max arguments of a record <0-15>
+#define UART_LOG_MAX_ARGS          8
+
+//     <i> Timestamp of record. The DWT cycle counter by default, started
+//     <i> at init by `UART_TIMESTAMP_DWT_INIT`.
+#define UART_LOG_TIMESTAMP()       (DWT->CYCCNT)
+
+//   </e>
+
+//   <e> Timestamps of received data
+//   <i>  Record the time of each received chunk (Rx event), read them with
+//   <i>  `uart_dmarx_read_ts`.
+#define UART_RX_TIMESTAMP          0
+
+//     <o> Chunks recorded of each UART <1-255>
+//     <i>  The newest chunks are merged when it is full.
+#define UART_RX_TIMESTAMP_DEPTH    16
+
+//     <i> Timestamp source. The DWT cycle counter by default, started at
+//     <i> init by `UART_TIMESTAMP_DWT_INIT`. Or the counter of a hardware
+//     <i> timer.
+#define UART_RX_TIMESTAMP_GET()    (DWT->CYCCNT)
+
+//   </e>
+
+//   <q> Start DWT cycle counter at init
+//   <i>  For the default timestamp of binary log and received data. It
+//   <i>  counts only with a debugger attached otherwise. Clear it if both
+//   <i>  are overridden, e.g. by a hardware timer.
+#define UART_TIMESTAMP_DWT_INIT    1
+
+//   <o> Size of format buffer without DMA Tx [byte]
+//   <i>  Stack buffer of `uart_printf` on UART without DMA Tx, and of
+//   <i>  `uart_scanf`.
+#define UART_FORMAT_BUF_SIZE       256
+
+//   <e> Static buffers
+//   <i>  Allocate the DMA buffers and fifos statically with the configured
+//   <i>  sizes instead of `CSP_MALLOC`, `*_init` does no allocation for
+//   <i>  them. The buffers can not be resized at runtime.
+#define UART_STATIC_BUFFER         0
+
+//     <s> Linker section of receive buffers and fifos
+#define UART_RX_BUF_SECTION        ".bss.uart_rx_buf"
+
+//     <s> Linker section of send buffers
+#define UART_TX_BUF_SECTION        ".bss.uart_tx_buf"
+
+//   </e>
+
+// </h>
+
 // <e> QUADSPI1 (Quad Serial Peripheral Interface)
 #define QUADSPI1_ENABLE  0
 
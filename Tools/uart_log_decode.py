@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""
+@file    uart_log_decode.py
+@brief   Expand the binary log records of `uart_log` into text.
+
+The format strings are read from the `.uart_log_fmt` section of the
+firmware ELF file, the address of each string is the ID of record.
+
+Record (little endian):
+    | 0xA5 | nargs | ID (4) | timestamp (4) | args (4 * nargs) | xor |
+
+Usage:
+    uart_log_decode.py firmware.elf capture.bin
+    stty -F /dev/ttyUSB0 921600 raw && \\
+        uart_log_decode.py firmware.elf /dev/ttyUSB0 --clock 170000000
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+HEAD_SIZE = 10
+MAX_ARGS = 15
+
+SPEC = re.compile(r"%([-+ 0#]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|z|j|t)?"
+                  r"([diuxXocsfFeEgGp%])")
+
+
+def load_formats(path):
+    """Return {address: format string} of `.uart_log_fmt` in an ELF file."""
+    with open(path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF":
+        sys.exit("%s: not an ELF file" % path)
+
+    is64 = elf[4] == 2
+    endian = "<" if elf[5] == 1 else ">"
+    if is64:
+        shoff, = struct.unpack_from(endian + "Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf,
+                                                        0x3A)
+        sh_fmt = endian + "IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from(endian + "I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf,
+                                                        0x2E)
+        sh_fmt = endian + "IIIIIIIIII"
+
+    sections = [struct.unpack_from(sh_fmt, elf, shoff + i * shentsize)
+                for i in range(shnum)]
+    strtab = sections[shstrndx]
+
+    for sh in sections:
+        name_end = elf.index(b"\0", strtab[4] + sh[0])
+        if elf[strtab[4] + sh[0]:name_end] != b".uart_log_fmt":
+            continue
+
+        addr, offset, size = sh[3], sh[4], sh[5]
+        data = elf[offset:offset + size]
+        formats = {}
+        pos = 0
+        while pos < len(data):
+            end = data.find(b"\0", pos)
+            if end < 0:
+                end = len(data)
+            if end > pos:
+                formats[addr + pos] = data[pos:end].decode("utf-8", "replace")
+            pos = end + 1
+        return formats
+
+    sys.exit("%s: no .uart_log_fmt section" % path)
+
+
+def expand(fmt, args):
+    """Expand a C format string with the raw 32-bit arguments."""
+    args = list(args)
+
+    def take():
+        return args.pop(0) if args else 0
+
+    def convert(m):
+        flags, width, prec, _, conv = m.groups()
+        if conv == "%":
+            return "%"
+
+        if width == "*":
+            width = str(struct.unpack("<i", struct.pack("<I", take()))[0])
+        if prec == "*":
+            prec = str(take())
+
+        spec = "%" + flags + (width or "")
+        if prec is not None:
+            spec += "." + (prec or "0")
+
+        raw = take()
+        if conv in "di":
+            return (spec + "d") % struct.unpack("<i", struct.pack("<I", raw))[0]
+        if conv == "u":
+            return (spec + "d") % raw
+        if conv in "xXo":
+            return (spec + conv) % raw
+        if conv == "c":
+            return (spec + "c") % chr(raw & 0xFF)
+        if conv in "fFeEgG":
+            value = struct.unpack("<f", struct.pack("<I", raw))[0]
+            return (spec + conv) % value
+        # Pointers and strings can not be dereferenced on host.
+        return "0x%08x" % raw
+
+    return SPEC.sub(convert, fmt)
+
+
+def decode(stream, formats, clock):
+    """Yield the text of each record in stream."""
+    buf = bytearray()
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            break
+        buf += chunk
+
+        while True:
+            start = buf.find(bytes([SYNC]))
+            if start < 0:
+                buf.clear()
+                break
+            del buf[:start]
+
+            if len(buf) < 2:
+                break
+            nargs = buf[1]
+            size = HEAD_SIZE + nargs * 4 + 1
+            if nargs > MAX_ARGS:
+                del buf[:1]
+                continue
+            if len(buf) < size:
+                break
+
+            check = 0
+            for b in buf[:size - 1]:
+                check ^= b
+            if check != buf[size - 1]:
+                # Lost sync, search the next sync byte.
+                del buf[:1]
+                continue
+
+            fmt_id, timestamp = struct.unpack_from("<II", buf, 2)
+            args = struct.unpack_from("<%dI" % nargs, buf, HEAD_SIZE)
+            del buf[:size]
+
+            fmt = formats.get(fmt_id)
+            if fmt is None:
+                text = "<unknown format 0x%08x> %s\n" % (
+                    fmt_id, " ".join("0x%08x" % a for a in args))
+            else:
+                text = expand(fmt, args)
+
+            if clock:
+                yield "[%12.6f] %s" % (timestamp / clock, text)
+            else:
+                yield "[%10u] %s" % (timestamp, text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[2])
+    parser.add_argument("elf", help="firmware ELF file")
+    parser.add_argument("input", nargs="?", default="-",
+                        help="captured bytes or serial device, default stdin")
+    parser.add_argument("--clock", type=float, default=0,
+                        help="timestamp frequency in Hz, print seconds")
+    opts = parser.parse_args()
+
+    formats = load_formats(opts.elf)
+    stream = (sys.stdin.buffer if opts.input == "-" else
+              open(opts.input, "rb", buffering=0))
+
+    for text in decode(stream, formats, opts.clock):
+        sys.stdout.write(text)
+        sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,115 @@
+/**
+ * @file    ring_fifo.c
+ * @brief   Host ring fifo for the UART simulation, stream type only.
+ */
+
+#include "ring_fifo.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct ring_fifo {
+    uint8_t *buf;  /*!< Storage area.        */
+    size_t size;   /*!< Size of storage.     */
+    size_t head;   /*!< Total bytes written. */
+    size_t tail;   /*!< Total bytes read.    */
+};
+
+void (*ring_fifo_write_hook)(ring_fifo_t *rf, const void *data,
+                             uint32_t written, size_t len);
+
+/**
+ * @brief Create a fifo on the storage area.
+ *
+ * @param buf The storage area.
+ * @param buf_size The size of storage area.
+ * @param type The type of fifo, stream only.
+ * @return The fifo, NULL on failure.
+ */
+ring_fifo_t *ring_fifo_init(void *buf, size_t buf_size, rf_type_t type) {
+    if ((buf == NULL) || (buf_size == 0) || (type != RF_TYPE_STREAM)) {
+        return NULL;
+    }
+
+    ring_fifo_t *rf = malloc(sizeof(ring_fifo_t));
+    if (rf == NULL) {
+        return NULL;
+    }
+
+    rf->buf = buf;
+    rf->size = buf_size;
+    rf->head = 0;
+    rf->tail = 0;
+    return rf;
+}
+
+/**
+ * @brief Destroy the fifo, the storage area is kept.
+ *
+ * @param rf The fifo.
+ */
+void ring_fifo_destroy(ring_fifo_t *rf) {
+    free(rf);
+}
+
+/**
+ * @brief Write to the fifo, the part that does not fit is dropped.
+ *
+ * @param rf The fifo.
+ * @param data The data.
+ * @param len The length of data.
+ * @return The length that is written.
+ */
+uint32_t ring_fifo_write(ring_fifo_t *rf, const void *data, size_t len) {
+    size_t n = rf->size - (rf->head - rf->tail);
+    size_t i;
+
+    if (n > len) {
+        n = len;
+    }
+
+    for (i = 0; i < n; ++i) {
+        rf->buf[(rf->head + i) % rf->size] = ((const uint8_t *)data)[i];
+    }
+    rf->head += n;
+
+    if (ring_fifo_write_hook != NULL) {
+        ring_fifo_write_hook(rf, data, (uint32_t)n, len);
+    }
+
+    return (uint32_t)n;
+}
+
+/**
+ * @brief Read from the fifo.
+ *
+ * @param rf The fifo.
+ * @param[out] buf The buf to read to.
+ * @param len The size of buf.
+ * @return The length that is read.
+ */
+uint32_t ring_fifo_read(ring_fifo_t *rf, void *buf, size_t len) {
+    size_t n = rf->head - rf->tail;
+    size_t i;
+
+    if (n > len) {
+        n = len;
+    }
+
+    for (i = 0; i < n; ++i) {
+        ((uint8_t *)buf)[i] = rf->buf[(rf->tail + i) % rf->size];
+    }
+    rf->tail += n;
+
+    return (uint32_t)n;
+}
+
+/**
+ * @brief Get the length of data in the fifo.
+ *
+ * @param rf The fifo.
+ * @return The length of data.
+ */
+uint32_t ring_fifo_get_length(ring_fifo_t *rf) {
+    return (uint32_t)(rf->head - rf->tail);
+}
@@ -0,0 +1,40 @@
+/**
+ * @file    ring_fifo.h
+ * @brief   Host ring fifo for the UART simulation, stream type only.
+ * @note    Same interface as the ring_fifo library used on the target.
+ */
+
+#ifndef __RING_FIFO_H
+#define __RING_FIFO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+typedef enum {
+    RF_TYPE_STREAM = 0U, /*!< Byte stream. */
+} rf_type_t;
+
+typedef struct ring_fifo ring_fifo_t;
+
+ring_fifo_t *ring_fifo_init(void *buf, size_t buf_size, rf_type_t type);
+void ring_fifo_destroy(ring_fifo_t *rf);
+uint32_t ring_fifo_write(ring_fifo_t *rf, const void *data, size_t len);
+uint32_t ring_fifo_read(ring_fifo_t *rf, void *buf, size_t len);
+uint32_t ring_fifo_get_length(ring_fifo_t *rf);
+
+/**
+ * @brief Called after each write with the length that fits, the simulation
+ *        follows which bytes are kept. NULL to disable.
+ */
+extern void (*ring_fifo_write_hook)(ring_fifo_t *rf, const void *data,
+                                    uint32_t written, size_t len);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __RING_FIFO_H */
@@ -0,0 +1,772 @@
+/**
+ * @file    stm32g4xx_hal.h
+ * @brief   Host mock of the STM32G4 HAL for the UART simulation.
+ * @note    Only what `UART_STM32G4xx.c` uses is declared. The registers of
+ *          USART and DMA are plain memory at the real addresses (mapped by
+ *          `sim_hal.c`), the peripheral behaviour is modelled in `sim_hal.c`:
+ *          the DMA counter, half/complete flags, IDLE, RDR and the errors.
+ *          Reading NDTR and unmasking interrupts are the preemption points
+ *          of the simulated interrupts.
+ */
+
+#ifndef __STM32G4xx_HAL_H
+#define __STM32G4xx_HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*****************************************************************************
+ * @defgroup Core.
+ * @{
+ */
+
+#define __IO            volatile
+#define __weak          __attribute__((weak))
+#define __STATIC_INLINE static inline
+
+uint32_t sim_read_reg(__IO uint32_t *reg);
+
+typedef enum {
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum { RESET = 0U, SET = !RESET } FlagStatus;
+
+#define HAL_MAX_DELAY        0xFFFFFFFFU
+
+#define SET_BIT(REG, BIT)    ((REG) |= (BIT))
+#define CLEAR_BIT(REG, BIT)  ((REG) &= ~(BIT))
+#define READ_BIT(REG, BIT)   ((REG) & (BIT))
+#define WRITE_REG(REG, VAL)  ((REG) = (VAL))
+/* Reading RDR clears RXNE, see `sim_hal.c`. */
+#define READ_REG(REG)        sim_read_reg(&(REG))
+#define MODIFY_REG(REG, CLEARMASK, SETMASK)                                    \
+    WRITE_REG((REG), (((READ_REG(REG)) & (~(CLEARMASK))) | (SETMASK)))
+#define ATOMIC_SET_BIT(REG, BIT)   SET_BIT(REG, BIT)
+#define ATOMIC_CLEAR_BIT(REG, BIT) CLEAR_BIT(REG, BIT)
+#define UNUSED(X)                  (void)X
+
+#define __HAL_LOCK(__HANDLE__)     ((__HANDLE__)->Lock = 1)
+#define __HAL_UNLOCK(__HANDLE__)   ((__HANDLE__)->Lock = 0)
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+
+/* Interrupt state of the simulated core, see `sim_hal.c`. */
+extern volatile uint32_t sim_primask;
+extern volatile uint32_t sim_ipsr;
+void sim_irq_unmasked(void);
+
+static inline uint32_t __get_PRIMASK(void) {
+    return sim_primask;
+}
+
+static inline void __set_PRIMASK(uint32_t primask) {
+    sim_primask = primask;
+    if (primask == 0) {
+        sim_irq_unmasked();
+    }
+}
+
+static inline void __disable_irq(void) {
+    sim_primask = 1;
+}
+
+static inline void __enable_irq(void) {
+    __set_PRIMASK(0);
+}
+
+static inline uint32_t __get_IPSR(void) {
+    return sim_ipsr;
+}
+
+static inline void __DMB(void) {
+}
+
+static inline void __DSB(void) {
+}
+
+/* The simulation advances to the next event. */
+void __WFI(void);
+
+/* Single core, an interrupt runs to its end before the preempted code goes
+ * on, the exclusive store always succeeds. */
+static inline uint32_t __LDREXW(volatile uint32_t *addr) {
+    return *addr;
+}
+
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t *addr) {
+    *addr = value;
+    return 0;
+}
+
+typedef struct {
+    __IO uint32_t DHCSR, DCRSR, DCRDR, DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+    __IO uint32_t CTRL, CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    __IO uint32_t ICSR;
+} SCB_Type;
+
+extern CoreDebug_Type *CoreDebug;
+extern DWT_Type *DWT;
+extern SCB_Type *SCB;
+
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk     1UL
+#define SCB_ICSR_VECTACTIVE_Msk    0x1FFUL
+
+typedef int IRQn_Type;
+
+#define DMA1_Channel1_IRQn 11
+#define DMA1_Channel2_IRQn 12
+#define DMA1_Channel3_IRQn 13
+#define DMA1_Channel4_IRQn 14
+#define DMA1_Channel5_IRQn 15
+#define DMA1_Channel6_IRQn 16
+#define DMA1_Channel7_IRQn 17
+#define DMA1_Channel8_IRQn 96
+#define DMA2_Channel1_IRQn 56
+#define DMA2_Channel2_IRQn 57
+#define DMA2_Channel3_IRQn 58
+#define DMA2_Channel4_IRQn 59
+#define DMA2_Channel5_IRQn 60
+#define DMA2_Channel6_IRQn 97
+#define DMA2_Channel7_IRQn 98
+#define DMA2_Channel8_IRQn 99
+#define USART1_IRQn        37
+#define USART2_IRQn        38
+#define USART3_IRQn        39
+#define UART4_IRQn         52
+#define UART5_IRQn         53
+#define LPUART1_IRQn       91
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority,
+                          uint32_t SubPriority);
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup GPIO and RCC.
+ * @{
+ */
+
+typedef struct {
+    __IO uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR;
+} GPIO_TypeDef;
+
+typedef struct {
+    uint32_t Pin, Mode, Pull, Speed, Alternate;
+} GPIO_InitTypeDef;
+
+extern GPIO_TypeDef *GPIOA, *GPIOB, *GPIOC, *GPIOD, *GPIOE, *GPIOF, *GPIOG;
+
+#define GPIO_PIN_0                0x0001U
+#define GPIO_PIN_1                0x0002U
+#define GPIO_PIN_2                0x0004U
+#define GPIO_PIN_3                0x0008U
+#define GPIO_PIN_4                0x0010U
+#define GPIO_PIN_5                0x0020U
+#define GPIO_PIN_6                0x0040U
+#define GPIO_PIN_7                0x0080U
+#define GPIO_PIN_8                0x0100U
+#define GPIO_PIN_9                0x0200U
+#define GPIO_PIN_10               0x0400U
+#define GPIO_PIN_11               0x0800U
+#define GPIO_PIN_12               0x1000U
+#define GPIO_PIN_13               0x2000U
+#define GPIO_PIN_14               0x4000U
+#define GPIO_PIN_15               0x8000U
+#define GPIO_NOPULL               0x0U
+#define GPIO_PULLUP               0x1U
+#define GPIO_SPEED_FREQ_HIGH      0x2U
+#define GPIO_SPEED_FREQ_VERY_HIGH 0x3U
+#define GPIO_MODE_AF_PP           0x2U
+#define GPIO_MODE_AF_OD           0x12U
+#define GPIO_AF5_UART4            0x05U
+#define GPIO_AF5_UART5            0x05U
+#define GPIO_AF7_USART1           0x07U
+#define GPIO_AF7_USART2           0x07U
+#define GPIO_AF7_USART3           0x07U
+#define GPIO_AF8_LPUART1          0x08U
+#define GPIO_AF8_UART4            0x08U
+#define GPIO_AF8_UART5            0x08U
+#define GPIO_AF12_LPUART1         0x0CU
+#define GPIO_AF14_UART4           0x0EU
+#define GPIO_AF14_UART5           0x0EU
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin);
+
+#define __HAL_RCC_NOP()                 ((void)0)
+#define __HAL_RCC_GPIOA_CLK_ENABLE()    __HAL_RCC_NOP()
+#define __HAL_RCC_GPIOB_CLK_ENABLE()    __HAL_RCC_NOP()
+#define __HAL_RCC_GPIOC_CLK_ENABLE()    __HAL_RCC_NOP()
+#define __HAL_RCC_GPIOD_CLK_ENABLE()    __HAL_RCC_NOP()
+#define __HAL_RCC_GPIOE_CLK_ENABLE()    __HAL_RCC_NOP()
+#define __HAL_RCC_GPIOF_CLK_ENABLE()    __HAL_RCC_NOP()
+#define __HAL_RCC_GPIOG_CLK_ENABLE()    __HAL_RCC_NOP()
+#define __HAL_RCC_DMAMUX1_CLK_ENABLE()  __HAL_RCC_NOP()
+#define __HAL_RCC_DMA1_CLK_ENABLE()     __HAL_RCC_NOP()
+#define __HAL_RCC_DMA2_CLK_ENABLE()     __HAL_RCC_NOP()
+#define __HAL_RCC_LPUART1_CLK_ENABLE()  __HAL_RCC_NOP()
+#define __HAL_RCC_USART1_CLK_ENABLE()   __HAL_RCC_NOP()
+#define __HAL_RCC_USART2_CLK_ENABLE()   __HAL_RCC_NOP()
+#define __HAL_RCC_USART3_CLK_ENABLE()   __HAL_RCC_NOP()
+#define __HAL_RCC_UART4_CLK_ENABLE()    __HAL_RCC_NOP()
+#define __HAL_RCC_UART5_CLK_ENABLE()    __HAL_RCC_NOP()
+#define __HAL_RCC_LPUART1_CLK_DISABLE() __HAL_RCC_NOP()
+#define __HAL_RCC_USART1_CLK_DISABLE()  __HAL_RCC_NOP()
+#define __HAL_RCC_USART2_CLK_DISABLE()  __HAL_RCC_NOP()
+#define __HAL_RCC_USART3_CLK_DISABLE()  __HAL_RCC_NOP()
+#define __HAL_RCC_UART4_CLK_DISABLE()   __HAL_RCC_NOP()
+#define __HAL_RCC_UART5_CLK_DISABLE()   __HAL_RCC_NOP()
+
+#define RCC_LPUART1CLKSOURCE_PCLK1  0U
+#define RCC_LPUART1CLKSOURCE_SYSCLK 1U
+#define RCC_LPUART1CLKSOURCE_HSI    2U
+#define RCC_LPUART1CLKSOURCE_LSE    3U
+#define RCC_USART1CLKSOURCE_PCLK2   0U
+#define RCC_USART1CLKSOURCE_SYSCLK  1U
+#define RCC_USART1CLKSOURCE_HSI     2U
+#define RCC_USART1CLKSOURCE_LSE     3U
+#define RCC_USART2CLKSOURCE_PCLK1   0U
+#define RCC_USART2CLKSOURCE_SYSCLK  1U
+#define RCC_USART2CLKSOURCE_HSI     2U
+#define RCC_USART2CLKSOURCE_LSE     3U
+#define RCC_USART3CLKSOURCE_PCLK1   0U
+#define RCC_USART3CLKSOURCE_SYSCLK  1U
+#define RCC_USART3CLKSOURCE_HSI     2U
+#define RCC_USART3CLKSOURCE_LSE     3U
+#define RCC_UART4CLKSOURCE_PCLK1    0U
+#define RCC_UART4CLKSOURCE_SYSCLK   1U
+#define RCC_UART4CLKSOURCE_HSI      2U
+#define RCC_UART4CLKSOURCE_LSE      3U
+#define RCC_UART5CLKSOURCE_PCLK1    0U
+#define RCC_UART5CLKSOURCE_SYSCLK   1U
+#define RCC_UART5CLKSOURCE_HSI      2U
+#define RCC_UART5CLKSOURCE_LSE      3U
+
+#define __HAL_RCC_LPUART1_CONFIG(__SOURCE__) ((void)(__SOURCE__))
+#define __HAL_RCC_USART1_CONFIG(__SOURCE__)  ((void)(__SOURCE__))
+#define __HAL_RCC_USART2_CONFIG(__SOURCE__)  ((void)(__SOURCE__))
+#define __HAL_RCC_USART3_CONFIG(__SOURCE__)  ((void)(__SOURCE__))
+#define __HAL_RCC_UART4_CONFIG(__SOURCE__)   ((void)(__SOURCE__))
+#define __HAL_RCC_UART5_CONFIG(__SOURCE__)   ((void)(__SOURCE__))
+#define __HAL_RCC_GET_LPUART1_SOURCE()       RCC_LPUART1CLKSOURCE_PCLK1
+#define __HAL_RCC_GET_USART1_SOURCE()        RCC_USART1CLKSOURCE_PCLK2
+#define __HAL_RCC_GET_USART2_SOURCE()        RCC_USART2CLKSOURCE_PCLK1
+#define __HAL_RCC_GET_USART3_SOURCE()        RCC_USART3CLKSOURCE_PCLK1
+#define __HAL_RCC_GET_UART4_SOURCE()         RCC_UART4CLKSOURCE_PCLK1
+#define __HAL_RCC_GET_UART5_SOURCE()         RCC_UART5CLKSOURCE_PCLK1
+#define __HAL_RCC_GET_FLAG(__FLAG__)         ((__FLAG__) == RCC_FLAG_HSIRDY)
+#define RCC_FLAG_HSIRDY                      1U
+#define RCC_FLAG_LSERDY                      2U
+#define HSI_VALUE                            16000000U
+#define LSE_VALUE                            32768U
+
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+uint32_t HAL_RCC_GetPCLK2Freq(void);
+uint32_t HAL_RCC_GetSysClockFreq(void);
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup DMA.
+ * @{
+ */
+
+typedef struct {
+    __IO uint32_t ISR;
+    __IO uint32_t IFCR;
+} DMA_TypeDef;
+
+typedef struct {
+    __IO uint32_t CCR;
+    __IO uint32_t CNDTR;
+    __IO uint32_t CPAR;
+    __IO uint32_t CMAR;
+    uint32_t RESERVED;
+} DMA_Channel_TypeDef;
+
+#define PERIPH_BASE   0x40000000UL
+#define DMA1_BASE     (PERIPH_BASE + 0x00020000UL)
+#define DMA2_BASE     (PERIPH_BASE + 0x00020400UL)
+#define DMA1          ((DMA_TypeDef *)DMA1_BASE)
+#define DMA2          ((DMA_TypeDef *)DMA2_BASE)
+#define DMA_CH(base, n)                                                        \
+    ((DMA_Channel_TypeDef *)((base) + 0x08UL + 0x14UL * ((n) - 1)))
+#define DMA1_Channel1 DMA_CH(DMA1_BASE, 1)
+#define DMA1_Channel2 DMA_CH(DMA1_BASE, 2)
+#define DMA1_Channel3 DMA_CH(DMA1_BASE, 3)
+#define DMA1_Channel4 DMA_CH(DMA1_BASE, 4)
+#define DMA1_Channel5 DMA_CH(DMA1_BASE, 5)
+#define DMA1_Channel6 DMA_CH(DMA1_BASE, 6)
+#define DMA1_Channel7 DMA_CH(DMA1_BASE, 7)
+#define DMA1_Channel8 DMA_CH(DMA1_BASE, 8)
+#define DMA2_Channel1 DMA_CH(DMA2_BASE, 1)
+#define DMA2_Channel2 DMA_CH(DMA2_BASE, 2)
+#define DMA2_Channel3 DMA_CH(DMA2_BASE, 3)
+#define DMA2_Channel4 DMA_CH(DMA2_BASE, 4)
+#define DMA2_Channel5 DMA_CH(DMA2_BASE, 5)
+#define DMA2_Channel6 DMA_CH(DMA2_BASE, 6)
+#define DMA2_Channel7 DMA_CH(DMA2_BASE, 7)
+#define DMA2_Channel8 DMA_CH(DMA2_BASE, 8)
+
+typedef struct {
+    uint32_t Request;
+    uint32_t Direction;
+    uint32_t PeriphInc;
+    uint32_t MemInc;
+    uint32_t PeriphDataAlignment;
+    uint32_t MemDataAlignment;
+    uint32_t Mode;
+    uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef enum {
+    HAL_DMA_STATE_RESET = 0x00U,
+    HAL_DMA_STATE_READY = 0x01U,
+    HAL_DMA_STATE_BUSY = 0x02U
+} HAL_DMA_StateTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+    DMA_Channel_TypeDef *Instance;
+    DMA_InitTypeDef Init;
+    int Lock;
+    __IO HAL_DMA_StateTypeDef State;
+    void *Parent;
+    void (*XferCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+    void (*XferHalfCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+    void (*XferErrorCallback)(struct __DMA_HandleTypeDef *hdma);
+    void (*XferAbortCallback)(struct __DMA_HandleTypeDef *hdma);
+    __IO uint32_t ErrorCode;
+} DMA_HandleTypeDef;
+
+#define DMA_PERIPH_TO_MEMORY    0x00000000U
+#define DMA_MEMORY_TO_PERIPH    0x00000010U
+#define DMA_PINC_DISABLE        0x00000000U
+#define DMA_MINC_ENABLE         0x00000080U
+#define DMA_PDATAALIGN_BYTE     0x00000000U
+#define DMA_MDATAALIGN_BYTE     0x00000000U
+#define DMA_NORMAL              0x00000000U
+#define DMA_CIRCULAR            0x00000020U
+#define DMA_PRIORITY_LOW        0x00000000U
+#define DMA_PRIORITY_MEDIUM     0x00001000U
+#define DMA_PRIORITY_HIGH       0x00002000U
+#define DMA_PRIORITY_VERY_HIGH  0x00003000U
+#define DMA_CCR_EN              0x00000001U
+#define DMA_IT_TC               0x00000002U
+#define DMA_IT_HT               0x00000004U
+#define DMA_IT_TE               0x00000008U
+#define HAL_DMA_ERROR_NONE      0x00000000U
+#define HAL_DMA_ERROR_TE        0x00000001U
+
+#define DMA_REQUEST_LPUART1_RX  34U
+#define DMA_REQUEST_LPUART1_TX  35U
+#define DMA_REQUEST_USART1_RX   24U
+#define DMA_REQUEST_USART1_TX   25U
+#define DMA_REQUEST_USART2_RX   26U
+#define DMA_REQUEST_USART2_TX   27U
+#define DMA_REQUEST_USART3_RX   28U
+#define DMA_REQUEST_USART3_TX   29U
+#define DMA_REQUEST_UART4_RX    30U
+#define DMA_REQUEST_UART4_TX    31U
+#define DMA_REQUEST_UART5_RX    32U
+#define DMA_REQUEST_UART5_TX    33U
+
+/* The flags of channel n are at bit 4 * (n - 1) of ISR, like the device. */
+#define SIM_DMA(__HANDLE__)                                                    \
+    (((uintptr_t)(__HANDLE__)->Instance < DMA2_BASE) ? DMA1 : DMA2)
+#define SIM_DMA_SHIFT(__HANDLE__)                                              \
+    (4U * (uint32_t)((((uintptr_t)(__HANDLE__)->Instance - 0x08UL) & 0x3FFUL) / \
+                     0x14UL))
+#define __HAL_DMA_GET_GI_FLAG_INDEX(__HANDLE__) (1UL << SIM_DMA_SHIFT(__HANDLE__))
+#define __HAL_DMA_GET_TC_FLAG_INDEX(__HANDLE__) (2UL << SIM_DMA_SHIFT(__HANDLE__))
+#define __HAL_DMA_GET_HT_FLAG_INDEX(__HANDLE__) (4UL << SIM_DMA_SHIFT(__HANDLE__))
+#define __HAL_DMA_GET_TE_FLAG_INDEX(__HANDLE__) (8UL << SIM_DMA_SHIFT(__HANDLE__))
+#define __HAL_DMA_GET_FLAG(__HANDLE__, __FLAG__)                               \
+    (SIM_DMA(__HANDLE__)->ISR & (__FLAG__))
+#define __HAL_DMA_CLEAR_FLAG(__HANDLE__, __FLAG__)                             \
+    (SIM_DMA(__HANDLE__)->ISR &= ~(uint32_t)(__FLAG__))
+
+/* NDTR is read through the model, DMA may move on meanwhile. */
+uint32_t sim_dma_get_counter(DMA_Channel_TypeDef *channel);
+
+#define __HAL_DMA_GET_COUNTER(__HANDLE__)                                      \
+    sim_dma_get_counter((__HANDLE__)->Instance)
+#define __HAL_DMA_SET_COUNTER(__HANDLE__, __COUNTER__)                         \
+    ((__HANDLE__)->Instance->CNDTR = (uint16_t)(__COUNTER__))
+#define __HAL_DMA_ENABLE(__HANDLE__)  ((__HANDLE__)->Instance->CCR |= DMA_CCR_EN)
+#define __HAL_DMA_DISABLE(__HANDLE__)                                          \
+    ((__HANDLE__)->Instance->CCR &= ~DMA_CCR_EN)
+#define __HAL_DMA_ENABLE_IT(__HANDLE__, __INTERRUPT__)                         \
+    ((__HANDLE__)->Instance->CCR |= (__INTERRUPT__))
+#define __HAL_DMA_DISABLE_IT(__HANDLE__, __INTERRUPT__)                        \
+    ((__HANDLE__)->Instance->CCR &= ~(__INTERRUPT__))
+#define __HAL_LINKDMA(__HANDLE__, __PPP_DMA_FIELD__, __DMA_HANDLE__)           \
+    do {                                                                       \
+        (__HANDLE__)->__PPP_DMA_FIELD__ = &(__DMA_HANDLE__);                   \
+        (__DMA_HANDLE__).Parent = (__HANDLE__);                                \
+    } while (0)
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMA_Abort_IT(DMA_HandleTypeDef *hdma);
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma);
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup UART.
+ * @{
+ */
+
+typedef struct {
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t CR3;
+    __IO uint32_t BRR;
+    __IO uint32_t GTPR;
+    __IO uint32_t RTOR;
+    __IO uint32_t RQR;
+    __IO uint32_t ISR;
+    __IO uint32_t ICR;
+    __IO uint32_t RDR;
+    __IO uint32_t TDR;
+    __IO uint32_t PRESC;
+} USART_TypeDef;
+
+#define USART1_BASE           (PERIPH_BASE + 0x00013800UL)
+#define USART2_BASE           (PERIPH_BASE + 0x00004400UL)
+#define USART3_BASE           (PERIPH_BASE + 0x00004800UL)
+#define UART4_BASE            (PERIPH_BASE + 0x00004C00UL)
+#define UART5_BASE            (PERIPH_BASE + 0x00005000UL)
+#define LPUART1_BASE          (PERIPH_BASE + 0x00008000UL)
+#define USART1                ((USART_TypeDef *)USART1_BASE)
+#define USART2                ((USART_TypeDef *)USART2_BASE)
+#define USART3                ((USART_TypeDef *)USART3_BASE)
+#define UART4                 ((USART_TypeDef *)UART4_BASE)
+#define UART5                 ((USART_TypeDef *)UART5_BASE)
+#define LPUART1               ((USART_TypeDef *)LPUART1_BASE)
+#define IS_LPUART_INSTANCE(__INSTANCE__) ((__INSTANCE__) == LPUART1)
+#define IS_UART_INSTANCE(__INSTANCE__)   1
+#define IS_UART_FIFO_INSTANCE(__INSTANCE__)          1
+#define IS_UART_DRIVER_ENABLE_INSTANCE(__INSTANCE__) 1
+
+typedef struct {
+    uint32_t BaudRate;
+    uint32_t WordLength;
+    uint32_t StopBits;
+    uint32_t Parity;
+    uint32_t Mode;
+    uint32_t HwFlowCtl;
+    uint32_t OverSampling;
+    uint32_t OneBitSampling;
+    uint32_t ClockPrescaler;
+} UART_InitTypeDef;
+
+typedef struct {
+    uint32_t AdvFeatureInit;
+    uint32_t TxPinLevelInvert;
+    uint32_t RxPinLevelInvert;
+    uint32_t DataInvert;
+    uint32_t Swap;
+    uint32_t OverrunDisable;
+    uint32_t DMADisableonRxError;
+    uint32_t AutoBaudRateEnable;
+    uint32_t AutoBaudRateMode;
+    uint32_t MSBFirst;
+} UART_AdvFeatureInitTypeDef;
+
+typedef uint32_t HAL_UART_StateTypeDef;
+typedef uint32_t HAL_UART_RxTypeTypeDef;
+
+typedef struct __UART_HandleTypeDef {
+    USART_TypeDef *Instance;
+    UART_InitTypeDef Init;
+    UART_AdvFeatureInitTypeDef AdvancedInit;
+    const uint8_t *pTxBuffPtr;
+    uint16_t TxXferSize;
+    __IO uint16_t TxXferCount;
+    uint8_t *pRxBuffPtr;
+    uint16_t RxXferSize;
+    __IO uint16_t RxXferCount;
+    uint16_t Mask;
+    uint32_t FifoMode;
+    uint16_t NbRxDataToProcess;
+    uint16_t NbTxDataToProcess;
+    __IO HAL_UART_RxTypeTypeDef ReceptionType;
+    void (*RxISR)(struct __UART_HandleTypeDef *huart);
+    void (*TxISR)(struct __UART_HandleTypeDef *huart);
+    DMA_HandleTypeDef *hdmatx;
+    DMA_HandleTypeDef *hdmarx;
+    int Lock;
+    __IO HAL_UART_StateTypeDef gState;
+    __IO HAL_UART_StateTypeDef RxState;
+    __IO uint32_t ErrorCode;
+} UART_HandleTypeDef;
+
+#ifndef USE_HAL_UART_REGISTER_CALLBACKS
+#define USE_HAL_UART_REGISTER_CALLBACKS 0U
+#endif /* USE_HAL_UART_REGISTER_CALLBACKS */
+
+typedef enum {
+    HAL_UART_TX_HALFCOMPLETE_CB_ID = 0x00U,
+    HAL_UART_TX_COMPLETE_CB_ID = 0x01U,
+    HAL_UART_RX_HALFCOMPLETE_CB_ID = 0x02U,
+    HAL_UART_RX_COMPLETE_CB_ID = 0x03U,
+    HAL_UART_ERROR_CB_ID = 0x04U
+} HAL_UART_CallbackIDTypeDef;
+
+typedef void (*pUART_CallbackTypeDef)(UART_HandleTypeDef *huart);
+
+#define HAL_UART_STATE_RESET        0x00000000U
+#define HAL_UART_STATE_READY        0x00000020U
+#define HAL_UART_STATE_BUSY         0x00000024U
+#define HAL_UART_STATE_BUSY_TX      0x00000021U
+#define HAL_UART_STATE_BUSY_RX      0x00000022U
+#define HAL_UART_STATE_BUSY_TX_RX   0x00000023U
+#define HAL_UART_RECEPTION_STANDARD 0x00000000U
+#define HAL_UART_RECEPTION_TOIDLE   0x00000001U
+
+#define HAL_UART_ERROR_NONE 0x00000000U
+#define HAL_UART_ERROR_PE   0x00000001U
+#define HAL_UART_ERROR_NE   0x00000002U
+#define HAL_UART_ERROR_FE   0x00000004U
+#define HAL_UART_ERROR_ORE  0x00000008U
+#define HAL_UART_ERROR_DMA  0x00000010U
+#define HAL_UART_ERROR_RTO  0x00000020U
+
+#define UART_WORDLENGTH_7B          0x10000000U
+#define UART_WORDLENGTH_8B          0x00000000U
+#define UART_WORDLENGTH_9B          0x00001000U
+#define UART_STOPBITS_1             0x00000000U
+#define UART_STOPBITS_2             0x00002000U
+#define UART_PARITY_NONE            0x00000000U
+#define UART_PARITY_EVEN            0x00000400U
+#define UART_PARITY_ODD             0x00000600U
+#define UART_MODE_RX                0x00000004U
+#define UART_MODE_TX                0x00000008U
+#define UART_MODE_TX_RX             0x0000000CU
+#define UART_HWCONTROL_NONE         0x00000000U
+#define UART_HWCONTROL_RTS          0x00000100U
+#define UART_HWCONTROL_CTS          0x00000200U
+#define UART_OVERSAMPLING_16        0x00000000U
+#define UART_OVERSAMPLING_8         0x00008000U
+#define UART_ONE_BIT_SAMPLE_DISABLE 0x00000000U
+#define UART_ONE_BIT_SAMPLE_ENABLE  0x00000800U
+#define UART_PRESCALER_DIV1         0x00000000U
+#define UART_PRESCALER_DIV2         0x00000001U
+#define UART_PRESCALER_DIV4         0x00000002U
+#define UART_PRESCALER_DIV6         0x00000003U
+#define UART_PRESCALER_DIV8         0x00000004U
+#define UART_PRESCALER_DIV10        0x00000005U
+#define UART_PRESCALER_DIV12        0x00000006U
+#define UART_PRESCALER_DIV16        0x00000007U
+#define UART_PRESCALER_DIV32        0x00000008U
+#define UART_PRESCALER_DIV64        0x00000009U
+#define UART_PRESCALER_DIV128       0x0000000AU
+#define UART_PRESCALER_DIV256       0x0000000BU
+#define UART_DE_POLARITY_HIGH       0x00000000U
+#define UART_DE_POLARITY_LOW        0x00008000U
+#define UART_WAKEUPMETHOD_IDLELINE    0x00000000U
+#define UART_WAKEUPMETHOD_ADDRESSMARK 0x00000800U
+#define UART_ADDRESS_DETECT_4B      0x00000000U
+#define UART_ADDRESS_DETECT_7B      0x00000010U
+#define UART_CR2_ADDRESS_LSB_POS    24U
+#define UART_FIFOMODE_DISABLE       0x00000000U
+#define UART_FIFOMODE_ENABLE        0x20000000U
+#define UART_TXFIFO_THRESHOLD_1_8   0x00000000U
+#define UART_TXFIFO_THRESHOLD_1_4   0x00000001U
+#define UART_TXFIFO_THRESHOLD_1_2   0x00000002U
+#define UART_TXFIFO_THRESHOLD_3_4   0x00000003U
+#define UART_TXFIFO_THRESHOLD_7_8   0x00000004U
+#define UART_TXFIFO_THRESHOLD_8_8   0x00000005U
+#define UART_RXFIFO_THRESHOLD_1_8   0x00000000U
+#define UART_RXFIFO_THRESHOLD_1_4   0x00000001U
+#define UART_RXFIFO_THRESHOLD_1_2   0x00000002U
+#define UART_RXFIFO_THRESHOLD_3_4   0x00000003U
+#define UART_RXFIFO_THRESHOLD_7_8   0x00000004U
+#define UART_RXFIFO_THRESHOLD_8_8   0x00000005U
+
+#define USART_CR1_UE             (1U << 0)
+#define USART_CR1_RE             (1U << 2)
+#define USART_CR1_TE             (1U << 3)
+#define USART_CR1_IDLEIE         (1U << 4)
+#define USART_CR1_RXNEIE_RXFNEIE (1U << 5)
+#define USART_CR1_TCIE           (1U << 6)
+#define USART_CR1_PEIE           (1U << 8)
+#define USART_CR1_WAKE           (1U << 11)
+#define USART_CR1_MME            (1U << 13)
+#define USART_CR1_CMIE           (1U << 14)
+#define USART_CR1_OVER8          (1U << 15)
+#define USART_CR1_RTOIE          (1U << 26)
+#define USART_CR1_FIFOEN         (1U << 29)
+#define USART_CR2_ADDM7          (1U << 4)
+#define USART_CR2_RTOEN          (1U << 23)
+#define USART_CR2_ADD_Pos        24U
+#define USART_CR2_ADD            (0xFFU << 24)
+#define USART_CR3_EIE            (1U << 0)
+#define USART_CR3_HDSEL          (1U << 3)
+#define USART_CR3_DMAR           (1U << 6)
+#define USART_CR3_DMAT           (1U << 7)
+#define USART_CR3_ONEBIT         (1U << 11)
+#define USART_CR3_DEM            (1U << 14)
+#define USART_CR3_RXFTIE         (1U << 28)
+#define USART_RTOR_RTO           0x00FFFFFFU
+#define USART_BRR_LPUART         0x000FFFFFU
+#define USART_PRESC_PRESCALER    0x0000000FU
+#define USART_RQR_MMRQ           (1U << 2)
+#define USART_RQR_RXFRQ          (1U << 3)
+#define USART_ISR_RXNE_RXFNE     (1U << 5)
+#define USART_ISR_TC             (1U << 6)
+
+#define UART_FLAG_PE    0x00000001U
+#define UART_FLAG_FE    0x00000002U
+#define UART_FLAG_NE    0x00000004U
+#define UART_FLAG_ORE   0x00000008U
+#define UART_FLAG_IDLE  0x00000010U
+#define UART_FLAG_RXNE  0x00000020U
+#define UART_FLAG_RXFNE 0x00000020U
+#define UART_FLAG_TC    0x00000040U
+#define UART_FLAG_TXE   0x00000080U
+#define UART_FLAG_TXFNF 0x00000080U
+#define UART_FLAG_RTOF  0x00000800U
+#define UART_FLAG_BUSY  0x00010000U
+#define UART_FLAG_CMF   0x00020000U
+#define UART_FLAG_RXFT  0x04000000U
+
+/* ICR has the same bit positions as ISR, writing it clears ISR. */
+#define UART_CLEAR_PEF   UART_FLAG_PE
+#define UART_CLEAR_FEF   UART_FLAG_FE
+#define UART_CLEAR_NEF   UART_FLAG_NE
+#define UART_CLEAR_OREF  UART_FLAG_ORE
+#define UART_CLEAR_IDLEF UART_FLAG_IDLE
+#define UART_CLEAR_TCF   UART_FLAG_TC
+#define UART_CLEAR_RTOF  UART_FLAG_RTOF
+#define UART_CLEAR_CMF   UART_FLAG_CMF
+
+/* Interrupt: bits [7:5] register (1: CR1, 2: CR2, 3: CR3), [4:0] bit. */
+#define UART_IT_PE    0x0028U
+#define UART_IT_IDLE  0x0424U
+#define UART_IT_RXNE  0x0525U
+#define UART_IT_RXFNE 0x0525U
+#define UART_IT_TC    0x0626U
+#define UART_IT_CM    0x112EU
+#define UART_IT_RTO   0x0B3AU
+#define UART_IT_RXFT  0x1A7CU
+#define UART_IT_ERR   0x0060U
+#define UART_IT_MASK  0x001FU
+
+#define SIM_UART_IT_REG(__HANDLE__, __IT__)                                    \
+    (*((((__IT__) & 0xFFU) >> 5U) == 1U   ? &(__HANDLE__)->Instance->CR1       \
+       : (((__IT__) & 0xFFU) >> 5U) == 2U ? &(__HANDLE__)->Instance->CR2       \
+                                          : &(__HANDLE__)->Instance->CR3))
+#define __HAL_UART_ENABLE_IT(__HANDLE__, __IT__)                               \
+    (SIM_UART_IT_REG(__HANDLE__, __IT__) |= (1U << ((__IT__) & UART_IT_MASK)))
+#define __HAL_UART_DISABLE_IT(__HANDLE__, __IT__)                              \
+    (SIM_UART_IT_REG(__HANDLE__, __IT__) &= ~(1U << ((__IT__) & UART_IT_MASK)))
+#define __HAL_UART_GET_IT_SOURCE(__HANDLE__, __IT__)                           \
+    ((SIM_UART_IT_REG(__HANDLE__, __IT__) &                                    \
+      (1U << ((__IT__) & UART_IT_MASK))) != 0U)
+#define __HAL_UART_GET_FLAG(__HANDLE__, __FLAG__)                              \
+    (((__HANDLE__)->Instance->ISR & (__FLAG__)) == (__FLAG__))
+#define __HAL_UART_CLEAR_FLAG(__HANDLE__, __FLAG__)                            \
+    ((__HANDLE__)->Instance->ISR &= ~(uint32_t)(__FLAG__))
+#define __HAL_UART_CLEAR_PEFLAG(__HANDLE__)                                    \
+    __HAL_UART_CLEAR_FLAG((__HANDLE__), UART_CLEAR_PEF)
+#define __HAL_UART_CLEAR_FEFLAG(__HANDLE__)                                    \
+    __HAL_UART_CLEAR_FLAG((__HANDLE__), UART_CLEAR_FEF)
+#define __HAL_UART_CLEAR_NEFLAG(__HANDLE__)                                    \
+    __HAL_UART_CLEAR_FLAG((__HANDLE__), UART_CLEAR_NEF)
+#define __HAL_UART_CLEAR_OREFLAG(__HANDLE__)                                   \
+    __HAL_UART_CLEAR_FLAG((__HANDLE__), UART_CLEAR_OREF)
+#define __HAL_UART_CLEAR_IDLEFLAG(__HANDLE__)                                  \
+    __HAL_UART_CLEAR_FLAG((__HANDLE__), UART_CLEAR_IDLEF)
+#define __HAL_UART_ENABLE(__HANDLE__)                                          \
+    ((__HANDLE__)->Instance->CR1 |= USART_CR1_UE)
+#define __HAL_UART_DISABLE(__HANDLE__)                                         \
+    ((__HANDLE__)->Instance->CR1 &= ~USART_CR1_UE)
+#define __HAL_UART_SEND_REQ(__HANDLE__, __REQ__)                               \
+    ((__HANDLE__)->Instance->RQR |= (uint16_t)(__REQ__))
+#define UART_MUTE_MODE_REQUEST    USART_RQR_MMRQ
+#define UART_RXDATA_FLUSH_REQUEST USART_RQR_RXFRQ
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_HalfDuplex_Init(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_RS485Ex_Init(UART_HandleTypeDef *huart,
+                                   uint32_t Polarity, uint32_t AssertionTime,
+                                   uint32_t DeassertionTime);
+HAL_StatusTypeDef HAL_UART_DeInit(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_RegisterCallback(UART_HandleTypeDef *huart,
+                                            HAL_UART_CallbackIDTypeDef CallbackID,
+                                            pUART_CallbackTypeDef pCallback);
+HAL_StatusTypeDef
+HAL_UART_UnRegisterCallback(UART_HandleTypeDef *huart,
+                            HAL_UART_CallbackIDTypeDef CallbackID);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart,
+                                    const uint8_t *pData, uint16_t Size,
+                                    uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart,
+                                       const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart,
+                                        const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart,
+                                      uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart,
+                                       uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_AbortTransmit_IT(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle(UART_HandleTypeDef *huart,
+                                           uint8_t *pData, uint16_t Size,
+                                           uint16_t *RxLen, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UARTEx_EnableFifoMode(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UARTEx_DisableFifoMode(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UARTEx_SetTxFifoThreshold(UART_HandleTypeDef *huart,
+                                                uint32_t Threshold);
+HAL_StatusTypeDef HAL_UARTEx_SetRxFifoThreshold(UART_HandleTypeDef *huart,
+                                                uint32_t Threshold);
+void HAL_UART_ReceiverTimeout_Config(UART_HandleTypeDef *huart,
+                                     uint32_t TimeoutValue);
+HAL_StatusTypeDef HAL_UART_EnableReceiverTimeout(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_DisableReceiverTimeout(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_MultiProcessor_EnableMuteMode(UART_HandleTypeDef *huart);
+void HAL_MultiProcessor_EnterMuteMode(UART_HandleTypeDef *huart);
+HAL_UART_StateTypeDef HAL_UART_GetState(const UART_HandleTypeDef *huart);
+uint32_t HAL_UART_GetError(const UART_HandleTypeDef *huart);
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart);
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __STM32G4xx_HAL_H */
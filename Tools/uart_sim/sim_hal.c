@@ -0,0 +1,967 @@
+/**
+ * @file    sim_hal.c
+ * @brief   Model of USART receiver and DMA channel behind the mock HAL.
+ * @note    The HAL functions follow the STM32G4 HAL where the driver depends
+ *          on them: the Rx DMA callbacks, the error handling which ends the
+ *          reception, and the Rx DMA abort. The rest only keeps the state.
+ */
+
+#include "sim_hal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE MAP_FIXED
+#endif /* MAP_FIXED_NOREPLACE */
+
+/* The registers are mapped at the real addresses, the driver tells the
+ * ports apart by `Instance`. */
+#define SIM_PERIPH_SIZE 0x00030000UL
+
+/* Kernel clock of all the UARTs. */
+#define SIM_CLOCK_HZ    170000000U
+
+/* A level-triggered interrupt which is served this many times in a row is
+ * taken as a storm. */
+#define SIM_STORM_LIMIT 1000U
+
+#define SIM_IRQ_UART    (1U << 0)
+#define SIM_IRQ_DMA     (1U << 1)
+
+volatile uint32_t sim_primask;
+volatile uint32_t sim_ipsr;
+uint64_t sim_time_ns;
+sim_counter_t sim_counter;
+void (*sim_counter_hook)(void);
+void (*sim_wfi_hook)(void);
+
+static sim_port_t sim_port;
+static uint32_t sim_active;
+/* Tag of the byte in RDR and of each byte DMA wrote, by position. */
+static uint32_t sim_rdr_tag;
+static uint32_t sim_buf_tag[65536];
+/* Tag of each byte the CPU read from RDR, in order. */
+#define SIM_READ_TAGS 256U
+static uint32_t sim_read_tag[SIM_READ_TAGS];
+static uint32_t sim_read_head, sim_read_tail;
+
+static GPIO_TypeDef sim_gpio[7];
+GPIO_TypeDef *GPIOA = &sim_gpio[0];
+GPIO_TypeDef *GPIOB = &sim_gpio[1];
+GPIO_TypeDef *GPIOC = &sim_gpio[2];
+GPIO_TypeDef *GPIOD = &sim_gpio[3];
+GPIO_TypeDef *GPIOE = &sim_gpio[4];
+GPIO_TypeDef *GPIOF = &sim_gpio[5];
+GPIO_TypeDef *GPIOG = &sim_gpio[6];
+
+static CoreDebug_Type sim_core_debug;
+static DWT_Type sim_dwt;
+static SCB_Type sim_scb;
+CoreDebug_Type *CoreDebug = &sim_core_debug;
+DWT_Type *DWT = &sim_dwt;
+SCB_Type *SCB = &sim_scb;
+
+/*****************************************************************************
+ * @defgroup Model.
+ * @{
+ */
+
+/**
+ * @brief Map the peripheral registers.
+ *
+ */
+void sim_init(void) {
+    static uint8_t mapped = 0;
+
+    if (!mapped) {
+        void *addr = mmap((void *)PERIPH_BASE, SIM_PERIPH_SIZE,
+                          PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+                          -1, 0);
+        if (addr != (void *)PERIPH_BASE) {
+            fprintf(stderr, "sim: can not map the peripherals at 0x%08lx\n",
+                    (unsigned long)PERIPH_BASE);
+            exit(2);
+        }
+        mapped = 1;
+    }
+
+    memset((void *)PERIPH_BASE, 0, SIM_PERIPH_SIZE);
+    memset(&sim_counter, 0, sizeof(sim_counter));
+    memset(&sim_port, 0, sizeof(sim_port));
+    sim_time_ns = 0;
+    sim_primask = 0;
+    sim_ipsr = 0;
+    sim_active = 0;
+    sim_read_head = sim_read_tail = 0;
+    sim_counter_hook = NULL;
+    sim_wfi_hook = NULL;
+}
+
+/**
+ * @brief Attach the port to the line.
+ *
+ * @param port The port.
+ */
+void sim_attach(const sim_port_t *port) {
+    sim_port = *port;
+}
+
+/**
+ * @brief Advance the simulated time.
+ *
+ * @param time_ns The new time.
+ */
+void sim_advance(uint64_t time_ns) {
+    sim_time_ns = time_ns;
+    DWT->CYCCNT = (uint32_t)(time_ns * (SIM_CLOCK_HZ / 1000000U) / 1000U);
+}
+
+/**
+ * @brief Get the flags of the Rx DMA channel.
+ *
+ * @param hdma The DMA handle.
+ * @return TE, HT, TC and GI flags at bit 3..0.
+ */
+static inline uint32_t sim_dma_flags(DMA_HandleTypeDef *hdma) {
+    return (SIM_DMA(hdma)->ISR >> SIM_DMA_SHIFT(hdma)) & 0x0FU;
+}
+
+/**
+ * @brief Set the flags of the Rx DMA channel.
+ *
+ * @param hdma The DMA handle.
+ * @param flags The flags at bit 3..0, GI is set with them.
+ */
+static inline void sim_dma_set_flags(DMA_HandleTypeDef *hdma, uint32_t flags) {
+    SIM_DMA(hdma)->ISR |= (flags | 1U) << SIM_DMA_SHIFT(hdma);
+}
+
+/**
+ * @brief DMA moves the byte in RDR to memory, if it is requested.
+ *
+ * @return The position in receive buf, -1 if the byte stays in RDR.
+ */
+static int32_t sim_dma_take(void) {
+    UART_HandleTypeDef *huart = sim_port.huart;
+    DMA_HandleTypeDef *hdma = huart->hdmarx;
+    USART_TypeDef *uart = huart->Instance;
+
+    if ((READ_BIT(uart->ISR, UART_FLAG_RXNE) == 0) || (hdma == NULL) ||
+        (READ_BIT(uart->CR3, USART_CR3_DMAR) == 0) ||
+        (READ_BIT(hdma->Instance->CCR, DMA_CCR_EN) == 0) ||
+        (hdma->Instance->CNDTR == 0)) {
+        return -1;
+    }
+
+    /* The receive buf of the driver is `pRxBuffPtr`, CMAR can not hold a
+     * host pointer. */
+    int32_t pos = (int32_t)(huart->RxXferSize - hdma->Instance->CNDTR);
+    huart->pRxBuffPtr[pos] = (uint8_t)uart->RDR;
+    sim_buf_tag[pos] = sim_rdr_tag;
+    CLEAR_BIT(uart->ISR, UART_FLAG_RXNE);
+    ++sim_counter.dma_bytes;
+
+    if (--hdma->Instance->CNDTR == huart->RxXferSize / 2U) {
+        sim_dma_set_flags(hdma, DMA_IT_HT);
+    }
+
+    if (hdma->Instance->CNDTR == 0) {
+        sim_dma_set_flags(hdma, DMA_IT_TC);
+        if (READ_BIT(hdma->Instance->CCR, DMA_CIRCULAR)) {
+            hdma->Instance->CNDTR = huart->RxXferSize;
+        } else {
+            CLEAR_BIT(hdma->Instance->CCR, DMA_CCR_EN);
+        }
+    }
+
+    return pos;
+}
+
+/**
+ * @brief The receiver completes a byte.
+ *
+ * @param byte The byte.
+ * @param tag The tag of byte, read back by `sim_rx_tag`.
+ * @return The position in receive buf that DMA writes it to, -1 if it stays
+ *         in RDR, -2 if it is lost by overrun or the receiver is off.
+ */
+int32_t sim_rx_byte(uint8_t byte, uint32_t tag) {
+    USART_TypeDef *uart = sim_port.huart->Instance;
+    int32_t pos;
+
+    ++sim_counter.rx_bytes;
+
+    if ((READ_BIT(uart->CR1, USART_CR1_UE) == 0) ||
+        (READ_BIT(uart->CR1, USART_CR1_RE) == 0)) {
+        return -2;
+    }
+
+    if (READ_BIT(uart->ISR, UART_FLAG_RXNE)) {
+        /* Try DMA first, DMAR may be set again. */
+        sim_dma_take();
+    }
+
+    if (READ_BIT(uart->ISR, UART_FLAG_RXNE)) {
+        SET_BIT(uart->ISR, UART_FLAG_ORE);
+        ++sim_counter.overruns;
+        sim_irq_dispatch();
+        return -2;
+    }
+
+    uart->RDR = byte;
+    sim_rdr_tag = tag;
+    SET_BIT(uart->ISR, UART_FLAG_RXNE | UART_FLAG_BUSY);
+    CLEAR_BIT(uart->ISR, UART_FLAG_IDLE);
+
+    if (READ_BIT(uart->CR2, USART_CR2_ADDM7) &&
+        ((uart->CR2 >> USART_CR2_ADD_Pos) == byte)) {
+        SET_BIT(uart->ISR, UART_FLAG_CMF);
+    }
+
+    pos = sim_dma_take();
+    sim_irq_dispatch();
+    return pos;
+}
+
+/**
+ * @brief Get the tag of the byte that DMA wrote to receive buf.
+ *
+ * @param pos The position in receive buf.
+ * @return The tag passed to `sim_rx_byte`.
+ */
+uint32_t sim_rx_tag(uint32_t pos) {
+    return sim_buf_tag[pos];
+}
+
+/**
+ * @brief Get the tag of the next byte that the CPU read from RDR.
+ *
+ * @return The tag passed to `sim_rx_byte`, in the order of reads.
+ */
+uint32_t sim_rx_read_tag(void) {
+    return sim_read_tag[sim_read_tail++ % SIM_READ_TAGS];
+}
+
+/**
+ * @brief Read a register, RDR is taken by the read.
+ *
+ * @param reg The register.
+ * @return The value.
+ */
+uint32_t sim_read_reg(__IO uint32_t *reg) {
+    uint32_t value = *reg;
+    USART_TypeDef *uart;
+
+    if (sim_port.huart == NULL) {
+        return value;
+    }
+
+    uart = sim_port.huart->Instance;
+    if ((reg == &uart->RDR) && READ_BIT(uart->ISR, UART_FLAG_RXNE)) {
+        CLEAR_BIT(uart->ISR, UART_FLAG_RXNE);
+        sim_read_tag[sim_read_head++ % SIM_READ_TAGS] = sim_rdr_tag;
+    }
+
+    return value;
+}
+
+/**
+ * @brief The line is idle for a frame after the last byte.
+ *
+ */
+void sim_rx_idle(void) {
+    USART_TypeDef *uart = sim_port.huart->Instance;
+
+    if (READ_BIT(uart->ISR, UART_FLAG_BUSY)) {
+        CLEAR_BIT(uart->ISR, UART_FLAG_BUSY);
+        SET_BIT(uart->ISR, UART_FLAG_IDLE);
+    }
+    sim_dma_take();
+    sim_irq_dispatch();
+}
+
+/**
+ * @brief The receiver flags an error with the last byte.
+ *
+ * @param flag `UART_FLAG_PE`, `UART_FLAG_FE`, `UART_FLAG_NE` or
+ *             `UART_FLAG_ORE`.
+ */
+void sim_rx_error(uint32_t flag) {
+    SET_BIT(sim_port.huart->Instance->ISR, flag);
+    sim_irq_dispatch();
+}
+
+/**
+ * @brief The Rx DMA channel meets a bus error, the hardware disables it.
+ *
+ */
+void sim_dma_error(void) {
+    DMA_HandleTypeDef *hdma = sim_port.huart->hdmarx;
+
+    if (hdma == NULL) {
+        return;
+    }
+
+    CLEAR_BIT(hdma->Instance->CCR, DMA_CCR_EN);
+    sim_dma_set_flags(hdma, DMA_IT_TE);
+    sim_irq_dispatch();
+}
+
+/**
+ * @brief Let DMA take the byte waiting in RDR.
+ *
+ * @param max Unused, a byte is moved at most.
+ */
+void sim_dma_move(uint32_t max) {
+    (void)max;
+    sim_dma_take();
+}
+
+/**
+ * @brief Whether the UART interrupt is pending.
+ *
+ * @return Non-zero if pending.
+ */
+static uint32_t sim_uart_pending(void) {
+    USART_TypeDef *uart = sim_port.huart->Instance;
+    uint32_t isr = uart->ISR, cr1 = uart->CR1, cr3 = uart->CR3;
+
+    return ((isr & UART_FLAG_IDLE) && (cr1 & USART_CR1_IDLEIE)) ||
+           ((isr & UART_FLAG_RXNE) && (cr1 & USART_CR1_RXNEIE_RXFNEIE)) ||
+           ((isr & UART_FLAG_CMF) && (cr1 & USART_CR1_CMIE)) ||
+           ((isr & UART_FLAG_RTOF) && (cr1 & USART_CR1_RTOIE)) ||
+           ((isr & UART_FLAG_PE) && (cr1 & USART_CR1_PEIE)) ||
+           ((isr & UART_FLAG_ORE) &&
+            ((cr1 & USART_CR1_RXNEIE_RXFNEIE) || (cr3 & USART_CR3_EIE))) ||
+           ((isr & (UART_FLAG_FE | UART_FLAG_NE)) && (cr3 & USART_CR3_EIE));
+}
+
+/**
+ * @brief Whether the Rx DMA interrupt is pending.
+ *
+ * @return Non-zero if pending.
+ */
+static uint32_t sim_dma_pending(void) {
+    DMA_HandleTypeDef *hdma = sim_port.huart->hdmarx;
+
+    if (hdma == NULL) {
+        return 0;
+    }
+
+    return sim_dma_flags(hdma) & hdma->Instance->CCR &
+           (DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
+}
+
+/**
+ * @brief Run an interrupt handler.
+ *
+ * @param irq `SIM_IRQ_UART` or `SIM_IRQ_DMA`.
+ */
+static void sim_irq_run(uint32_t irq) {
+    uint32_t ipsr = sim_ipsr;
+
+    sim_active |= irq;
+    if (irq == SIM_IRQ_UART) {
+        sim_ipsr = 16U + (uint32_t)LPUART1_IRQn;
+        ++sim_counter.uart_irqs;
+        sim_port.uart_irq();
+    } else {
+        sim_ipsr = 16U + (uint32_t)DMA1_Channel1_IRQn;
+        ++sim_counter.dma_irqs;
+        sim_port.dma_rx_irq();
+    }
+    sim_active &= ~irq;
+    sim_ipsr = ipsr;
+}
+
+/**
+ * @brief Raise the UART interrupt now, as a spurious or late one.
+ *
+ */
+void sim_irq_uart(void) {
+    if (!(sim_active & SIM_IRQ_UART) && (sim_primask == 0)) {
+        sim_irq_run(SIM_IRQ_UART);
+    }
+}
+
+/**
+ * @brief Raise the Rx DMA interrupt now, as a spurious or late one.
+ *
+ */
+void sim_irq_dma(void) {
+    if ((sim_port.dma_rx_irq != NULL) && !(sim_active & SIM_IRQ_DMA) &&
+        (sim_primask == 0)) {
+        sim_irq_run(SIM_IRQ_DMA);
+    }
+}
+
+/**
+ * @brief Run the pending interrupts which are not masked or active.
+ *
+ * @note Any interrupt preempts the other one, the worst case of priority.
+ */
+void sim_irq_dispatch(void) {
+    uint32_t count = 0;
+
+    if ((sim_port.huart == NULL) || (sim_primask != 0)) {
+        return;
+    }
+
+    for (;;) {
+        if (!(sim_active & SIM_IRQ_DMA) && sim_dma_pending()) {
+            sim_irq_run(SIM_IRQ_DMA);
+        } else if (!(sim_active & SIM_IRQ_UART) && sim_uart_pending()) {
+            sim_irq_run(SIM_IRQ_UART);
+        } else {
+            break;
+        }
+
+        if (++count == SIM_STORM_LIMIT) {
+            ++sim_counter.irq_storms;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief PRIMASK is cleared, run what was held off.
+ *
+ */
+void sim_irq_unmasked(void) {
+    sim_irq_dispatch();
+}
+
+/**
+ * @brief Read NDTR, the simulation may move on before and after.
+ *
+ * @param channel The DMA channel.
+ * @return NDTR.
+ */
+uint32_t sim_dma_get_counter(DMA_Channel_TypeDef *channel) {
+    uint32_t cndtr;
+
+    if (sim_counter_hook != NULL) {
+        sim_counter_hook();
+    }
+
+    cndtr = channel->CNDTR;
+
+    if (sim_counter_hook != NULL) {
+        /* The value read is stale now. */
+        sim_counter_hook();
+    }
+
+    return cndtr;
+}
+
+/**
+ * @brief Wait for interrupt.
+ *
+ */
+void __WFI(void) {
+    if (sim_wfi_hook != NULL) {
+        sim_wfi_hook();
+    }
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup Core, GPIO and RCC.
+ * @{
+ */
+
+uint32_t HAL_GetTick(void) {
+    return (uint32_t)(sim_time_ns / 1000000U);
+}
+
+void HAL_Delay(uint32_t Delay) {
+    sim_advance(sim_time_ns + (uint64_t)Delay * 1000000U);
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) {
+    (void)IRQn;
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn) {
+    (void)IRQn;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority,
+                          uint32_t SubPriority) {
+    (void)IRQn;
+    (void)PreemptPriority;
+    (void)SubPriority;
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init) {
+    (void)GPIOx;
+    (void)GPIO_Init;
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin) {
+    (void)GPIOx;
+    (void)GPIO_Pin;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void) {
+    return SIM_CLOCK_HZ;
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void) {
+    return SIM_CLOCK_HZ;
+}
+
+uint32_t HAL_RCC_GetSysClockFreq(void) {
+    return SIM_CLOCK_HZ;
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup DMA.
+ * @{
+ */
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma) {
+    hdma->Instance->CCR = hdma->Init.Direction | hdma->Init.Mode |
+                          hdma->Init.MemInc | hdma->Init.Priority;
+    hdma->ErrorCode = HAL_DMA_ERROR_NONE;
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma) {
+    hdma->Instance->CCR = 0;
+    hdma->Instance->CNDTR = 0;
+    __HAL_DMA_CLEAR_FLAG(hdma, 0x0FUL << SIM_DMA_SHIFT(hdma));
+    hdma->XferCpltCallback = NULL;
+    hdma->XferHalfCpltCallback = NULL;
+    hdma->XferErrorCallback = NULL;
+    hdma->XferAbortCallback = NULL;
+    hdma->State = HAL_DMA_STATE_RESET;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma) {
+    __HAL_DMA_DISABLE_IT(hdma, DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
+    __HAL_DMA_DISABLE(hdma);
+    __HAL_DMA_CLEAR_FLAG(hdma, 0x0FUL << SIM_DMA_SHIFT(hdma));
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort_IT(DMA_HandleTypeDef *hdma) {
+    HAL_DMA_Abort(hdma);
+    if (hdma->XferAbortCallback != NULL) {
+        hdma->XferAbortCallback(hdma);
+    }
+    return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma) {
+    uint32_t flags = sim_dma_flags(hdma);
+    uint32_t its = hdma->Instance->CCR;
+
+    if ((flags & DMA_IT_HT) && (its & DMA_IT_HT)) {
+        __HAL_DMA_CLEAR_FLAG(hdma, __HAL_DMA_GET_HT_FLAG_INDEX(hdma));
+        if ((its & DMA_CIRCULAR) == 0) {
+            __HAL_DMA_DISABLE_IT(hdma, DMA_IT_HT);
+        }
+        if (hdma->XferHalfCpltCallback != NULL) {
+            hdma->XferHalfCpltCallback(hdma);
+        }
+    } else if ((flags & DMA_IT_TC) && (its & DMA_IT_TC)) {
+        if ((its & DMA_CIRCULAR) == 0) {
+            __HAL_DMA_DISABLE_IT(hdma, DMA_IT_TE | DMA_IT_TC);
+            hdma->State = HAL_DMA_STATE_READY;
+        }
+        __HAL_DMA_CLEAR_FLAG(hdma, __HAL_DMA_GET_TC_FLAG_INDEX(hdma));
+        if (hdma->XferCpltCallback != NULL) {
+            hdma->XferCpltCallback(hdma);
+        }
+    } else if ((flags & DMA_IT_TE) && (its & DMA_IT_TE)) {
+        __HAL_DMA_DISABLE_IT(hdma, DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
+        __HAL_DMA_CLEAR_FLAG(hdma, __HAL_DMA_GET_GI_FLAG_INDEX(hdma) |
+                                       __HAL_DMA_GET_TE_FLAG_INDEX(hdma));
+        hdma->ErrorCode = HAL_DMA_ERROR_TE;
+        hdma->State = HAL_DMA_STATE_READY;
+        if (hdma->XferErrorCallback != NULL) {
+            hdma->XferErrorCallback(hdma);
+        }
+    }
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup UART.
+ * @{
+ */
+
+/**
+ * @brief End the reception on error, like `UART_EndRxTransfer`.
+ *
+ * @param huart The handle of UART.
+ */
+static void uart_end_rx_transfer(UART_HandleTypeDef *huart) {
+    CLEAR_BIT(huart->Instance->CR1, USART_CR1_RXNEIE_RXFNEIE | USART_CR1_PEIE);
+    CLEAR_BIT(huart->Instance->CR3, USART_CR3_EIE | USART_CR3_RXFTIE);
+    huart->RxState = HAL_UART_STATE_READY;
+    huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+    huart->RxISR = NULL;
+}
+
+static void uart_dma_rx_half(DMA_HandleTypeDef *hdma) {
+    HAL_UART_RxHalfCpltCallback((UART_HandleTypeDef *)hdma->Parent);
+}
+
+static void uart_dma_rx_cplt(DMA_HandleTypeDef *hdma) {
+    UART_HandleTypeDef *huart = hdma->Parent;
+
+    if ((hdma->Instance->CCR & DMA_CIRCULAR) == 0) {
+        huart->RxXferCount = 0;
+        CLEAR_BIT(huart->Instance->CR3, USART_CR3_DMAR);
+        huart->RxState = HAL_UART_STATE_READY;
+    }
+    HAL_UART_RxCpltCallback(huart);
+}
+
+static void uart_dma_error(DMA_HandleTypeDef *hdma) {
+    UART_HandleTypeDef *huart = hdma->Parent;
+
+    if ((huart->RxState == HAL_UART_STATE_BUSY_RX) &&
+        READ_BIT(huart->Instance->CR3, USART_CR3_DMAR)) {
+        huart->RxXferCount = 0;
+        uart_end_rx_transfer(huart);
+    }
+
+    huart->ErrorCode |= HAL_UART_ERROR_DMA;
+    HAL_UART_ErrorCallback(huart);
+}
+
+static void uart_dma_abort_on_error(DMA_HandleTypeDef *hdma) {
+    UART_HandleTypeDef *huart = hdma->Parent;
+
+    huart->RxXferCount = 0;
+    HAL_UART_ErrorCallback(huart);
+}
+
+static void uart_rx_isr(UART_HandleTypeDef *huart) {
+    *huart->pRxBuffPtr++ = (uint8_t)READ_REG(huart->Instance->RDR);
+
+    if (--huart->RxXferCount == 0) {
+        CLEAR_BIT(huart->Instance->CR1,
+                  USART_CR1_RXNEIE_RXFNEIE | USART_CR1_PEIE);
+        CLEAR_BIT(huart->Instance->CR3, USART_CR3_EIE);
+        huart->RxState = HAL_UART_STATE_READY;
+        huart->RxISR = NULL;
+        HAL_UART_RxCpltCallback(huart);
+    }
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart) {
+    huart->Instance->CR1 = 0;
+    huart->Instance->CR2 = 0;
+    huart->Instance->CR3 = 0;
+    huart->Instance->ISR = 0;
+    huart->Instance->BRR = SIM_CLOCK_HZ / huart->Init.BaudRate;
+    if (huart->Init.Mode & UART_MODE_RX) {
+        SET_BIT(huart->Instance->CR1, USART_CR1_RE);
+    }
+    if (huart->Init.Mode & UART_MODE_TX) {
+        SET_BIT(huart->Instance->CR1, USART_CR1_TE);
+    }
+    SET_BIT(huart->Instance->CR1, USART_CR1_UE);
+
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->gState = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_HalfDuplex_Init(UART_HandleTypeDef *huart) {
+    HAL_UART_Init(huart);
+    SET_BIT(huart->Instance->CR3, USART_CR3_HDSEL);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RS485Ex_Init(UART_HandleTypeDef *huart,
+                                   uint32_t Polarity, uint32_t AssertionTime,
+                                   uint32_t DeassertionTime) {
+    (void)Polarity;
+    (void)AssertionTime;
+    (void)DeassertionTime;
+    HAL_UART_Init(huart);
+    SET_BIT(huart->Instance->CR3, USART_CR3_DEM);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_DeInit(UART_HandleTypeDef *huart) {
+    huart->Instance->CR1 = 0;
+    huart->Instance->CR2 = 0;
+    huart->Instance->CR3 = 0;
+    huart->Instance->ISR = 0;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->gState = HAL_UART_STATE_RESET;
+    huart->RxState = HAL_UART_STATE_RESET;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_RegisterCallback(UART_HandleTypeDef *huart,
+                                            HAL_UART_CallbackIDTypeDef CallbackID,
+                                            pUART_CallbackTypeDef pCallback) {
+    (void)huart;
+    (void)CallbackID;
+    (void)pCallback;
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef
+HAL_UART_UnRegisterCallback(UART_HandleTypeDef *huart,
+                            HAL_UART_CallbackIDTypeDef CallbackID) {
+    (void)huart;
+    (void)CallbackID;
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart,
+                                    const uint8_t *pData, uint16_t Size,
+                                    uint32_t Timeout) {
+    (void)Timeout;
+    if ((pData == NULL) || (Size == 0)) {
+        return HAL_ERROR;
+    }
+    if (huart->gState != HAL_UART_STATE_READY) {
+        return HAL_BUSY;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart,
+                                       const uint8_t *pData, uint16_t Size) {
+    (void)huart;
+    (void)pData;
+    (void)Size;
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart,
+                                        const uint8_t *pData, uint16_t Size) {
+    (void)huart;
+    (void)pData;
+    (void)Size;
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortTransmit_IT(UART_HandleTypeDef *huart) {
+    (void)huart;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart,
+                                      uint8_t *pData, uint16_t Size) {
+    if (huart->RxState != HAL_UART_STATE_READY) {
+        return HAL_BUSY;
+    }
+    if ((pData == NULL) || (Size == 0)) {
+        return HAL_ERROR;
+    }
+
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->RxXferCount = Size;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    huart->RxISR = uart_rx_isr;
+    if (huart->Init.Parity != UART_PARITY_NONE) {
+        SET_BIT(huart->Instance->CR1, USART_CR1_PEIE);
+    }
+    SET_BIT(huart->Instance->CR3, USART_CR3_EIE);
+    SET_BIT(huart->Instance->CR1, USART_CR1_RXNEIE_RXFNEIE);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart,
+                                       uint8_t *pData, uint16_t Size) {
+    DMA_HandleTypeDef *hdma = huart->hdmarx;
+
+    if (huart->RxState != HAL_UART_STATE_READY) {
+        return HAL_BUSY;
+    }
+    if ((pData == NULL) || (Size == 0) || (hdma == NULL)) {
+        return HAL_ERROR;
+    }
+
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+
+    hdma->XferHalfCpltCallback = uart_dma_rx_half;
+    hdma->XferCpltCallback = uart_dma_rx_cplt;
+    hdma->XferErrorCallback = uart_dma_error;
+    hdma->XferAbortCallback = NULL;
+    hdma->State = HAL_DMA_STATE_BUSY;
+    hdma->Instance->CMAR = (uint32_t)(uintptr_t)pData;
+    hdma->Instance->CNDTR = Size;
+    __HAL_DMA_CLEAR_FLAG(hdma, 0x0FUL << SIM_DMA_SHIFT(hdma));
+    __HAL_DMA_ENABLE_IT(hdma, DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
+    __HAL_DMA_ENABLE(hdma);
+
+    __HAL_UART_CLEAR_OREFLAG(huart);
+    if (huart->Init.Parity != UART_PARITY_NONE) {
+        SET_BIT(huart->Instance->CR1, USART_CR1_PEIE);
+    }
+    SET_BIT(huart->Instance->CR3, USART_CR3_EIE);
+    SET_BIT(huart->Instance->CR3, USART_CR3_DMAR);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle(UART_HandleTypeDef *huart,
+                                           uint8_t *pData, uint16_t Size,
+                                           uint16_t *RxLen, uint32_t Timeout) {
+    (void)huart;
+    (void)pData;
+    (void)Size;
+    (void)Timeout;
+    *RxLen = 0;
+    return HAL_TIMEOUT;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_EnableFifoMode(UART_HandleTypeDef *huart) {
+    SET_BIT(huart->Instance->CR1, USART_CR1_FIFOEN);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_DisableFifoMode(UART_HandleTypeDef *huart) {
+    CLEAR_BIT(huart->Instance->CR1, USART_CR1_FIFOEN);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_SetTxFifoThreshold(UART_HandleTypeDef *huart,
+                                                uint32_t Threshold) {
+    (void)huart;
+    (void)Threshold;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_SetRxFifoThreshold(UART_HandleTypeDef *huart,
+                                                uint32_t Threshold) {
+    (void)huart;
+    (void)Threshold;
+    return HAL_OK;
+}
+
+void HAL_UART_ReceiverTimeout_Config(UART_HandleTypeDef *huart,
+                                     uint32_t TimeoutValue) {
+    MODIFY_REG(huart->Instance->RTOR, USART_RTOR_RTO, TimeoutValue);
+}
+
+HAL_StatusTypeDef HAL_UART_EnableReceiverTimeout(UART_HandleTypeDef *huart) {
+    SET_BIT(huart->Instance->CR2, USART_CR2_RTOEN);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_DisableReceiverTimeout(UART_HandleTypeDef *huart) {
+    CLEAR_BIT(huart->Instance->CR2, USART_CR2_RTOEN);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_MultiProcessor_EnableMuteMode(UART_HandleTypeDef *huart) {
+    SET_BIT(huart->Instance->CR1, USART_CR1_MME);
+    return HAL_OK;
+}
+
+void HAL_MultiProcessor_EnterMuteMode(UART_HandleTypeDef *huart) {
+    (void)huart;
+}
+
+HAL_UART_StateTypeDef HAL_UART_GetState(const UART_HandleTypeDef *huart) {
+    return huart->gState | huart->RxState;
+}
+
+uint32_t HAL_UART_GetError(const UART_HandleTypeDef *huart) {
+    return huart->ErrorCode;
+}
+
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart) {
+    uint32_t isr = huart->Instance->ISR;
+    uint32_t cr1 = huart->Instance->CR1;
+    uint32_t cr3 = huart->Instance->CR3;
+    uint32_t errors =
+        isr & (UART_FLAG_PE | UART_FLAG_FE | UART_FLAG_NE | UART_FLAG_ORE |
+               UART_FLAG_RTOF);
+
+    if (errors == 0) {
+        if ((isr & UART_FLAG_RXNE) && (cr1 & USART_CR1_RXNEIE_RXFNEIE) &&
+            (huart->RxISR != NULL)) {
+            huart->RxISR(huart);
+        }
+        return;
+    }
+
+    if ((isr & UART_FLAG_PE) && (cr1 & USART_CR1_PEIE)) {
+        __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_PEF);
+        huart->ErrorCode |= HAL_UART_ERROR_PE;
+    }
+    if ((isr & UART_FLAG_FE) && (cr3 & USART_CR3_EIE)) {
+        __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_FEF);
+        huart->ErrorCode |= HAL_UART_ERROR_FE;
+    }
+    if ((isr & UART_FLAG_NE) && (cr3 & USART_CR3_EIE)) {
+        __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_NEF);
+        huart->ErrorCode |= HAL_UART_ERROR_NE;
+    }
+    if ((isr & UART_FLAG_ORE) &&
+        ((cr1 & USART_CR1_RXNEIE_RXFNEIE) || (cr3 & USART_CR3_EIE))) {
+        __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_OREF);
+        huart->ErrorCode |= HAL_UART_ERROR_ORE;
+    }
+    if ((isr & UART_FLAG_RTOF) && (cr1 & USART_CR1_RTOIE)) {
+        __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_RTOF);
+        huart->ErrorCode |= HAL_UART_ERROR_RTO;
+    }
+
+    if (huart->ErrorCode == HAL_UART_ERROR_NONE) {
+        return;
+    }
+
+    if ((isr & UART_FLAG_RXNE) && (cr1 & USART_CR1_RXNEIE_RXFNEIE) &&
+        (huart->RxISR != NULL)) {
+        huart->RxISR(huart);
+    }
+
+    if ((huart->ErrorCode & (HAL_UART_ERROR_ORE | HAL_UART_ERROR_RTO)) ||
+        READ_BIT(huart->Instance->CR3, USART_CR3_DMAR)) {
+        /* Blocking error, the reception is ended. */
+        uart_end_rx_transfer(huart);
+
+        if (READ_BIT(huart->Instance->CR3, USART_CR3_DMAR)) {
+            CLEAR_BIT(huart->Instance->CR3, USART_CR3_DMAR);
+            if (huart->hdmarx != NULL) {
+                huart->hdmarx->XferAbortCallback = uart_dma_abort_on_error;
+                HAL_DMA_Abort_IT(huart->hdmarx);
+                return;
+            }
+        }
+        HAL_UART_ErrorCallback(huart);
+    } else {
+        HAL_UART_ErrorCallback(huart);
+        huart->ErrorCode = HAL_UART_ERROR_NONE;
+    }
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,74 @@
+/**
+ * @file    sim_hal.h
+ * @brief   Model of USART receiver and DMA channel behind the mock HAL.
+ * @note    One UART port is attached. Time is simulated in nanoseconds, the
+ *          caller drives the line byte by byte (`sim_rx_byte`) and the idle
+ *          frame (`sim_rx_idle`), the model moves the byte by DMA (NDTR,
+ *          half and complete flags) or leaves it in RDR until the CPU reads
+ *          it, and runs the UART and DMA interrupt handlers of the driver
+ *          when they are pending and not masked. The hardware FIFO and the
+ *          transmitter are not modelled.
+ */
+
+#ifndef __SIM_HAL_H
+#define __SIM_HAL_H
+
+#include <stdint.h>
+
+#include "stm32g4xx_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * @brief The port under simulation.
+ */
+typedef struct {
+    UART_HandleTypeDef *huart; /*!< Handle of UART.                */
+    void (*uart_irq)(void);    /*!< UART IRQ handler of the driver. */
+    void (*dma_rx_irq)(void);  /*!< DMA Rx IRQ handler of driver,
+                                    NULL if it receives by interrupt. */
+} sim_port_t;
+
+/**
+ * @brief Counters of the model.
+ */
+typedef struct {
+    uint64_t rx_bytes;    /*!< Bytes on the line.                    */
+    uint64_t dma_bytes;   /*!< Bytes moved by DMA.                   */
+    uint64_t overruns;    /*!< Bytes lost by overrun (RDR is full).  */
+    uint64_t uart_irqs;   /*!< UART interrupts that are served.      */
+    uint64_t dma_irqs;    /*!< DMA interrupts that are served.       */
+    uint64_t irq_storms;  /*!< A flag is still pending after the
+                               handler ran many times.               */
+} sim_counter_t;
+
+extern uint64_t sim_time_ns;
+extern sim_counter_t sim_counter;
+
+/* Called before and after the driver reads NDTR, the stress test preempts
+ * there. */
+extern void (*sim_counter_hook)(void);
+/* Called by `__WFI()`, the owner of time advances it. */
+extern void (*sim_wfi_hook)(void);
+
+void sim_init(void);
+void sim_attach(const sim_port_t *port);
+void sim_advance(uint64_t time_ns);
+int32_t sim_rx_byte(uint8_t byte, uint32_t tag);
+uint32_t sim_rx_tag(uint32_t pos);
+uint32_t sim_rx_read_tag(void);
+void sim_rx_idle(void);
+void sim_rx_error(uint32_t flag);
+void sim_dma_error(void);
+void sim_dma_move(uint32_t max);
+void sim_irq_uart(void);
+void sim_irq_dma(void);
+void sim_irq_dispatch(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __SIM_HAL_H */
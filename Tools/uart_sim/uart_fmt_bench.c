@@ -0,0 +1,154 @@
+/**
+ * @file    uart_fmt_bench.c
+ * @brief   Cycle count of the compact formatter against libc `vsnprintf`.
+ * @note    The driver is built in this file with `UART_PRINTF_COMPACT`, to
+ *          reach the static `uart_vsnprintf`. Each case is a typical log
+ *          line, both formatters must give the same output. Cycles are read
+ *          by `rdtsc` on x86, elsewhere nanoseconds are reported instead.
+ *
+ *          Exit status is 1 if an output differs.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif /* defined(__x86_64__) || defined(__i386__) */
+
+#include "../../UART_STM32G4xx.c"
+
+/* Calls of a case in one measure, the best of the measures is taken. */
+#define BENCH_CALLS    100000U
+#define BENCH_MEASURES 5U
+
+typedef int (*bench_fmt_t)(char *buf, size_t size, const char *fmt, ...);
+
+/**
+ * @brief The cases, name, format and arguments.
+ */
+#define BENCH_CASES(X)                                                         \
+    X(text, "heartbeat ok\r\n", 0)                                             \
+    X(int, "id=%d cnt=%u\r\n", -12345, 67890U)                                 \
+    X(hex, "reg[%02x]=0x%08lX\r\n", 0x1FU, 0xDEADBEEFUL)                       \
+    X(str, "[%-8s] %s\r\n", "uart", "link up")                                 \
+    X(short, "%hhu.%hhu.%hhu.%hhu:%hu\r\n", 192, 168, 1, 10, 8080)             \
+    X(llong, "t=%llu us, d=%lld\r\n", 123456789012ULL, -42LL)                  \
+    X(float, "temp=%.2f v=%.3f\r\n", 23.5, -3.25)                              \
+    X(alt, "%#x %#X %#o %#o %#.0f %#08x\r\n", 0x1FU, 0U, 8U, 0U, 2.0, 0xABU)    \
+    X(prec, "%.12f|%-16.11f|%016.10f\r\n", 23.5, -0.25, 1.125)                  \
+    X(mixed, "%s:%d: %c %+6d|%-5x|%%\r\n", "main.c", 128, 'E', 42, 0xABCU)
+
+#define BENCH_CASE_FN(name, fmt, ...)                                          \
+    static int bench_##name(bench_fmt_t f, char *buf, size_t size) {           \
+        return f(buf, size, fmt, __VA_ARGS__);                                 \
+    }
+BENCH_CASES(BENCH_CASE_FN)
+
+typedef struct {
+    const char *name;
+    int (*run)(bench_fmt_t f, char *buf, size_t size);
+} bench_case_t;
+
+#define BENCH_CASE_ENTRY(name, fmt, ...) {#name, bench_##name},
+static const bench_case_t bench_cases[] = {BENCH_CASES(BENCH_CASE_ENTRY)};
+
+static int fmt_compact(char *buf, size_t size, const char *fmt, ...) {
+    va_list ap;
+    int len;
+
+    va_start(ap, fmt);
+    len = uart_vsnprintf(buf, size, fmt, ap);
+    va_end(ap);
+    return len;
+}
+
+static int fmt_libc(char *buf, size_t size, const char *fmt, ...) {
+    va_list ap;
+    int len;
+
+    va_start(ap, fmt);
+    len = vsnprintf(buf, size, fmt, ap);
+    va_end(ap);
+    return len;
+}
+
+/**
+ * @brief Read the time stamp.
+ *
+ * @return Cycles on x86, nanoseconds elsewhere.
+ */
+static inline uint64_t bench_stamp(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else  /* defined(__x86_64__) || defined(__i386__) */
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+#endif /* defined(__x86_64__) || defined(__i386__) */
+}
+
+/**
+ * @brief Measure a case.
+ *
+ * @param c The case.
+ * @param f The formatter.
+ * @return The best time of a call.
+ */
+static double bench_measure(const bench_case_t *c, bench_fmt_t f) {
+    char buf[128];
+    double best = 0;
+    uint32_t m, i;
+    volatile int sink = 0;
+
+    for (m = 0; m < BENCH_MEASURES; ++m) {
+        uint64_t start = bench_stamp();
+        for (i = 0; i < BENCH_CALLS; ++i) {
+            sink += c->run(f, buf, sizeof(buf));
+        }
+        double t = (double)(bench_stamp() - start) / BENCH_CALLS;
+        if ((m == 0) || (t < best)) {
+            best = t;
+        }
+    }
+
+    (void)sink;
+    return best;
+}
+
+int main(void) {
+    char expect[128], actual[128];
+    uint32_t failed = 0;
+    size_t i;
+
+#if defined(__x86_64__) || defined(__i386__)
+    const char *unit = "cycles";
+#else  /* defined(__x86_64__) || defined(__i386__) */
+    const char *unit = "ns";
+#endif /* defined(__x86_64__) || defined(__i386__) */
+
+    printf("%-8s %12s %12s %7s  (%s per call)\n", "case", "compact",
+           "vsnprintf", "ratio", unit);
+
+    for (i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); ++i) {
+        const bench_case_t *c = &bench_cases[i];
+        int expect_len = c->run(fmt_libc, expect, sizeof(expect));
+        int actual_len = c->run(fmt_compact, actual, sizeof(actual));
+
+        if ((expect_len != actual_len) || (strcmp(expect, actual) != 0)) {
+            printf("%-8s differs: \"%s\" (%d), vsnprintf \"%s\" (%d)\n",
+                   c->name, actual, actual_len, expect, expect_len);
+            ++failed;
+            continue;
+        }
+
+        double compact = bench_measure(c, fmt_compact);
+        double libc = bench_measure(c, fmt_libc);
+        printf("%-8s %12.1f %12.1f %7.2f\n", c->name, compact, libc,
+               compact / libc);
+    }
+
+    return failed ? 1 : 0;
+}
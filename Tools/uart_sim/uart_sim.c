@@ -0,0 +1,279 @@
+/**
+ * @file    uart_sim.c
+ * @brief   Rx benchmark of the UART driver on the host simulation.
+ * @note    LPUART1 receives by DMA. The line sends bursts of a counting
+ *          pattern with a gap of idle frames, a consumer polls
+ *          `uart_dmarx_read` at a fixed period. Every byte the consumer gets
+ *          is checked against the pattern at its position on the line.
+ *
+ *          The sweep covers the baud rate, the burst size, the fifo size and
+ *          the poll period, and reports per run:
+ *          - the throughput seen by the consumer,
+ *          - the latency from the stop bit to the read (average and max),
+ *          - the bytes dropped by the fifo and by overrun,
+ *          - the DMA events and interrupts per kilobyte.
+ *
+ *          Exit status is 1 if a byte is corrupted or out of order.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ring_fifo/ring_fifo.h"
+#include "sim_hal.h"
+
+#include "CSP_Config.h"
+
+/* Declared by the startup file on the target. */
+void LPUART1_IRQHandler(void);
+void LPUART1_RX_DMA_IRQHandler(void);
+
+/* Bytes sent in one run. */
+#define SIM_RUN_BYTES 32768U
+
+/* Size of the DMA receive buf, the same in every run. */
+#define SIM_DMA_BUF   256U
+
+static const uint32_t sweep_baud[] = {115200U, 921600U, 3000000U};
+static const uint32_t sweep_burst[] = {16U, 64U, 256U, 1024U};
+static const uint32_t sweep_fifo[] = {256U, 1024U, 4096U};
+static const uint32_t sweep_poll_us[] = {100U, 1000U, 10000U};
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
+
+/**
+ * @brief Result of a run.
+ */
+typedef struct {
+    uint64_t bytes;      /*!< Bytes read by the consumer.          */
+    uint64_t line_ns;    /*!< Stop bit of the last byte.           */
+    uint64_t last_ns;    /*!< Time of the last read with data.     */
+    uint64_t lat_sum_ns; /*!< Sum of latency.                      */
+    uint64_t lat_max_ns; /*!< Max latency.                         */
+    uint64_t fifo_drops; /*!< Bytes dropped by the fifo.           */
+    uint64_t corrupt;    /*!< Bytes not equal to the pattern.      */
+    uint64_t disorder;   /*!< Bytes older than the previous read.  */
+} run_result_t;
+
+/* Line index of each byte in the fifo, in fifo order. */
+static uint32_t queue[SIM_RUN_BYTES];
+static uint32_t queue_head, queue_tail;
+/* Time of the stop bit of each byte on the line. */
+static uint64_t arrival_ns[SIM_RUN_BYTES];
+static run_result_t result;
+
+/**
+ * @brief The pattern on the line.
+ *
+ * @param index The line index of the byte.
+ * @return The byte.
+ */
+static inline uint8_t pattern(uint32_t index) {
+    return (uint8_t)(index * 7U + (index >> 8));
+}
+
+/**
+ * @brief Follow the bytes the driver writes to the fifo.
+ *
+ */
+static void fifo_write_hook(ring_fifo_t *rf, const void *data,
+                            uint32_t written, size_t len) {
+    uint32_t pos = (uint32_t)((const uint8_t *)data - lpuart1_handle.pRxBuffPtr);
+    uint32_t i;
+
+    (void)rf;
+    for (i = 0; i < written; ++i) {
+        queue[queue_head++ % SIM_RUN_BYTES] = sim_rx_tag(pos + i);
+    }
+    result.fifo_drops += len - written;
+}
+
+/**
+ * @brief The consumer reads all it can.
+ *
+ */
+static void consume(void) {
+    static uint8_t buf[4096];
+    static uint32_t last_index;
+    uint32_t len, i;
+
+    if (result.bytes == 0) {
+        last_index = 0;
+    }
+
+    while ((len = uart_dmarx_read(&lpuart1_handle, buf, sizeof(buf))) != 0) {
+        for (i = 0; i < len; ++i) {
+            uint32_t index = queue[queue_tail++ % SIM_RUN_BYTES];
+            uint64_t latency = sim_time_ns - arrival_ns[index];
+
+            if (buf[i] != pattern(index)) {
+                ++result.corrupt;
+            }
+            if ((result.bytes != 0) && (index <= last_index)) {
+                ++result.disorder;
+            }
+            last_index = index;
+            ++result.bytes;
+
+            result.lat_sum_ns += latency;
+            if (latency > result.lat_max_ns) {
+                result.lat_max_ns = latency;
+            }
+        }
+        result.last_ns = sim_time_ns;
+    }
+}
+
+/**
+ * @brief Run a configuration.
+ *
+ * @param baud The baud rate.
+ * @param burst Bytes in a burst.
+ * @param fifo The size of fifo.
+ * @param poll_us The poll period of consumer.
+ * @param[out] stats The statistics of driver.
+ * @return 0 on success, 1 if the driver can not be started.
+ */
+static uint8_t run(uint32_t baud, uint32_t burst, uint32_t fifo,
+                   uint32_t poll_us, uart_stats_t *stats) {
+    const sim_port_t port = {
+        .huart = &lpuart1_handle,
+        .uart_irq = LPUART1_IRQHandler,
+        .dma_rx_irq = LPUART1_RX_DMA_IRQHandler,
+    };
+    /* 10 bits a frame, 8N1. */
+    const uint64_t char_ns = 10000000000ULL / baud;
+    const uint64_t gap_ns = char_ns * (burst / 4U + 2U);
+    const uint64_t poll_ns = (uint64_t)poll_us * 1000U;
+    uint64_t next_byte = char_ns, next_idle = UINT64_MAX, next_poll = poll_ns;
+    uint64_t end = UINT64_MAX;
+    uint32_t sent = 0;
+
+    sim_init();
+    memset(&result, 0, sizeof(result));
+    queue_head = queue_tail = 0;
+    ring_fifo_write_hook = fifo_write_hook;
+
+    if ((uart_dmarx_resize_fifo(&lpuart1_handle, SIM_DMA_BUF, fifo) != 0) ||
+        (lpuart1_init(baud) != 0)) {
+        return 1;
+    }
+    sim_attach(&port);
+    uart_reset_stats(&lpuart1_handle);
+
+    while (sim_time_ns < end) {
+        uint64_t now = next_byte;
+
+        if (next_idle < now) {
+            now = next_idle;
+        }
+        if (next_poll < now) {
+            now = next_poll;
+        }
+        sim_advance(now);
+
+        if (now == next_byte) {
+            uint32_t index = sent++;
+
+            arrival_ns[index] = now;
+            sim_rx_byte(pattern(index), index);
+
+            next_idle = now + char_ns;
+            if (sent == SIM_RUN_BYTES) {
+                result.line_ns = now;
+                next_byte = UINT64_MAX;
+                end = next_idle + 2U * poll_ns;
+            } else {
+                next_byte = now + char_ns + ((sent % burst) ? 0 : gap_ns);
+            }
+        } else if (now == next_idle) {
+            next_idle = UINT64_MAX;
+            sim_rx_idle();
+        } else {
+            next_poll += poll_ns;
+            consume();
+        }
+    }
+
+    uart_get_stats(&lpuart1_handle, stats);
+    lpuart1_deinit();
+    ring_fifo_write_hook = NULL;
+    return 0;
+}
+
+/**
+ * @brief Print the result of a run.
+ *
+ * @param baud The baud rate.
+ * @param burst Bytes in a burst.
+ * @param fifo The size of fifo.
+ * @param poll_us The poll period of consumer.
+ * @param stats The statistics of driver.
+ * @return 0 if all bytes are read or counted as dropped, and intact.
+ */
+static uint8_t report(uint32_t baud, uint32_t burst, uint32_t fifo,
+                      uint32_t poll_us, const uart_stats_t *stats) {
+    const double kb = (double)SIM_RUN_BYTES / 1024.0;
+    /* Bytes per second read by the consumer, and sent on the line. */
+    double rate = result.last_ns
+                      ? (double)result.bytes * 1e9 / (double)result.last_ns
+                      : 0.0;
+    double line = (double)SIM_RUN_BYTES * 1e9 / (double)result.line_ns;
+    double lat_avg = result.bytes ? (double)result.lat_sum_ns /
+                                        (double)result.bytes
+                                  : 0.0;
+    int64_t lost = (int64_t)SIM_RUN_BYTES - (int64_t)result.bytes -
+                   (int64_t)result.fifo_drops - (int64_t)sim_counter.overruns;
+
+    printf("%8u %6u %6u %7u | %9.1f %5.1f %10.1f %10.1f | %7llu %7llu | "
+           "%7.1f %7.1f %7.1f\n",
+           baud, burst, fifo, poll_us, rate / 1000.0, 100.0 * rate / line,
+           lat_avg / 1000.0, (double)result.lat_max_ns / 1000.0,
+           (unsigned long long)result.fifo_drops,
+           (unsigned long long)sim_counter.overruns,
+           stats->idle_events / kb,
+           (stats->half_events + stats->done_events) / kb,
+           (double)(sim_counter.uart_irqs + sim_counter.dma_irqs) / kb);
+
+    if ((result.corrupt == 0) && (result.disorder == 0) && (lost == 0) &&
+        (sim_counter.irq_storms == 0)) {
+        return 0;
+    }
+
+    printf("  FAIL: corrupt %llu, out of order %llu, lost %lld, "
+           "irq storms %llu\n",
+           (unsigned long long)result.corrupt,
+           (unsigned long long)result.disorder, (long long)lost,
+           (unsigned long long)sim_counter.irq_storms);
+    return 1;
+}
+
+int main(void) {
+    size_t b, s, f, p;
+    uint32_t failed = 0;
+
+    printf("%8s %6s %6s %7s | %9s %5s %10s %10s | %7s %7s | %7s %7s %7s\n",
+           "baud", "burst", "fifo", "poll_us", "kB/s", "line%", "lat_avg_us",
+           "lat_max_us", "drop_ff", "drop_or", "idle/kB", "dma/kB",
+           "irq/kB");
+
+    for (b = 0; b < ARRAY_SIZE(sweep_baud); ++b) {
+        for (s = 0; s < ARRAY_SIZE(sweep_burst); ++s) {
+            for (f = 0; f < ARRAY_SIZE(sweep_fifo); ++f) {
+                for (p = 0; p < ARRAY_SIZE(sweep_poll_us); ++p) {
+                    uart_stats_t stats;
+
+                    if (run(sweep_baud[b], sweep_burst[s], sweep_fifo[f],
+                            sweep_poll_us[p], &stats) != 0) {
+                        fprintf(stderr, "can not start LPUART1\n");
+                        return 2;
+                    }
+                    failed += report(sweep_baud[b], sweep_burst[s],
+                                     sweep_fifo[f], sweep_poll_us[p], &stats);
+                }
+            }
+        }
+    }
+
+    return failed ? 1 : 0;
+}
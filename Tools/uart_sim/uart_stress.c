@@ -0,0 +1,314 @@
+/**
+ * @file    uart_stress.c
+ * @brief   Stress test of the DMA Rx accounting on the host simulation.
+ * @note    LPUART1 receives by DMA into a small buf, so it wraps often. The
+ *          line bytes, the idle frame, the DMA half/complete flags and DMA
+ *          errors come in random order, and preempt the driver where it
+ *          reads NDTR and where it writes the fifo: the other interrupt runs
+ *          nested in the middle of an update. Interrupts are also masked for
+ *          random periods. USART1 receives by interrupt, the same events
+ *          without DMA.
+ *
+ *          Every byte the consumer reads must be the pattern at its position
+ *          on the line and come after the previous one. Every byte that is
+ *          not read must be counted as dropped, by the fifo or by overrun.
+ *
+ *          Usage: uart_stress [iterations] [seed] [lpuart1|usart1]
+ *          Exit status is 1 on the first mismatch.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ring_fifo/ring_fifo.h"
+#include "sim_hal.h"
+
+#include "CSP_Config.h"
+
+/* Declared by the startup file on the target. */
+void LPUART1_IRQHandler(void);
+void LPUART1_RX_DMA_IRQHandler(void);
+void USART1_IRQHandler(void);
+
+/* Size of the DMA receive buf and of the fifo. */
+#define STRESS_DMA_BUF   64U
+#define STRESS_FIFO      128U
+
+/* Bytes sent at a time. */
+#define STRESS_MAX_BURST (STRESS_DMA_BUF / 4U)
+
+/* Nesting of the injected events. */
+#define STRESS_MAX_DEPTH 2U
+
+/* Line index of each byte in the fifo, in fifo order. */
+static uint32_t queue[STRESS_FIFO];
+static uint32_t queue_head, queue_tail;
+
+static uint32_t sent, pushed;
+static uint64_t received, fifo_drops;
+static uint32_t last_index;
+static uint32_t depth;
+static uint32_t rng_state;
+/* The port under test. */
+static UART_HandleTypeDef *huart;
+
+/**
+ * @brief xorshift32, the same sequence on every host.
+ *
+ * @param n The range.
+ * @return Random number in [0, n).
+ */
+static uint32_t rng(uint32_t n) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state % n;
+}
+
+/**
+ * @brief The pattern on the line.
+ *
+ * @param index The line index of the byte.
+ * @return The byte.
+ */
+static inline uint8_t pattern(uint32_t index) {
+    return (uint8_t)(index * 7U + (index >> 8));
+}
+
+/**
+ * @brief Stop on a mismatch.
+ *
+ * @param what What is wrong.
+ * @param index The line index of the byte.
+ */
+static void fail(const char *what, uint32_t index) {
+    printf("FAIL: %s, byte %u, sent %u, read %llu\n", what, index, sent,
+           (unsigned long long)received);
+    exit(1);
+}
+
+static void inject(void);
+
+/**
+ * @brief Follow the bytes the driver writes to the fifo.
+ *
+ */
+static void fifo_write_hook(ring_fifo_t *rf, const void *data,
+                            uint32_t written, size_t len) {
+    const uint8_t *buf = huart->pRxBuffPtr;
+    uint32_t pos = (uint32_t)((const uint8_t *)data - buf);
+    uint32_t i;
+
+    (void)rf;
+    if (huart->hdmarx == NULL) {
+        /* Interrupt Rx, the bytes are read from RDR in line order. */
+        for (i = 0; i < len; ++i) {
+            uint32_t tag = sim_rx_read_tag();
+            if (i < written) {
+                queue[queue_head++ % STRESS_FIFO] = tag;
+            }
+        }
+    } else {
+        if (((const uint8_t *)data < buf) ||
+            (pos + len > huart->RxXferSize)) {
+            fail("written from outside the DMA buf", sent);
+        }
+
+        for (i = 0; i < written; ++i) {
+            queue[queue_head++ % STRESS_FIFO] = sim_rx_tag(pos + i);
+        }
+    }
+    fifo_drops += len - written;
+    pushed += (uint32_t)len;
+
+    if ((sim_primask == 0) && (rng(4) == 0)) {
+        /* Preempt the driver between two chunks. */
+        inject();
+    }
+}
+
+/**
+ * @brief Send bytes on the line.
+ *
+ * @param len The number of bytes.
+ */
+static void send(uint32_t len) {
+    while (len-- != 0) {
+        if (sent - pushed - (uint32_t)sim_counter.overruns >=
+            STRESS_DMA_BUF - 1U) {
+            /* DMA would lap the data that is not handed over. */
+            break;
+        }
+
+        /* Counted first, the interrupts it raises may send too. */
+        uint32_t index = sent++;
+        sim_rx_byte(pattern(index), index);
+    }
+}
+
+/**
+ * @brief A random event, also run where the driver reads NDTR.
+ *
+ */
+static void inject(void) {
+    if (depth >= STRESS_MAX_DEPTH) {
+        return;
+    }
+
+    ++depth;
+    switch (rng(16)) {
+        case 0:
+        case 1:
+        case 2:
+        case 3:
+        case 4: {
+            send(1U + rng(STRESS_MAX_BURST));
+        } break;
+
+        case 5:
+        case 6: {
+            sim_rx_idle();
+        } break;
+
+        case 7: {
+            /* Late or spurious interrupt. */
+            sim_irq_uart();
+        } break;
+
+        case 8: {
+            sim_irq_dma();
+        } break;
+
+        case 9: {
+            if (rng(32) == 0) {
+                sim_dma_error();
+            }
+        } break;
+
+        default: {
+        } break;
+    }
+    --depth;
+}
+
+/**
+ * @brief The driver reads NDTR, preempt it half of the time.
+ *
+ */
+static void counter_hook(void) {
+    if (rng(2) == 0) {
+        inject();
+    }
+}
+
+/**
+ * @brief Read and check all that is in the fifo.
+ *
+ */
+static void consume(void) {
+    uint8_t buf[64];
+    uint32_t len, i;
+
+    while ((len = uart_dmarx_read(huart, buf, sizeof(buf))) != 0) {
+        for (i = 0; i < len; ++i) {
+            uint32_t index = queue[queue_tail++ % STRESS_FIFO];
+
+            if (buf[i] != pattern(index)) {
+                fail("corrupt", index);
+            }
+            if ((received != 0) && (index <= last_index)) {
+                fail("out of order", index);
+            }
+            last_index = index;
+            ++received;
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    sim_port_t port = {
+        .huart = &lpuart1_handle,
+        .uart_irq = LPUART1_IRQHandler,
+        .dma_rx_irq = LPUART1_RX_DMA_IRQHandler,
+    };
+    uint8_t (*port_init)(uint32_t baud) = lpuart1_init;
+    uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0)
+                                     : 1000000U;
+    uart_stats_t stats;
+    uint32_t i;
+
+    if ((argc > 3) && (strcmp(argv[3], "usart1") == 0)) {
+        port.huart = &usart1_handle;
+        port.uart_irq = USART1_IRQHandler;
+        port.dma_rx_irq = NULL;
+        port_init = usart1_init;
+    } else if ((argc > 3) && (strcmp(argv[3], "lpuart1") != 0)) {
+        fprintf(stderr, "unknown port %s\n", argv[3]);
+        return 2;
+    }
+    huart = port.huart;
+
+    rng_state = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 1U;
+    if (rng_state == 0) {
+        rng_state = 1;
+    }
+
+    sim_init();
+    ring_fifo_write_hook = fifo_write_hook;
+    if ((uart_dmarx_resize_fifo(huart, STRESS_DMA_BUF, STRESS_FIFO) != 0) ||
+        (port_init(921600) != 0)) {
+        fprintf(stderr, "can not start the port\n");
+        return 2;
+    }
+    sim_attach(&port);
+    uart_reset_stats(huart);
+    sim_counter_hook = counter_hook;
+
+    for (i = 0; i < iterations; ++i) {
+        switch (rng(8)) {
+            case 0: {
+                /* Critical section of the application. */
+                __set_PRIMASK(1);
+                inject();
+                __set_PRIMASK(0);
+            } break;
+
+            case 1:
+            case 2: {
+                consume();
+            } break;
+
+            default: {
+                inject();
+            } break;
+        }
+    }
+
+    /* Flush the rest. */
+    sim_counter_hook = NULL;
+    sim_rx_idle();
+    consume();
+
+    uart_get_stats(huart, &stats);
+    printf("sent %u, read %llu, dropped by fifo %llu, by overrun %llu\n",
+           sent, (unsigned long long)received,
+           (unsigned long long)fifo_drops,
+           (unsigned long long)sim_counter.overruns);
+    printf("irqs: uart %llu, dma %llu; events: idle %u, half %u, done %u, "
+           "dma errors %u, restarts %u\n",
+           (unsigned long long)sim_counter.uart_irqs,
+           (unsigned long long)sim_counter.dma_irqs, stats.idle_events,
+           stats.half_events, stats.done_events, stats.dma_errors,
+           stats.dma_restarts);
+
+    if (received + fifo_drops + sim_counter.overruns != sent) {
+        fail("lost without count", sent);
+    }
+    if (stats.rx_bytes + sim_counter.overruns != sent) {
+        fail("rx_bytes of stats", sent);
+    }
+
+    printf("PASS\n");
+    return 0;
+}
@@ -12,6 +12,7 @@
 #include "UART_STM32G4xx.h"
 
 #include "./ring_fifo/ring_fifo.h"
+#include <errno.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -20,19 +21,64 @@
  * @{
  */
 
-/* The buf of `uart_pirntf` and `uart_scanf`. */
-static char uart_buffer[256];
+/**
+ * @brief Caller-owned buffer queued for transmit.
+ */
+typedef struct {
+    const uint8_t *data;        /*!< Data to send.               */
+    size_t len;                 /*!< Length of data.             */
+    uart_tx_cplt_cb_t callback; /*!< Called when it is sent.     */
+    void *arg;                  /*!< Argument of `callback`.     */
+} uart_tx_desc_t;
 
 /**
  * @brief Send buf of UART.
+ * @note The buf is split into two banks, the application writes to the
+ *       filling bank while DMA is transferring the other one. The queued
+ *       descriptors are transferred from the caller's buffer directly.
  */
 typedef struct {
-    uint8_t *send_buf; /*!< Send data buf.                                  */
-    uint32_t head_ptr; /*!< Pointer of send buf to control the length of DMA
-                            transfer.                                       */
-    size_t buf_size;   /*!< The size of buffer. Prevent overflow.           */
+    uint8_t *send_buf;      /*!< Send data buf, two banks.                  */
+    __IO uint32_t head_ptr; /*!< Pointer of filling bank to control the
+                                 length of DMA transfer.                    */
+    size_t buf_size;        /*!< The size of each bank. Prevent overflow.   */
+    uint8_t fill_bank;      /*!< The bank which is being written.           */
+    uint8_t locked;         /*!< The filling bank is being written.         */
+    uint8_t deferred;       /*!< Transfer is deferred because of `locked`.  */
+    __IO uint8_t busy;      /*!< DMA is transferring.                       */
+    uint8_t xfer_desc;      /*!< The transfer is from the descriptor queue. */
+    uint16_t xfer_len;      /*!< The length of the transfer.                */
+
+    uart_tx_desc_t queue[UART_TX_DMA_QUEUE_SIZE]; /*!< Descriptor queue.    */
+    uint8_t queue_head;     /*!< The descriptor which is transferring.      */
+    uint8_t queue_count;    /*!< The number of queued descriptors.          */
+    size_t queue_sent;      /*!< Sent length of the head descriptor.        */
 } uart_tx_buf_t;
 
+/**
+ * @brief Frame decoder of receive path.
+ */
+typedef struct {
+    uint8_t mode;                /*!< `UART_FRAME_xxx`.                   */
+    uint8_t escape;              /*!< SLIP: the last byte is ESC.         */
+    uint8_t code;                /*!< COBS: remain bytes of the block.    */
+    uint8_t zero;                /*!< COBS: a zero is before next block.  */
+    uint8_t overflow;            /*!< The frame is longer than `size`.    */
+    uint8_t *buf;                /*!< Decoded frame.                      */
+    uint32_t size;               /*!< Size of `buf`.                      */
+    uint32_t len;                /*!< Length of decoded frame.            */
+    uart_rx_frame_cb_t callback; /*!< Called when a frame is complete.    */
+    void *arg;                   /*!< Argument of `callback`.             */
+} uart_rx_frame_t;
+
+/**
+ * @brief Timestamp of a received chunk.
+ */
+typedef struct {
+    uint32_t end_cnt;   /*!< Byte count at the end of chunk. */
+    uint32_t timestamp; /*!< Time of the Rx event.           */
+} uart_rx_ts_t;
+
 /**
  * @brief Receive fifo of UART.
  */
@@ -40,10 +86,35 @@ typedef struct {
     ring_fifo_t *rx_fifo; /*!< Receive fifo.                 */
     uint8_t *rx_fifo_buf; /*!< The storage area of fifo.     */
     uint8_t *recv_buf;    /*!< Data buf of DMA to transfer.  */
-    uint32_t head_ptr;    /*!< Pointer of receive buf to
-                               control the DMA receive.      */
+    uint32_t head_ptr;    /*!< Offset of receive buf that has
+                               been handed over.             */
+    __IO uint32_t update_req; /*!< Requests of update, the
+                                   first one does them.      */
+    __IO uint8_t restart_req; /*!< DMA Rx is aborted, the owner
+                                   of update restarts it.    */
+    uint32_t read_ptr;    /*!< Read pointer of `recv_buf` in
+                               zero-copy mode.               */
+    uint32_t recv_cnt;    /*!< Total bytes received by DMA.  */
+    uint32_t read_cnt;    /*!< Total bytes read out.         */
+    uint32_t drop_cnt;    /*!< Total bytes dropped by fifo.  */
     uint32_t buf_size;    /*!< Size of `rece_buf`.           */
     uint32_t fifo_size;   /*!< Size of `rx_fifo_buf`.        */
+    uint8_t zero_copy;    /*!< Read from `recv_buf` directly,
+                               `rx_fifo` is not used.        */
+    uart_rx_frame_t frame; /*!< Frame decoder, the bytes are
+                                not written to `rx_fifo`
+                                when it is enabled.          */
+    UART_HandleTypeDef *bridge; /*!< Forward the received data to
+                                     DMA Tx of this UART.    */
+    uint8_t bridge_flow;  /*!< Pause DMA Rx when the bridge
+                               falls behind.                 */
+    uint8_t bridge_pause; /*!< DMA Rx is paused.             */
+#if UART_RX_TIMESTAMP
+    uart_rx_ts_t ts[UART_RX_TIMESTAMP_DEPTH]; /*!< Timestamps of the
+                                                   unread chunks. */
+    uint8_t ts_head;      /*!< The oldest timestamp.         */
+    uint8_t ts_count;     /*!< The number of timestamps.     */
+#endif /* UART_RX_TIMESTAMP */
 } uart_rx_fifo_t;
 
 /**
@@ -58,6 +129,253 @@ typedef struct {
 static void uart_dmarx_halfdone_callback(UART_HandleTypeDef *huart);
 static void uart_dmarx_done_callback(UART_HandleTypeDef *huart);
 void uart_dmarx_idle_callback(UART_HandleTypeDef *huart);
+void uart_dmarx_match_callback(UART_HandleTypeDef *huart);
+void uart_rx_timeout_callback(UART_HandleTypeDef *huart);
+static uint32_t uart_modbus_rto(uint32_t baud_rate);
+void uart_rx_irq_handler(UART_HandleTypeDef *huart);
+void uart_dmarx_error_handler(UART_HandleTypeDef *huart);
+static inline uart_rx_fifo_t *uart_rx_identify(UART_HandleTypeDef *huart);
+static void uart_bridge_forward(UART_HandleTypeDef *huart,
+                                uart_rx_fifo_t *uart_rx_fifo,
+                                const uint8_t *data, uint32_t len);
+#if UART_BAUD_PLANNER
+static uint8_t uart_baud_setup(UART_HandleTypeDef *huart, uint32_t baud_rate);
+#endif /* UART_BAUD_PLANNER */
+static void uart_dmatx_done_callback(UART_HandleTypeDef *huart);
+static uint32_t uart_dmatx_kick(UART_HandleTypeDef *huart,
+                                uart_tx_buf_t *send_tx_buf);
+static int uart_dmatx_vprintf(UART_HandleTypeDef *huart, const char *__format,
+                              va_list ap);
+
+#if UART_STATS_ENABLE
+
+static uart_stats_t *uart_stats_identify(UART_HandleTypeDef *huart);
+
+#define UART_STATS_ADD(huart, member, n)                                       \
+    do {                                                                       \
+        uart_stats_t *uart_stats = uart_stats_identify(huart);                 \
+        if (uart_stats != NULL) {                                              \
+            uart_stats->member += (n);                                         \
+        }                                                                      \
+    } while (0)
+
+#else /* UART_STATS_ENABLE */
+
+#define UART_STATS_ADD(huart, member, n) ((void)0)
+
+#endif /* UART_STATS_ENABLE */
+
+/**
+ * @brief Disable the interrupts and save the state.
+ *
+ * @return The state of PRIMASK before disable.
+ */
+static inline uint32_t uart_critical_enter(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+/**
+ * @brief Restore the interrupts state.
+ *
+ * @param primask The state of PRIMASK returned by `uart_critical_enter`.
+ */
+static inline void uart_critical_exit(uint32_t primask) {
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Add to a counter atomically (LDREX/STREX), without disabling the
+ *        interrupts.
+ *
+ * @param ptr The counter.
+ * @param value The value to add.
+ * @return The new value of counter.
+ */
+static inline uint32_t uart_atomic_add(__IO uint32_t *ptr, int32_t value) {
+    uint32_t res;
+
+    do {
+        res = __LDREXW(ptr) + (uint32_t)value;
+    } while (__STREXW(res, ptr) != 0U);
+
+    return res;
+}
+
+#if UART_TIMESTAMP_DWT_INIT && (UART_LOG_ENABLE || UART_RX_TIMESTAMP)
+
+/**
+ * @brief Start the DWT cycle counter, the default timestamp source.
+ *
+ * @note Without a debugger attached it is stopped after reset.
+ */
+static inline void uart_timestamp_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+#endif /* UART_TIMESTAMP_DWT_INIT && (UART_LOG_ENABLE || UART_RX_TIMESTAMP) */
+
+/**
+ * @brief Suspend the receiver before transmit on RS-485 or single-wire bus.
+ *
+ * @param huart The handle of UART.
+ */
+static inline void uart_bus_rx_suspend(UART_HandleTypeDef *huart) {
+    if (READ_BIT(huart->Instance->CR3, USART_CR3_DEM | USART_CR3_HDSEL)) {
+        CLEAR_BIT(huart->Instance->CR1, USART_CR1_RE);
+    }
+}
+
+/**
+ * @brief Resume the receiver after transmit on RS-485 or single-wire bus.
+ *
+ * @param huart The handle of UART.
+ * @note The echo of our own transmit is flushed. DMA Rx is never stopped,
+ *       it continues to fill the ring as soon as the receiver is enabled.
+ */
+static inline void uart_bus_rx_resume(UART_HandleTypeDef *huart) {
+    if (READ_BIT(huart->Instance->CR3, USART_CR3_DEM | USART_CR3_HDSEL)) {
+        __HAL_UART_SEND_REQ(huart, UART_RXDATA_FLUSH_REQUEST);
+        SET_BIT(huart->Instance->CR1, USART_CR1_RE);
+    }
+}
+
+#if UART_STATIC_BUFFER
+#define UART_RX_BUF_ATTR                                                       \
+    __attribute__((section(UART_RX_BUF_SECTION), aligned(4)))
+#define UART_TX_BUF_ATTR                                                       \
+    __attribute__((section(UART_TX_BUF_SECTION), aligned(4)))
+#endif /* UART_STATIC_BUFFER */
+
+/**
+ * @brief Release the receive buf and fifo of UART.
+ *
+ * @param uart_rx_fifo The receive fifo of UART.
+ * @note The static buffers are kept.
+ */
+static void uart_rx_fifo_free(uart_rx_fifo_t *uart_rx_fifo) {
+    if (uart_rx_fifo->rx_fifo != NULL) {
+        ring_fifo_destroy(uart_rx_fifo->rx_fifo);
+        uart_rx_fifo->rx_fifo = NULL;
+    }
+
+#if !UART_STATIC_BUFFER
+    CSP_FREE(uart_rx_fifo->recv_buf);
+    CSP_FREE(uart_rx_fifo->rx_fifo_buf);
+    uart_rx_fifo->recv_buf = NULL;
+    uart_rx_fifo->rx_fifo_buf = NULL;
+#endif /* !UART_STATIC_BUFFER */
+}
+
+/**
+ * @brief Allocate the receive buf and fifo of UART.
+ *
+ * @param uart_rx_fifo The receive fifo of UART.
+ * @param dma Allocate the receive buf of DMA.
+ * @return Allocate message:
+ *  @retval - 0: Success.
+ *  @retval - 1: Allocate failed, nothing is kept.
+ * @note With `UART_STATIC_BUFFER` the buffers are assigned statically,
+ *       only the fifo is initialized.
+ */
+static uint8_t uart_rx_fifo_alloc(uart_rx_fifo_t *uart_rx_fifo, uint8_t dma) {
+    uart_rx_fifo->head_ptr = 0;
+    uart_rx_fifo->read_ptr = 0;
+    uart_rx_fifo->recv_cnt = 0;
+    uart_rx_fifo->read_cnt = 0;
+    uart_rx_fifo->drop_cnt = 0;
+    uart_rx_fifo->rx_fifo = NULL;
+#if UART_RX_TIMESTAMP
+    uart_rx_fifo->ts_head = 0;
+    uart_rx_fifo->ts_count = 0;
+#if UART_TIMESTAMP_DWT_INIT
+    uart_timestamp_init();
+#endif /* UART_TIMESTAMP_DWT_INIT */
+#endif /* UART_RX_TIMESTAMP */
+
+#if !UART_STATIC_BUFFER
+    uart_rx_fifo->recv_buf = NULL;
+    uart_rx_fifo->rx_fifo_buf = NULL;
+
+    if (dma) {
+        uart_rx_fifo->recv_buf = CSP_MALLOC(uart_rx_fifo->buf_size);
+        if (uart_rx_fifo->recv_buf == NULL) {
+            return 1;
+        }
+    }
+
+    if (!uart_rx_fifo->zero_copy) {
+        uart_rx_fifo->rx_fifo_buf = CSP_MALLOC(uart_rx_fifo->fifo_size);
+        if (uart_rx_fifo->rx_fifo_buf == NULL) {
+            uart_rx_fifo_free(uart_rx_fifo);
+            return 1;
+        }
+    }
+#else  /* !UART_STATIC_BUFFER */
+    (void)dma;
+#endif /* !UART_STATIC_BUFFER */
+
+    if (!uart_rx_fifo->zero_copy) {
+        uart_rx_fifo->rx_fifo = ring_fifo_init(
+            uart_rx_fifo->rx_fifo_buf, uart_rx_fifo->fifo_size, RF_TYPE_STREAM);
+        if (uart_rx_fifo->rx_fifo == NULL) {
+            uart_rx_fifo_free(uart_rx_fifo);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Release the send buf of UART.
+ *
+ * @param send_tx_buf The send buf of UART.
+ * @note The static buffer is kept.
+ */
+static inline void uart_tx_buf_free(uart_tx_buf_t *send_tx_buf) {
+#if !UART_STATIC_BUFFER
+    CSP_FREE(send_tx_buf->send_buf);
+    send_tx_buf->send_buf = NULL;
+#else  /* !UART_STATIC_BUFFER */
+    (void)send_tx_buf;
+#endif /* !UART_STATIC_BUFFER */
+}
+
+/**
+ * @brief Allocate the send buf of UART.
+ *
+ * @param send_tx_buf The send buf of UART.
+ * @return Allocate message:
+ *  @retval - 0: Success.
+ *  @retval - 1: Allocate failed.
+ */
+static inline uint8_t uart_tx_buf_alloc(uart_tx_buf_t *send_tx_buf) {
+    send_tx_buf->head_ptr = 0;
+    send_tx_buf->fill_bank = 0;
+    send_tx_buf->locked = 0;
+    send_tx_buf->deferred = 0;
+    send_tx_buf->busy = 0;
+    send_tx_buf->queue_head = 0;
+    send_tx_buf->queue_count = 0;
+    send_tx_buf->queue_sent = 0;
+
+#if UART_LOG_ENABLE && UART_TIMESTAMP_DWT_INIT
+    /* `uart_log` sends by DMA Tx. */
+    uart_timestamp_init();
+#endif /* UART_LOG_ENABLE && UART_TIMESTAMP_DWT_INIT */
+
+#if !UART_STATIC_BUFFER
+    send_tx_buf->send_buf = CSP_MALLOC(send_tx_buf->buf_size * 2);
+    if (send_tx_buf->send_buf == NULL) {
+        return 1;
+    }
+#endif /* !UART_STATIC_BUFFER */
+
+    return 0;
+}
 
 /**
  * @}
@@ -75,6 +393,10 @@ UART_HandleTypeDef lpuart1_handle = {.Instance = LPUART1,
                                              .StopBits = UART_STOPBITS_1,
                                              .Parity = UART_PARITY_NONE}};
 
+#if UART_STATS_ENABLE
+static uart_stats_t lpuart1_stats;
+#endif /* UART_STATS_ENABLE */
+
 #if LPUART1_RX_DMA
 
 static DMA_HandleTypeDef lpuart1_dmarx_handle = {
@@ -88,11 +410,39 @@ static DMA_HandleTypeDef lpuart1_dmarx_handle = {
              .PeriphInc = DMA_PINC_DISABLE,
              .Priority = LPUART1_RX_DMA_PRIORITY}};
 
-static uart_rx_fifo_t lpuart1_rx_fifo = {.buf_size = LPUART1_RX_DMA_BUF_SIZE,
-                                        .fifo_size = LPUART1_RX_DMA_FIFO_SIZE};
+#if UART_STATIC_BUFFER
+static uint8_t lpuart1_recv_buf[LPUART1_RX_DMA_BUF_SIZE] UART_RX_BUF_ATTR;
+#if !LPUART1_RX_DMA_ZERO_COPY
+static uint8_t lpuart1_rx_fifo_buf[LPUART1_RX_DMA_FIFO_SIZE] UART_RX_BUF_ATTR;
+#else  /* !LPUART1_RX_DMA_ZERO_COPY */
+#define lpuart1_rx_fifo_buf NULL
+#endif /* !LPUART1_RX_DMA_ZERO_COPY */
+#else  /* UART_STATIC_BUFFER */
+#define lpuart1_recv_buf    NULL
+#define lpuart1_rx_fifo_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_rx_fifo_t lpuart1_rx_fifo = {.recv_buf = lpuart1_recv_buf,
+                                        .rx_fifo_buf = lpuart1_rx_fifo_buf,
+                                        .buf_size = LPUART1_RX_DMA_BUF_SIZE,
+                                        .fifo_size = LPUART1_RX_DMA_FIFO_SIZE,
+                                        .zero_copy = LPUART1_RX_DMA_ZERO_COPY};
 
 #endif /* LPUART1_RX_DMA */
 
+#if LPUART1_RX_IT
+
+#if UART_STATIC_BUFFER
+static uint8_t lpuart1_rx_fifo_buf[LPUART1_RX_IT_FIFO_SIZE] UART_RX_BUF_ATTR;
+#else  /* UART_STATIC_BUFFER */
+#define lpuart1_rx_fifo_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_rx_fifo_t lpuart1_rx_fifo = {.rx_fifo_buf = lpuart1_rx_fifo_buf,
+                                        .fifo_size = LPUART1_RX_IT_FIFO_SIZE};
+
+#endif /* LPUART1_RX_IT */
+
 #if LPUART1_TX_DMA
 
 static DMA_HandleTypeDef lpuart1_dmatx_handle = {
@@ -106,9 +456,30 @@ static DMA_HandleTypeDef lpuart1_dmatx_handle = {
              .PeriphInc = DMA_PINC_DISABLE,
              .Priority = LPUART1_TX_DMA_PRIORITY}};
 
-static uart_tx_buf_t lpuart1_tx_buf = {.buf_size = LPUART1_TX_DMA_BUF_SIZE};
+#if UART_STATIC_BUFFER
+static uint8_t lpuart1_send_buf[LPUART1_TX_DMA_BUF_SIZE * 2] UART_TX_BUF_ATTR;
+#else  /* UART_STATIC_BUFFER */
+#define lpuart1_send_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_tx_buf_t lpuart1_tx_buf = {.send_buf = lpuart1_send_buf,
+                                      .buf_size = LPUART1_TX_DMA_BUF_SIZE};
+
+#endif /* LPUART1_TX_DMA */
+
+/**
+ * @brief Release the buffers of LPUART1.
+ *
+ */
+static void lpuart1_buf_free(void) {
+#if LPUART1_RX_DMA || LPUART1_RX_IT
+    uart_rx_fifo_free(&lpuart1_rx_fifo);
+#endif /* LPUART1_RX_DMA || LPUART1_RX_IT */
 
+#if LPUART1_TX_DMA
+    uart_tx_buf_free(&lpuart1_tx_buf);
 #endif /* LPUART1_TX_DMA */
+}
 
 /**
  * @brief LPUART1 initialization
@@ -131,13 +502,25 @@ uint8_t lpuart1_init(uint32_t baud_rate) {
                                          .Speed = GPIO_SPEED_FREQ_HIGH,
                                          .Mode = GPIO_MODE_AF_PP};
     lpuart1_handle.Init.BaudRate = baud_rate;
+#if UART_BAUD_PLANNER
+    if (uart_baud_setup(&lpuart1_handle, baud_rate) != 0) {
+        return UART_INIT_FAIL;
+    }
+#endif /* UART_BAUD_PLANNER */
+
 #if LPUART1_TX
     lpuart1_handle.Init.Mode |= UART_MODE_TX;
 
     CSP_GPIO_CLK_ENABLE(LPUART1_TX_PORT);
     gpio_init_struct.Pin = LPUART1_TX_PIN;
     gpio_init_struct.Alternate = LPUART1_TX_GPIO_AF;
+#if (LPUART1_BUS_MODE == 2)
+    /* Single-wire, receive on TX pin. */
+    lpuart1_handle.Init.Mode |= UART_MODE_RX;
+    gpio_init_struct.Mode = GPIO_MODE_AF_OD;
+#endif /* LPUART1_BUS_MODE */
     HAL_GPIO_Init(CSP_GPIO_PORT(LPUART1_TX_PORT), &gpio_init_struct);
+    gpio_init_struct.Mode = GPIO_MODE_AF_PP;
 #endif /* LPUART1_TX */
 
 #if LPUART1_RX
@@ -159,7 +542,10 @@ uint8_t lpuart1_init(uint32_t baud_rate) {
 #endif /* LPUART1_LPUART1_CTS */
 
 #if LPUART1_RTS
+#if (LPUART1_BUS_MODE != 1)
+    /* RTS pin is DE in RS-485 mode. */
     lpuart1_handle.Init.HwFlowCtl |= UART_HWCONTROL_RTS;
+#endif /* LPUART1_BUS_MODE */
 
     CSP_GPIO_CLK_ENABLE(LPUART1_RTS_PORT);
     gpio_init_struct.Pin = LPUART1_RTS_PIN;
@@ -174,26 +560,13 @@ uint8_t lpuart1_init(uint32_t baud_rate) {
 #endif /* LPUART1_IT_ENABLE */
 
 #if LPUART1_RX_DMA
-    lpuart1_rx_fifo.head_ptr = 0;
-
-    lpuart1_rx_fifo.recv_buf = CSP_MALLOC(lpuart1_rx_fifo.buf_size);
-    if (lpuart1_rx_fifo.recv_buf == NULL) {
-        return UART_INIT_MEM_FAIL;
-    }
-
-    lpuart1_rx_fifo.rx_fifo_buf = CSP_MALLOC(lpuart1_rx_fifo.fifo_size);
-    if (lpuart1_rx_fifo.rx_fifo_buf == NULL) {
-        return UART_INIT_MEM_FAIL;
-    }
-
-    lpuart1_rx_fifo.rx_fifo = ring_fifo_init(
-        lpuart1_rx_fifo.rx_fifo_buf, lpuart1_rx_fifo.fifo_size, RF_TYPE_STREAM);
-    if (lpuart1_rx_fifo.rx_fifo == NULL) {
+    if (uart_rx_fifo_alloc(&lpuart1_rx_fifo, 1) != 0) {
         return UART_INIT_MEM_FAIL;
     }
 
     CSP_DMA_CLK_ENABLE(LPUART1_RX_DMA_NUMBER);
     if (HAL_DMA_Init(&lpuart1_dmarx_handle) != HAL_OK) {
+        lpuart1_buf_free();
         return UART_INIT_DMA_FAIL;
     }
 
@@ -205,14 +578,21 @@ uint8_t lpuart1_init(uint32_t baud_rate) {
 
 #endif /* LPUART1_RX_DMA */
 
+#if LPUART1_RX_IT
+    if (uart_rx_fifo_alloc(&lpuart1_rx_fifo, 0) != 0) {
+        return UART_INIT_MEM_FAIL;
+    }
+#endif /* LPUART1_RX_IT */
+
 #if LPUART1_TX_DMA
-    lpuart1_tx_buf.send_buf = CSP_MALLOC(lpuart1_tx_buf.buf_size);
-    if (lpuart1_tx_buf.send_buf == NULL) {
+    if (uart_tx_buf_alloc(&lpuart1_tx_buf) != 0) {
+        lpuart1_buf_free();
         return UART_INIT_MEM_FAIL;
     }
 
     CSP_DMA_CLK_ENABLE(LPUART1_TX_DMA_NUMBER);
     if (HAL_DMA_Init(&lpuart1_dmatx_handle) != HAL_OK) {
+        lpuart1_buf_free();
         return UART_INIT_DMA_FAIL;
     }
 
@@ -223,11 +603,44 @@ uint8_t lpuart1_init(uint32_t baud_rate) {
     HAL_NVIC_EnableIRQ(LPUART1_TX_DMA_IRQn);
 #endif /* LPUART1_TX_DMA */
 
+#if (LPUART1_BUS_MODE == 1)
+    if (HAL_RS485Ex_Init(&lpuart1_handle, UART_DE_POLARITY_HIGH,
+                         LPUART1_DE_ASSERT_TIME,
+                         LPUART1_DE_DEASSERT_TIME) != HAL_OK) {
+        lpuart1_buf_free();
+        return UART_INIT_FAIL;
+    }
+#elif (LPUART1_BUS_MODE == 2)
+    if (HAL_HalfDuplex_Init(&lpuart1_handle) != HAL_OK) {
+        lpuart1_buf_free();
+        return UART_INIT_FAIL;
+    }
+#else  /* LPUART1_BUS_MODE */
     if (HAL_UART_Init(&lpuart1_handle) != HAL_OK) {
+        lpuart1_buf_free();
         return UART_INIT_FAIL;
     }
+#endif /* LPUART1_BUS_MODE */
     
+#if LPUART1_FIFO_ENABLE
+    HAL_UARTEx_SetTxFifoThreshold(&lpuart1_handle, LPUART1_TX_FIFO_THRESHOLD);
+    HAL_UARTEx_SetRxFifoThreshold(&lpuart1_handle, LPUART1_RX_FIFO_THRESHOLD);
+    HAL_UARTEx_EnableFifoMode(&lpuart1_handle);
+#else  /* LPUART1_FIFO_ENABLE */
     HAL_UARTEx_DisableFifoMode(&lpuart1_handle);
+#endif /* LPUART1_FIFO_ENABLE */
+
+#if LPUART1_MUTE_MODE
+    if (uart_mute_config(&lpuart1_handle, LPUART1_MUTE_WAKEUP,
+                         LPUART1_MUTE_ADDR_7BIT, LPUART1_MUTE_ADDRESS) != 0) {
+        lpuart1_buf_free();
+        return UART_INIT_FAIL;
+    }
+#endif /* LPUART1_MUTE_MODE */
+
+#if LPUART1_CHAR_MATCH
+    uart_set_match_char(&lpuart1_handle, LPUART1_MATCH_CHAR);
+#endif /* LPUART1_CHAR_MATCH */
     
 #if LPUART1_RX_DMA
     __HAL_UART_ENABLE_IT(&lpuart1_handle, UART_IT_IDLE);
@@ -243,6 +656,27 @@ uint8_t lpuart1_init(uint32_t baud_rate) {
                               uart_dmarx_done_callback);
 #endif /* USE_HAL_UART_REGISTER_CALLBACKS */
 #endif /* LPUART1_RX_DMA */
+
+#if LPUART1_RX_IT
+#if LPUART1_FIFO_ENABLE
+    /* Drain a threshold level per interrupt, the rest at line idle. */
+    __HAL_UART_CLEAR_IDLEFLAG(&lpuart1_handle);
+    __HAL_UART_ENABLE_IT(&lpuart1_handle, UART_IT_IDLE);
+    __HAL_UART_ENABLE_IT(&lpuart1_handle, UART_IT_RXFT);
+#else  /* LPUART1_FIFO_ENABLE */
+    __HAL_UART_ENABLE_IT(&lpuart1_handle, UART_IT_RXNE);
+#endif /* LPUART1_FIFO_ENABLE */
+    __HAL_UART_ENABLE_IT(&lpuart1_handle, UART_IT_ERR);
+#endif /* LPUART1_RX_IT */
+
+#if LPUART1_TX_DMA && USE_HAL_UART_REGISTER_CALLBACKS
+    HAL_UART_RegisterCallback(&lpuart1_handle, HAL_UART_TX_COMPLETE_CB_ID,
+                              uart_dmatx_done_callback);
+#endif /* LPUART1_TX_DMA && USE_HAL_UART_REGISTER_CALLBACKS */
+
+#if LPUART1_STDIO
+    uart_stdio_init();
+#endif /* LPUART1_STDIO */
     return UART_INIT_OK;
 }
 
@@ -253,6 +687,26 @@ uint8_t lpuart1_init(uint32_t baud_rate) {
  *
  */
 void LPUART1_IRQHandler(void) {
+#if LPUART1_RX_IT
+    uart_rx_irq_handler(&lpuart1_handle);
+#endif /* LPUART1_RX_IT */
+
+#if LPUART1_RX_DMA
+    uart_dmarx_error_handler(&lpuart1_handle);
+#endif /* LPUART1_RX_DMA */
+
+    if (__HAL_UART_GET_FLAG(&lpuart1_handle, UART_FLAG_RTOF)) {
+        /* Handle before HAL, which takes it as an error. */
+        __HAL_UART_CLEAR_FLAG(&lpuart1_handle, UART_CLEAR_RTOF);
+        uart_rx_timeout_callback(&lpuart1_handle);
+    }
+
+    if (__HAL_UART_GET_FLAG(&lpuart1_handle, UART_FLAG_CMF)) {
+        /* Also set by `uart_set_match_char()` at run time. */
+        __HAL_UART_CLEAR_FLAG(&lpuart1_handle, UART_CLEAR_CMF);
+        uart_dmarx_match_callback(&lpuart1_handle);
+    }
+
     if (__HAL_UART_GET_FLAG(&lpuart1_handle, UART_FLAG_IDLE)) {
         __HAL_UART_CLEAR_IDLEFLAG(&lpuart1_handle);
         uart_dmarx_idle_callback(&lpuart1_handle);
@@ -326,9 +780,7 @@ uint8_t lpuart1_deinit(void) {
 #if LPUART1_RX_DMA
 
     HAL_DMA_Abort(&lpuart1_dmarx_handle);
-    CSP_FREE(lpuart1_rx_fifo.recv_buf);
-    CSP_FREE(lpuart1_rx_fifo.rx_fifo_buf);
-    ring_fifo_destroy(lpuart1_rx_fifo.rx_fifo);
+    uart_rx_fifo_free(&lpuart1_rx_fifo);
 
     if (HAL_DMA_DeInit(&lpuart1_dmarx_handle) != HAL_OK) {
         return UART_DEINIT_DMA_FAIL;
@@ -344,9 +796,13 @@ uint8_t lpuart1_deinit(void) {
 
 #endif /* LPUART1_RX_DMA */
 
+#if LPUART1_RX_IT
+    uart_rx_fifo_free(&lpuart1_rx_fifo);
+#endif /* LPUART1_RX_IT */
+
 #if LPUART1_TX_DMA
     HAL_DMA_Abort(&lpuart1_dmatx_handle);
-    CSP_FREE(lpuart1_tx_buf.send_buf);
+    uart_tx_buf_free(&lpuart1_tx_buf);
 
     if (HAL_DMA_DeInit(&lpuart1_dmatx_handle) != HAL_OK) {
         return UART_DEINIT_DMA_FAIL;
@@ -354,6 +810,9 @@ uint8_t lpuart1_deinit(void) {
 
     HAL_NVIC_DisableIRQ(LPUART1_TX_DMA_IRQn);
 
+#if USE_HAL_UART_REGISTER_CALLBACKS
+    HAL_UART_UnRegisterCallback(&lpuart1_handle, HAL_UART_TX_COMPLETE_CB_ID);
+#endif /* USE_HAL_UART_REGISTER_CALLBACKS */
     lpuart1_handle.hdmatx = NULL;
 #endif /* LPUART1_TX_DMA */
 
@@ -383,6 +842,10 @@ UART_HandleTypeDef usart1_handle = {.Instance = USART1,
                                              .StopBits = UART_STOPBITS_1,
                                              .Parity = UART_PARITY_NONE}};
 
+#if UART_STATS_ENABLE
+static uart_stats_t usart1_stats;
+#endif /* UART_STATS_ENABLE */
+
 #if USART1_RX_DMA
 
 static DMA_HandleTypeDef usart1_dmarx_handle = {
@@ -396,11 +859,39 @@ static DMA_HandleTypeDef usart1_dmarx_handle = {
              .PeriphInc = DMA_PINC_DISABLE,
              .Priority = USART1_RX_DMA_PRIORITY}};
 
-static uart_rx_fifo_t usart1_rx_fifo = {.buf_size = USART1_RX_DMA_BUF_SIZE,
-                                        .fifo_size = USART1_RX_DMA_FIFO_SIZE};
+#if UART_STATIC_BUFFER
+static uint8_t usart1_recv_buf[USART1_RX_DMA_BUF_SIZE] UART_RX_BUF_ATTR;
+#if !USART1_RX_DMA_ZERO_COPY
+static uint8_t usart1_rx_fifo_buf[USART1_RX_DMA_FIFO_SIZE] UART_RX_BUF_ATTR;
+#else  /* !USART1_RX_DMA_ZERO_COPY */
+#define usart1_rx_fifo_buf NULL
+#endif /* !USART1_RX_DMA_ZERO_COPY */
+#else  /* UART_STATIC_BUFFER */
+#define usart1_recv_buf    NULL
+#define usart1_rx_fifo_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_rx_fifo_t usart1_rx_fifo = {.recv_buf = usart1_recv_buf,
+                                        .rx_fifo_buf = usart1_rx_fifo_buf,
+                                        .buf_size = USART1_RX_DMA_BUF_SIZE,
+                                        .fifo_size = USART1_RX_DMA_FIFO_SIZE,
+                                        .zero_copy = USART1_RX_DMA_ZERO_COPY};
 
 #endif /* USART1_RX_DMA */
 
+#if USART1_RX_IT
+
+#if UART_STATIC_BUFFER
+static uint8_t usart1_rx_fifo_buf[USART1_RX_IT_FIFO_SIZE] UART_RX_BUF_ATTR;
+#else  /* UART_STATIC_BUFFER */
+#define usart1_rx_fifo_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_rx_fifo_t usart1_rx_fifo = {.rx_fifo_buf = usart1_rx_fifo_buf,
+                                        .fifo_size = USART1_RX_IT_FIFO_SIZE};
+
+#endif /* USART1_RX_IT */
+
 #if USART1_TX_DMA
 
 static DMA_HandleTypeDef usart1_dmatx_handle = {
@@ -414,9 +905,30 @@ static DMA_HandleTypeDef usart1_dmatx_handle = {
              .PeriphInc = DMA_PINC_DISABLE,
              .Priority = USART1_TX_DMA_PRIORITY}};
 
-static uart_tx_buf_t usart1_tx_buf = {.buf_size = USART1_TX_DMA_BUF_SIZE};
+#if UART_STATIC_BUFFER
+static uint8_t usart1_send_buf[USART1_TX_DMA_BUF_SIZE * 2] UART_TX_BUF_ATTR;
+#else  /* UART_STATIC_BUFFER */
+#define usart1_send_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_tx_buf_t usart1_tx_buf = {.send_buf = usart1_send_buf,
+                                      .buf_size = USART1_TX_DMA_BUF_SIZE};
+
+#endif /* USART1_TX_DMA */
+
+/**
+ * @brief Release the buffers of USART1.
+ *
+ */
+static void usart1_buf_free(void) {
+#if USART1_RX_DMA || USART1_RX_IT
+    uart_rx_fifo_free(&usart1_rx_fifo);
+#endif /* USART1_RX_DMA || USART1_RX_IT */
 
+#if USART1_TX_DMA
+    uart_tx_buf_free(&usart1_tx_buf);
 #endif /* USART1_TX_DMA */
+}
 
 /**
  * @brief USART1 initialization
@@ -439,13 +951,25 @@ uint8_t usart1_init(uint32_t baud_rate) {
                                          .Speed = GPIO_SPEED_FREQ_HIGH,
                                          .Mode = GPIO_MODE_AF_PP};
     usart1_handle.Init.BaudRate = baud_rate;
+#if UART_BAUD_PLANNER
+    if (uart_baud_setup(&usart1_handle, baud_rate) != 0) {
+        return UART_INIT_FAIL;
+    }
+#endif /* UART_BAUD_PLANNER */
+
 #if USART1_TX
     usart1_handle.Init.Mode |= UART_MODE_TX;
 
     CSP_GPIO_CLK_ENABLE(USART1_TX_PORT);
     gpio_init_struct.Pin = USART1_TX_PIN;
     gpio_init_struct.Alternate = USART1_TX_GPIO_AF;
+#if (USART1_BUS_MODE == 2)
+    /* Single-wire, receive on TX pin. */
+    usart1_handle.Init.Mode |= UART_MODE_RX;
+    gpio_init_struct.Mode = GPIO_MODE_AF_OD;
+#endif /* USART1_BUS_MODE */
     HAL_GPIO_Init(CSP_GPIO_PORT(USART1_TX_PORT), &gpio_init_struct);
+    gpio_init_struct.Mode = GPIO_MODE_AF_PP;
 #endif /* USART1_TX */
 
 #if USART1_RX
@@ -467,7 +991,10 @@ uint8_t usart1_init(uint32_t baud_rate) {
 #endif /* USART1_USART1_CTS */
 
 #if USART1_RTS
+#if (USART1_BUS_MODE != 1)
+    /* RTS pin is DE in RS-485 mode. */
     usart1_handle.Init.HwFlowCtl |= UART_HWCONTROL_RTS;
+#endif /* USART1_BUS_MODE */
 
     CSP_GPIO_CLK_ENABLE(USART1_RTS_PORT);
     gpio_init_struct.Pin = USART1_RTS_PIN;
@@ -482,26 +1009,13 @@ uint8_t usart1_init(uint32_t baud_rate) {
 #endif /* USART1_IT_ENABLE */
 
 #if USART1_RX_DMA
-    usart1_rx_fifo.head_ptr = 0;
-
-    usart1_rx_fifo.recv_buf = CSP_MALLOC(usart1_rx_fifo.buf_size);
-    if (usart1_rx_fifo.recv_buf == NULL) {
-        return UART_INIT_MEM_FAIL;
-    }
-
-    usart1_rx_fifo.rx_fifo_buf = CSP_MALLOC(usart1_rx_fifo.fifo_size);
-    if (usart1_rx_fifo.rx_fifo_buf == NULL) {
-        return UART_INIT_MEM_FAIL;
-    }
-
-    usart1_rx_fifo.rx_fifo = ring_fifo_init(
-        usart1_rx_fifo.rx_fifo_buf, usart1_rx_fifo.fifo_size, RF_TYPE_STREAM);
-    if (usart1_rx_fifo.rx_fifo == NULL) {
+    if (uart_rx_fifo_alloc(&usart1_rx_fifo, 1) != 0) {
         return UART_INIT_MEM_FAIL;
     }
 
     CSP_DMA_CLK_ENABLE(USART1_RX_DMA_NUMBER);
     if (HAL_DMA_Init(&usart1_dmarx_handle) != HAL_OK) {
+        usart1_buf_free();
         return UART_INIT_DMA_FAIL;
     }
 
@@ -513,14 +1027,21 @@ uint8_t usart1_init(uint32_t baud_rate) {
 
 #endif /* USART1_RX_DMA */
 
+#if USART1_RX_IT
+    if (uart_rx_fifo_alloc(&usart1_rx_fifo, 0) != 0) {
+        return UART_INIT_MEM_FAIL;
+    }
+#endif /* USART1_RX_IT */
+
 #if USART1_TX_DMA
-    usart1_tx_buf.send_buf = CSP_MALLOC(usart1_tx_buf.buf_size);
-    if (usart1_tx_buf.send_buf == NULL) {
+    if (uart_tx_buf_alloc(&usart1_tx_buf) != 0) {
+        usart1_buf_free();
         return UART_INIT_MEM_FAIL;
     }
 
     CSP_DMA_CLK_ENABLE(USART1_TX_DMA_NUMBER);
     if (HAL_DMA_Init(&usart1_dmatx_handle) != HAL_OK) {
+        usart1_buf_free();
         return UART_INIT_DMA_FAIL;
     }
 
@@ -531,11 +1052,44 @@ uint8_t usart1_init(uint32_t baud_rate) {
     HAL_NVIC_EnableIRQ(USART1_TX_DMA_IRQn);
 #endif /* USART1_TX_DMA */
 
+#if (USART1_BUS_MODE == 1)
+    if (HAL_RS485Ex_Init(&usart1_handle, UART_DE_POLARITY_HIGH,
+                         USART1_DE_ASSERT_TIME,
+                         USART1_DE_DEASSERT_TIME) != HAL_OK) {
+        usart1_buf_free();
+        return UART_INIT_FAIL;
+    }
+#elif (USART1_BUS_MODE == 2)
+    if (HAL_HalfDuplex_Init(&usart1_handle) != HAL_OK) {
+        usart1_buf_free();
+        return UART_INIT_FAIL;
+    }
+#else  /* USART1_BUS_MODE */
     if (HAL_UART_Init(&usart1_handle) != HAL_OK) {
+        usart1_buf_free();
         return UART_INIT_FAIL;
     }
+#endif /* USART1_BUS_MODE */
     
+#if USART1_FIFO_ENABLE
+    HAL_UARTEx_SetTxFifoThreshold(&usart1_handle, USART1_TX_FIFO_THRESHOLD);
+    HAL_UARTEx_SetRxFifoThreshold(&usart1_handle, USART1_RX_FIFO_THRESHOLD);
+    HAL_UARTEx_EnableFifoMode(&usart1_handle);
+#else  /* USART1_FIFO_ENABLE */
     HAL_UARTEx_DisableFifoMode(&usart1_handle);
+#endif /* USART1_FIFO_ENABLE */
+
+#if USART1_MUTE_MODE
+    if (uart_mute_config(&usart1_handle, USART1_MUTE_WAKEUP,
+                         USART1_MUTE_ADDR_7BIT, USART1_MUTE_ADDRESS) != 0) {
+        usart1_buf_free();
+        return UART_INIT_FAIL;
+    }
+#endif /* USART1_MUTE_MODE */
+
+#if USART1_CHAR_MATCH
+    uart_set_match_char(&usart1_handle, USART1_MATCH_CHAR);
+#endif /* USART1_CHAR_MATCH */
     
 #if USART1_RX_DMA
     __HAL_UART_ENABLE_IT(&usart1_handle, UART_IT_IDLE);
@@ -551,6 +1105,27 @@ uint8_t usart1_init(uint32_t baud_rate) {
                               uart_dmarx_done_callback);
 #endif /* USE_HAL_UART_REGISTER_CALLBACKS */
 #endif /* USART1_RX_DMA */
+
+#if USART1_RX_IT
+#if USART1_FIFO_ENABLE
+    /* Drain a threshold level per interrupt, the rest at line idle. */
+    __HAL_UART_CLEAR_IDLEFLAG(&usart1_handle);
+    __HAL_UART_ENABLE_IT(&usart1_handle, UART_IT_IDLE);
+    __HAL_UART_ENABLE_IT(&usart1_handle, UART_IT_RXFT);
+#else  /* USART1_FIFO_ENABLE */
+    __HAL_UART_ENABLE_IT(&usart1_handle, UART_IT_RXNE);
+#endif /* USART1_FIFO_ENABLE */
+    __HAL_UART_ENABLE_IT(&usart1_handle, UART_IT_ERR);
+#endif /* USART1_RX_IT */
+
+#if USART1_TX_DMA && USE_HAL_UART_REGISTER_CALLBACKS
+    HAL_UART_RegisterCallback(&usart1_handle, HAL_UART_TX_COMPLETE_CB_ID,
+                              uart_dmatx_done_callback);
+#endif /* USART1_TX_DMA && USE_HAL_UART_REGISTER_CALLBACKS */
+
+#if USART1_STDIO
+    uart_stdio_init();
+#endif /* USART1_STDIO */
     return UART_INIT_OK;
 }
 
@@ -561,6 +1136,26 @@ uint8_t usart1_init(uint32_t baud_rate) {
  *
  */
 void USART1_IRQHandler(void) {
+#if USART1_RX_IT
+    uart_rx_irq_handler(&usart1_handle);
+#endif /* USART1_RX_IT */
+
+#if USART1_RX_DMA
+    uart_dmarx_error_handler(&usart1_handle);
+#endif /* USART1_RX_DMA */
+
+    if (__HAL_UART_GET_FLAG(&usart1_handle, UART_FLAG_RTOF)) {
+        /* Handle before HAL, which takes it as an error. */
+        __HAL_UART_CLEAR_FLAG(&usart1_handle, UART_CLEAR_RTOF);
+        uart_rx_timeout_callback(&usart1_handle);
+    }
+
+    if (__HAL_UART_GET_FLAG(&usart1_handle, UART_FLAG_CMF)) {
+        /* Also set by `uart_set_match_char()` at run time. */
+        __HAL_UART_CLEAR_FLAG(&usart1_handle, UART_CLEAR_CMF);
+        uart_dmarx_match_callback(&usart1_handle);
+    }
+
     if (__HAL_UART_GET_FLAG(&usart1_handle, UART_FLAG_IDLE)) {
         __HAL_UART_CLEAR_IDLEFLAG(&usart1_handle);
         uart_dmarx_idle_callback(&usart1_handle);
@@ -634,9 +1229,7 @@ uint8_t usart1_deinit(void) {
 #if USART1_RX_DMA
 
     HAL_DMA_Abort(&usart1_dmarx_handle);
-    CSP_FREE(usart1_rx_fifo.recv_buf);
-    CSP_FREE(usart1_rx_fifo.rx_fifo_buf);
-    ring_fifo_destroy(usart1_rx_fifo.rx_fifo);
+    uart_rx_fifo_free(&usart1_rx_fifo);
 
     if (HAL_DMA_DeInit(&usart1_dmarx_handle) != HAL_OK) {
         return UART_DEINIT_DMA_FAIL;
@@ -652,9 +1245,13 @@ uint8_t usart1_deinit(void) {
 
 #endif /* USART1_RX_DMA */
 
+#if USART1_RX_IT
+    uart_rx_fifo_free(&usart1_rx_fifo);
+#endif /* USART1_RX_IT */
+
 #if USART1_TX_DMA
     HAL_DMA_Abort(&usart1_dmatx_handle);
-    CSP_FREE(usart1_tx_buf.send_buf);
+    uart_tx_buf_free(&usart1_tx_buf);
 
     if (HAL_DMA_DeInit(&usart1_dmatx_handle) != HAL_OK) {
         return UART_DEINIT_DMA_FAIL;
@@ -662,6 +1259,9 @@ uint8_t usart1_deinit(void) {
 
     HAL_NVIC_DisableIRQ(USART1_TX_DMA_IRQn);
 
+#if USE_HAL_UART_REGISTER_CALLBACKS
+    HAL_UART_UnRegisterCallback(&usart1_handle, HAL_UART_TX_COMPLETE_CB_ID);
+#endif /* USE_HAL_UART_REGISTER_CALLBACKS */
     usart1_handle.hdmatx = NULL;
 #endif /* USART1_TX_DMA */
 
@@ -691,6 +1291,10 @@ UART_HandleTypeDef usart2_handle = {.Instance = USART2,
                                              .StopBits = UART_STOPBITS_1,
                                              .Parity = UART_PARITY_NONE}};
 
+#if UART_STATS_ENABLE
+static uart_stats_t usart2_stats;
+#endif /* UART_STATS_ENABLE */
+
 #if USART2_RX_DMA
 
 static DMA_HandleTypeDef usart2_dmarx_handle = {
@@ -704,11 +1308,39 @@ static DMA_HandleTypeDef usart2_dmarx_handle = {
              .PeriphInc = DMA_PINC_DISABLE,
              .Priority = USART2_RX_DMA_PRIORITY}};
 
-static uart_rx_fifo_t usart2_rx_fifo = {.buf_size = USART2_RX_DMA_BUF_SIZE,
-                                        .fifo_size = USART2_RX_DMA_FIFO_SIZE};
+#if UART_STATIC_BUFFER
+static uint8_t usart2_recv_buf[USART2_RX_DMA_BUF_SIZE] UART_RX_BUF_ATTR;
+#if !USART2_RX_DMA_ZERO_COPY
+static uint8_t usart2_rx_fifo_buf[USART2_RX_DMA_FIFO_SIZE] UART_RX_BUF_ATTR;
+#else  /* !USART2_RX_DMA_ZERO_COPY */
+#define usart2_rx_fifo_buf NULL
+#endif /* !USART2_RX_DMA_ZERO_COPY */
+#else  /* UART_STATIC_BUFFER */
+#define usart2_recv_buf    NULL
+#define usart2_rx_fifo_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_rx_fifo_t usart2_rx_fifo = {.recv_buf = usart2_recv_buf,
+                                        .rx_fifo_buf = usart2_rx_fifo_buf,
+                                        .buf_size = USART2_RX_DMA_BUF_SIZE,
+                                        .fifo_size = USART2_RX_DMA_FIFO_SIZE,
+                                        .zero_copy = USART2_RX_DMA_ZERO_COPY};
 
 #endif /* USART2_RX_DMA */
 
+#if USART2_RX_IT
+
+#if UART_STATIC_BUFFER
+static uint8_t usart2_rx_fifo_buf[USART2_RX_IT_FIFO_SIZE] UART_RX_BUF_ATTR;
+#else  /* UART_STATIC_BUFFER */
+#define usart2_rx_fifo_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_rx_fifo_t usart2_rx_fifo = {.rx_fifo_buf = usart2_rx_fifo_buf,
+                                        .fifo_size = USART2_RX_IT_FIFO_SIZE};
+
+#endif /* USART2_RX_IT */
+
 #if USART2_TX_DMA
 
 static DMA_HandleTypeDef usart2_dmatx_handle = {
@@ -722,9 +1354,30 @@ static DMA_HandleTypeDef usart2_dmatx_handle = {
              .PeriphInc = DMA_PINC_DISABLE,
              .Priority = USART2_TX_DMA_PRIORITY}};
 
-static uart_tx_buf_t usart2_tx_buf = {.buf_size = USART2_TX_DMA_BUF_SIZE};
+#if UART_STATIC_BUFFER
+static uint8_t usart2_send_buf[USART2_TX_DMA_BUF_SIZE * 2] UART_TX_BUF_ATTR;
+#else  /* UART_STATIC_BUFFER */
+#define usart2_send_buf NULL
+#endif /* UART_STATIC_BUFFER */
 
+static uart_tx_buf_t usart2_tx_buf = {.send_buf = usart2_send_buf,
+                                      .buf_size = USART2_TX_DMA_BUF_SIZE};
+
+#endif /* USART2_TX_DMA */
+
+/**
+ * @brief Release the buffers of USART2.
+ *
+ */
+static void usart2_buf_free(void) {
+#if USART2_RX_DMA || USART2_RX_IT
+    uart_rx_fifo_free(&usart2_rx_fifo);
+#endif /* USART2_RX_DMA || USART2_RX_IT */
+
+#if USART2_TX_DMA
+    uart_tx_buf_free(&usart2_tx_buf);
 #endif /* USART2_TX_DMA */
+}
 
 /**
  * @brief USART2 initialization
@@ -747,13 +1400,25 @@ uint8_t usart2_init(uint32_t baud_rate) {
                                          .Speed = GPIO_SPEED_FREQ_HIGH,
                                          .Mode = GPIO_MODE_AF_PP};
     usart2_handle.Init.BaudRate = baud_rate;
+#if UART_BAUD_PLANNER
+    if (uart_baud_setup(&usart2_handle, baud_rate) != 0) {
+        return UART_INIT_FAIL;
+    }
+#endif /* UART_BAUD_PLANNER */
+
 #if USART2_TX
     usart2_handle.Init.Mode |= UART_MODE_TX;
 
     CSP_GPIO_CLK_ENABLE(USART2_TX_PORT);
     gpio_init_struct.Pin = USART2_TX_PIN;
     gpio_init_struct.Alternate = USART2_TX_GPIO_AF;
+#if (USART2_BUS_MODE == 2)
+    /* Single-wire, receive on TX pin. */
+    usart2_handle.Init.Mode |= UART_MODE_RX;
+    gpio_init_struct.Mode = GPIO_MODE_AF_OD;
+#endif /* USART2_BUS_MODE */
     HAL_GPIO_Init(CSP_GPIO_PORT(USART2_TX_PORT), &gpio_init_struct);
+    gpio_init_struct.Mode = GPIO_MODE_AF_PP;
 #endif /* USART2_TX */
 
 #if USART2_RX
@@ -775,7 +1440,10 @@ uint8_t usart2_init(uint32_t baud_rate) {
 #endif /* USART2_USART2_CTS */
 
 #if USART2_RTS
+#if (USART2_BUS_MODE != 1)
+    /* RTS pin is DE in RS-485 mode. */
     usart2_handle.Init.HwFlowCtl |= UART_HWCONTROL_RTS;
+#endif /* USART2_BUS_MODE */
 
     CSP_GPIO_CLK_ENABLE(USART2_RTS_PORT);
     gpio_init_struct.Pin = USART2_RTS_PIN;
@@ -790,26 +1458,13 @@ uint8_t usart2_init(uint32_t baud_rate) {
 #endif /* USART2_IT_ENABLE */
 
 #if USART2_RX_DMA
-    usart2_rx_fifo.head_ptr = 0;
-
-    usart2_rx_fifo.recv_buf = CSP_MALLOC(usart2_rx_fifo.buf_size);
-    if (usart2_rx_fifo.recv_buf == NULL) {
-        return UART_INIT_MEM_FAIL;
-    }
-
-    usart2_rx_fifo.rx_fifo_buf = CSP_MALLOC(usart2_rx_fifo.fifo_size);
-    if (usart2_rx_fifo.rx_fifo_buf == NULL) {
-        return UART_INIT_MEM_FAIL;
-    }
-
-    usart2_rx_fifo.rx_fifo = ring_fifo_init(
-        usart2_rx_fifo.rx_fifo_buf, usart2_rx_fifo.fifo_size, RF_TYPE_STREAM);
-    if (usart2_rx_fifo.rx_fifo == NULL) {
+    if (uart_rx_fifo_alloc(&usart2_rx_fifo, 1) != 0) {
         return UART_INIT_MEM_FAIL;
     }
 
     CSP_DMA_CLK_ENABLE(USART2_RX_DMA_NUMBER);
     if (HAL_DMA_Init(&usart2_dmarx_handle) != HAL_OK) {
+        usart2_buf_free();
         return UART_INIT_DMA_FAIL;
     }
 
@@ -821,14 +1476,21 @@ uint8_t usart2_init(uint32_t baud_rate) {
 
 #endif /* USART2_RX_DMA */
 
+#if USART2_RX_IT
+    if (uart_rx_fifo_alloc(&usart2_rx_fifo, 0) != 0) {
+        return UART_INIT_MEM_FAIL;
+    }
+#endif /* USART2_RX_IT */
+
 #if USART2_TX_DMA
-    usart2_tx_buf.send_buf = CSP_MALLOC(usart2_tx_buf.buf_size);
-    if (usart2_tx_buf.send_buf == NULL) {
+    if (uart_tx_buf_alloc(&usart2_tx_buf) != 0) {
+        usart2_buf_free();
         return UART_INIT_MEM_FAIL;
     }
 
     CSP_DMA_CLK_ENABLE(USART2_TX_DMA_NUMBER);
     if (HAL_DMA_Init(&usart2_dmatx_handle) != HAL_OK) {
+        usart2_buf_free();
         return UART_INIT_DMA_FAIL;
     }
 
@@ -839,11 +1501,44 @@ uint8_t usart2_init(uint32_t baud_rate) {
     HAL_NVIC_EnableIRQ(USART2_TX_DMA_IRQn);
 #endif /* USART2_TX_DMA */
 
+#if (USART2_BUS_MODE == 1)
+    if (HAL_RS485Ex_Init(&usart2_handle, UART_DE_POLARITY_HIGH,
+                         USART2_DE_ASSERT_TIME,
+                         USART2_DE_DEASSERT_TIME) != HAL_OK) {
+        usart2_buf_free();
+        return UART_INIT_FAIL;
+    }
+#elif (USART2_BUS_MODE == 2)
+    if (HAL_HalfDuplex_Init(&usart2_handle) != HAL_OK) {
+        usart2_buf_free();
+        return UART_INIT_FAIL;
+    }
+#else  /* USART2_BUS_MODE */
     if (HAL_UART_Init(&usart2_handle) != HAL_OK) {
+        usart2_buf_free();
         return UART_INIT_FAIL;
     }
+#endif /* USART2_BUS_MODE */
     
+#if USART2_FIFO_ENABLE
+    HAL_UARTEx_SetTxFifoThreshold(&usart2_handle, USART2_TX_FIFO_THRESHOLD);
+    HAL_UARTEx_SetRxFifoThreshold(&usart2_handle, USART2_RX_FIFO_THRESHOLD);
+    HAL_UARTEx_EnableFifoMode(&usart2_handle);
+#else  /* USART2_FIFO_ENABLE */
     HAL_UARTEx_DisableFifoMode(&usart2_handle);
+#endif /* USART2_FIFO_ENABLE */
+
+#if USART2_MUTE_MODE
+    if (uart_mute_config(&usart2_handle, USART2_MUTE_WAKEUP,
+                         USART2_MUTE_ADDR_7BIT, USART2_MUTE_ADDRESS) != 0) {
+        usart2_buf_free();
+        return UART_INIT_FAIL;
+    }
+#endif /* USART2_MUTE_MODE */
+
+#if USART2_CHAR_MATCH
+    uart_set_match_char(&usart2_handle, USART2_MATCH_CHAR);
+#endif /* USART2_CHAR_MATCH */
     
 #if USART2_RX_DMA
     __HAL_UART_ENABLE_IT(&usart2_handle, UART_IT_IDLE);
@@ -859,6 +1554,27 @@ uint8_t usart2_init(uint32_t baud_rate) {
                               uart_dmarx_done_callback);
 #endif /* USE_HAL_UART_REGISTER_CALLBACKS */
 #endif /* USART2_RX_DMA */
+
+#if USART2_RX_IT
+#if USART2_FIFO_ENABLE
+    /* Drain a threshold level per interrupt, the rest at line idle. */
+    __HAL_UART_CLEAR_IDLEFLAG(&usart2_handle);
+    __HAL_UART_ENABLE_IT(&usart2_handle, UART_IT_IDLE);
+    __HAL_UART_ENABLE_IT(&usart2_handle, UART_IT_RXFT);
+#else  /* USART2_FIFO_ENABLE */
+    __HAL_UART_ENABLE_IT(&usart2_handle, UART_IT_RXNE);
+#endif /* USART2_FIFO_ENABLE */
+    __HAL_UART_ENABLE_IT(&usart2_handle, UART_IT_ERR);
+#endif /* USART2_RX_IT */
+
+#if USART2_TX_DMA && USE_HAL_UART_REGISTER_CALLBACKS
+    HAL_UART_RegisterCallback(&usart2_handle, HAL_UART_TX_COMPLETE_CB_ID,
+                              uart_dmatx_done_callback);
+#endif /* USART2_TX_DMA && USE_HAL_UART_REGISTER_CALLBACKS */
+
+#if USART2_STDIO
+    uart_stdio_init();
+#endif /* USART2_STDIO */
     return UART_INIT_OK;
 }
 
@@ -869,6 +1585,26 @@ uint8_t usart2_init(uint32_t baud_rate) {
  *
  */
 void USART2_IRQHandler(void) {
+#if USART2_RX_IT
+    uart_rx_irq_handler(&usart2_handle);
+#endif /* USART2_RX_IT */
+
+#if USART2_RX_DMA
+    uart_dmarx_error_handler(&usart2_handle);
+#endif /* USART2_RX_DMA */
+
+    if (__HAL_UART_GET_FLAG(&usart2_handle, UART_FLAG_RTOF)) {
+        /* Handle before HAL, which takes it as an error. */
+        __HAL_UART_CLEAR_FLAG(&usart2_handle, UART_CLEAR_RTOF);
+        uart_rx_timeout_callback(&usart2_handle);
+    }
+
+    if (__HAL_UART_GET_FLAG(&usart2_handle, UART_FLAG_CMF)) {
+        /* Also set by `uart_set_match_char()` at run time. */
+        __HAL_UART_CLEAR_FLAG(&usart2_handle, UART_CLEAR_CMF);
+        uart_dmarx_match_callback(&usart2_handle);
+    }
+
     if (__HAL_UART_GET_FLAG(&usart2_handle, UART_FLAG_IDLE)) {
         __HAL_UART_CLEAR_IDLEFLAG(&usart2_handle);
         uart_dmarx_idle_callback(&usart2_handle);
@@ -942,9 +1678,7 @@ uint8_t usart2_deinit(void) {
 #if USART2_RX_DMA
 
     HAL_DMA_Abort(&usart2_dmarx_handle);
-    CSP_FREE(usart2_rx_fifo.recv_buf);
-    CSP_FREE(usart2_rx_fifo.rx_fifo_buf);
-    ring_fifo_destroy(usart2_rx_fifo.rx_fifo);
+    uart_rx_fifo_free(&usart2_rx_fifo);
 
     if (HAL_DMA_DeInit(&usart2_dmarx_handle) != HAL_OK) {
         return UART_DEINIT_DMA_FAIL;
@@ -960,9 +1694,13 @@ uint8_t usart2_deinit(void) {
 
 #endif /* USART2_RX_DMA */
 
+#if USART2_RX_IT
+    uart_rx_fifo_free(&usart2_rx_fifo);
+#endif /* USART2_RX_IT */
+
 #if USART2_TX_DMA
     HAL_DMA_Abort(&usart2_dmatx_handle);
-    CSP_FREE(usart2_tx_buf.send_buf);
+    uart_tx_buf_free(&usart2_tx_buf);
 
     if (HAL_DMA_DeInit(&usart2_dmatx_handle) != HAL_OK) {
         return UART_DEINIT_DMA_FAIL;
@@ -970,6 +1708,9 @@ uint8_t usart2_deinit(void) {
 
     HAL_NVIC_DisableIRQ(USART2_TX_DMA_IRQn);
 
+#if USE_HAL_UART_REGISTER_CALLBACKS
+    HAL_UART_UnRegisterCallback(&usart2_handle, HAL_UART_TX_COMPLETE_CB_ID);
+#endif /* USE_HAL_UART_REGISTER_CALLBACKS */
     usart2_handle.hdmatx = NULL;
 #endif /* USART2_TX_DMA */
 
@@ -999,6 +1740,10 @@ UART_HandleTypeDef usart3_handle = {.Instance = USART3,
                                              .StopBits = UART_STOPBITS_1,
                                              .Parity = UART_PARITY_NONE}};
 
+#if UART_STATS_ENABLE
+static uart_stats_t usart3_stats;
+#endif /* UART_STATS_ENABLE */
+
 #if USART3_RX_DMA
 
 static DMA_HandleTypeDef usart3_dmarx_handle = {
@@ -1012,11 +1757,39 @@ static DMA_HandleTypeDef usart3_dmarx_handle = {
              .PeriphInc = DMA_PINC_DISABLE,
              .Priority = USART3_RX_DMA_PRIORITY}};
 
-static uart_rx_fifo_t usart3_rx_fifo = {.buf_size = USART3_RX_DMA_BUF_SIZE,
-                                        .fifo_size = USART3_RX_DMA_FIFO_SIZE};
+#if UART_STATIC_BUFFER
+static uint8_t usart3_recv_buf[USART3_RX_DMA_BUF_SIZE] UART_RX_BUF_ATTR;
+#if !USART3_RX_DMA_ZERO_COPY
+static uint8_t usart3_rx_fifo_buf[USART3_RX_DMA_FIFO_SIZE] UART_RX_BUF_ATTR;
+#else  /* !USART3_RX_DMA_ZERO_COPY */
+#define usart3_rx_fifo_buf NULL
+#endif /* !USART3_RX_DMA_ZERO_COPY */
+#else  /* UART_STATIC_BUFFER */
+#define usart3_recv_buf    NULL
+#define usart3_rx_fifo_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_rx_fifo_t usart3_rx_fifo = {.recv_buf = usart3_recv_buf,
+                                        .rx_fifo_buf = usart3_rx_fifo_buf,
+                                        .buf_size = USART3_RX_DMA_BUF_SIZE,
+                                        .fifo_size = USART3_RX_DMA_FIFO_SIZE,
+                                        .zero_copy = USART3_RX_DMA_ZERO_COPY};
 
 #endif /* USART3_RX_DMA */
 
+#if USART3_RX_IT
+
+#if UART_STATIC_BUFFER
+static uint8_t usart3_rx_fifo_buf[USART3_RX_IT_FIFO_SIZE] UART_RX_BUF_ATTR;
+#else  /* UART_STATIC_BUFFER */
+#define usart3_rx_fifo_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_rx_fifo_t usart3_rx_fifo = {.rx_fifo_buf = usart3_rx_fifo_buf,
+                                        .fifo_size = USART3_RX_IT_FIFO_SIZE};
+
+#endif /* USART3_RX_IT */
+
 #if USART3_TX_DMA
 
 static DMA_HandleTypeDef usart3_dmatx_handle = {
@@ -1030,9 +1803,30 @@ static DMA_HandleTypeDef usart3_dmatx_handle = {
              .PeriphInc = DMA_PINC_DISABLE,
              .Priority = USART3_TX_DMA_PRIORITY}};
 
-static uart_tx_buf_t usart3_tx_buf = {.buf_size = USART3_TX_DMA_BUF_SIZE};
+#if UART_STATIC_BUFFER
+static uint8_t usart3_send_buf[USART3_TX_DMA_BUF_SIZE * 2] UART_TX_BUF_ATTR;
+#else  /* UART_STATIC_BUFFER */
+#define usart3_send_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_tx_buf_t usart3_tx_buf = {.send_buf = usart3_send_buf,
+                                      .buf_size = USART3_TX_DMA_BUF_SIZE};
+
+#endif /* USART3_TX_DMA */
+
+/**
+ * @brief Release the buffers of USART3.
+ *
+ */
+static void usart3_buf_free(void) {
+#if USART3_RX_DMA || USART3_RX_IT
+    uart_rx_fifo_free(&usart3_rx_fifo);
+#endif /* USART3_RX_DMA || USART3_RX_IT */
 
+#if USART3_TX_DMA
+    uart_tx_buf_free(&usart3_tx_buf);
 #endif /* USART3_TX_DMA */
+}
 
 /**
  * @brief USART3 initialization
@@ -1055,13 +1849,25 @@ uint8_t usart3_init(uint32_t baud_rate) {
                                          .Speed = GPIO_SPEED_FREQ_HIGH,
                                          .Mode = GPIO_MODE_AF_PP};
     usart3_handle.Init.BaudRate = baud_rate;
+#if UART_BAUD_PLANNER
+    if (uart_baud_setup(&usart3_handle, baud_rate) != 0) {
+        return UART_INIT_FAIL;
+    }
+#endif /* UART_BAUD_PLANNER */
+
 #if USART3_TX
     usart3_handle.Init.Mode |= UART_MODE_TX;
 
     CSP_GPIO_CLK_ENABLE(USART3_TX_PORT);
     gpio_init_struct.Pin = USART3_TX_PIN;
     gpio_init_struct.Alternate = USART3_TX_GPIO_AF;
+#if (USART3_BUS_MODE == 2)
+    /* Single-wire, receive on TX pin. */
+    usart3_handle.Init.Mode |= UART_MODE_RX;
+    gpio_init_struct.Mode = GPIO_MODE_AF_OD;
+#endif /* USART3_BUS_MODE */
     HAL_GPIO_Init(CSP_GPIO_PORT(USART3_TX_PORT), &gpio_init_struct);
+    gpio_init_struct.Mode = GPIO_MODE_AF_PP;
 #endif /* USART3_TX */
 
 #if USART3_RX
@@ -1083,7 +1889,10 @@ uint8_t usart3_init(uint32_t baud_rate) {
 #endif /* USART3_USART3_CTS */
 
 #if USART3_RTS
+#if (USART3_BUS_MODE != 1)
+    /* RTS pin is DE in RS-485 mode. */
     usart3_handle.Init.HwFlowCtl |= UART_HWCONTROL_RTS;
+#endif /* USART3_BUS_MODE */
 
     CSP_GPIO_CLK_ENABLE(USART3_RTS_PORT);
     gpio_init_struct.Pin = USART3_RTS_PIN;
@@ -1098,26 +1907,13 @@ uint8_t usart3_init(uint32_t baud_rate) {
 #endif /* USART3_IT_ENABLE */
 
 #if USART3_RX_DMA
-    usart3_rx_fifo.head_ptr = 0;
-
-    usart3_rx_fifo.recv_buf = CSP_MALLOC(usart3_rx_fifo.buf_size);
-    if (usart3_rx_fifo.recv_buf == NULL) {
-        return UART_INIT_MEM_FAIL;
-    }
-
-    usart3_rx_fifo.rx_fifo_buf = CSP_MALLOC(usart3_rx_fifo.fifo_size);
-    if (usart3_rx_fifo.rx_fifo_buf == NULL) {
-        return UART_INIT_MEM_FAIL;
-    }
-
-    usart3_rx_fifo.rx_fifo = ring_fifo_init(
-        usart3_rx_fifo.rx_fifo_buf, usart3_rx_fifo.fifo_size, RF_TYPE_STREAM);
-    if (usart3_rx_fifo.rx_fifo == NULL) {
+    if (uart_rx_fifo_alloc(&usart3_rx_fifo, 1) != 0) {
         return UART_INIT_MEM_FAIL;
     }
 
     CSP_DMA_CLK_ENABLE(USART3_RX_DMA_NUMBER);
     if (HAL_DMA_Init(&usart3_dmarx_handle) != HAL_OK) {
+        usart3_buf_free();
         return UART_INIT_DMA_FAIL;
     }
 
@@ -1129,14 +1925,21 @@ uint8_t usart3_init(uint32_t baud_rate) {
 
 #endif /* USART3_RX_DMA */
 
+#if USART3_RX_IT
+    if (uart_rx_fifo_alloc(&usart3_rx_fifo, 0) != 0) {
+        return UART_INIT_MEM_FAIL;
+    }
+#endif /* USART3_RX_IT */
+
 #if USART3_TX_DMA
-    usart3_tx_buf.send_buf = CSP_MALLOC(usart3_tx_buf.buf_size);
-    if (usart3_tx_buf.send_buf == NULL) {
+    if (uart_tx_buf_alloc(&usart3_tx_buf) != 0) {
+        usart3_buf_free();
         return UART_INIT_MEM_FAIL;
     }
 
     CSP_DMA_CLK_ENABLE(USART3_TX_DMA_NUMBER);
     if (HAL_DMA_Init(&usart3_dmatx_handle) != HAL_OK) {
+        usart3_buf_free();
         return UART_INIT_DMA_FAIL;
     }
 
@@ -1147,11 +1950,44 @@ uint8_t usart3_init(uint32_t baud_rate) {
     HAL_NVIC_EnableIRQ(USART3_TX_DMA_IRQn);
 #endif /* USART3_TX_DMA */
 
+#if (USART3_BUS_MODE == 1)
+    if (HAL_RS485Ex_Init(&usart3_handle, UART_DE_POLARITY_HIGH,
+                         USART3_DE_ASSERT_TIME,
+                         USART3_DE_DEASSERT_TIME) != HAL_OK) {
+        usart3_buf_free();
+        return UART_INIT_FAIL;
+    }
+#elif (USART3_BUS_MODE == 2)
+    if (HAL_HalfDuplex_Init(&usart3_handle) != HAL_OK) {
+        usart3_buf_free();
+        return UART_INIT_FAIL;
+    }
+#else  /* USART3_BUS_MODE */
     if (HAL_UART_Init(&usart3_handle) != HAL_OK) {
+        usart3_buf_free();
         return UART_INIT_FAIL;
     }
+#endif /* USART3_BUS_MODE */
     
+#if USART3_FIFO_ENABLE
+    HAL_UARTEx_SetTxFifoThreshold(&usart3_handle, USART3_TX_FIFO_THRESHOLD);
+    HAL_UARTEx_SetRxFifoThreshold(&usart3_handle, USART3_RX_FIFO_THRESHOLD);
+    HAL_UARTEx_EnableFifoMode(&usart3_handle);
+#else  /* USART3_FIFO_ENABLE */
     HAL_UARTEx_DisableFifoMode(&usart3_handle);
+#endif /* USART3_FIFO_ENABLE */
+
+#if USART3_MUTE_MODE
+    if (uart_mute_config(&usart3_handle, USART3_MUTE_WAKEUP,
+                         USART3_MUTE_ADDR_7BIT, USART3_MUTE_ADDRESS) != 0) {
+        usart3_buf_free();
+        return UART_INIT_FAIL;
+    }
+#endif /* USART3_MUTE_MODE */
+
+#if USART3_CHAR_MATCH
+    uart_set_match_char(&usart3_handle, USART3_MATCH_CHAR);
+#endif /* USART3_CHAR_MATCH */
     
 #if USART3_RX_DMA
     __HAL_UART_ENABLE_IT(&usart3_handle, UART_IT_IDLE);
@@ -1167,6 +2003,27 @@ uint8_t usart3_init(uint32_t baud_rate) {
                               uart_dmarx_done_callback);
 #endif /* USE_HAL_UART_REGISTER_CALLBACKS */
 #endif /* USART3_RX_DMA */
+
+#if USART3_RX_IT
+#if USART3_FIFO_ENABLE
+    /* Drain a threshold level per interrupt, the rest at line idle. */
+    __HAL_UART_CLEAR_IDLEFLAG(&usart3_handle);
+    __HAL_UART_ENABLE_IT(&usart3_handle, UART_IT_IDLE);
+    __HAL_UART_ENABLE_IT(&usart3_handle, UART_IT_RXFT);
+#else  /* USART3_FIFO_ENABLE */
+    __HAL_UART_ENABLE_IT(&usart3_handle, UART_IT_RXNE);
+#endif /* USART3_FIFO_ENABLE */
+    __HAL_UART_ENABLE_IT(&usart3_handle, UART_IT_ERR);
+#endif /* USART3_RX_IT */
+
+#if USART3_TX_DMA && USE_HAL_UART_REGISTER_CALLBACKS
+    HAL_UART_RegisterCallback(&usart3_handle, HAL_UART_TX_COMPLETE_CB_ID,
+                              uart_dmatx_done_callback);
+#endif /* USART3_TX_DMA && USE_HAL_UART_REGISTER_CALLBACKS */
+
+#if USART3_STDIO
+    uart_stdio_init();
+#endif /* USART3_STDIO */
     return UART_INIT_OK;
 }
 
@@ -1177,6 +2034,26 @@ uint8_t usart3_init(uint32_t baud_rate) {
  *
  */
 void USART3_IRQHandler(void) {
+#if USART3_RX_IT
+    uart_rx_irq_handler(&usart3_handle);
+#endif /* USART3_RX_IT */
+
+#if USART3_RX_DMA
+    uart_dmarx_error_handler(&usart3_handle);
+#endif /* USART3_RX_DMA */
+
+    if (__HAL_UART_GET_FLAG(&usart3_handle, UART_FLAG_RTOF)) {
+        /* Handle before HAL, which takes it as an error. */
+        __HAL_UART_CLEAR_FLAG(&usart3_handle, UART_CLEAR_RTOF);
+        uart_rx_timeout_callback(&usart3_handle);
+    }
+
+    if (__HAL_UART_GET_FLAG(&usart3_handle, UART_FLAG_CMF)) {
+        /* Also set by `uart_set_match_char()` at run time. */
+        __HAL_UART_CLEAR_FLAG(&usart3_handle, UART_CLEAR_CMF);
+        uart_dmarx_match_callback(&usart3_handle);
+    }
+
     if (__HAL_UART_GET_FLAG(&usart3_handle, UART_FLAG_IDLE)) {
         __HAL_UART_CLEAR_IDLEFLAG(&usart3_handle);
         uart_dmarx_idle_callback(&usart3_handle);
@@ -1250,9 +2127,7 @@ uint8_t usart3_deinit(void) {
 #if USART3_RX_DMA
 
     HAL_DMA_Abort(&usart3_dmarx_handle);
-    CSP_FREE(usart3_rx_fifo.recv_buf);
-    CSP_FREE(usart3_rx_fifo.rx_fifo_buf);
-    ring_fifo_destroy(usart3_rx_fifo.rx_fifo);
+    uart_rx_fifo_free(&usart3_rx_fifo);
 
     if (HAL_DMA_DeInit(&usart3_dmarx_handle) != HAL_OK) {
         return UART_DEINIT_DMA_FAIL;
@@ -1268,9 +2143,13 @@ uint8_t usart3_deinit(void) {
 
 #endif /* USART3_RX_DMA */
 
+#if USART3_RX_IT
+    uart_rx_fifo_free(&usart3_rx_fifo);
+#endif /* USART3_RX_IT */
+
 #if USART3_TX_DMA
     HAL_DMA_Abort(&usart3_dmatx_handle);
-    CSP_FREE(usart3_tx_buf.send_buf);
+    uart_tx_buf_free(&usart3_tx_buf);
 
     if (HAL_DMA_DeInit(&usart3_dmatx_handle) != HAL_OK) {
         return UART_DEINIT_DMA_FAIL;
@@ -1278,6 +2157,9 @@ uint8_t usart3_deinit(void) {
 
     HAL_NVIC_DisableIRQ(USART3_TX_DMA_IRQn);
 
+#if USE_HAL_UART_REGISTER_CALLBACKS
+    HAL_UART_UnRegisterCallback(&usart3_handle, HAL_UART_TX_COMPLETE_CB_ID);
+#endif /* USE_HAL_UART_REGISTER_CALLBACKS */
     usart3_handle.hdmatx = NULL;
 #endif /* USART3_TX_DMA */
 
@@ -1307,6 +2189,10 @@ UART_HandleTypeDef uart4_handle = {.Instance = UART4,
                                              .StopBits = UART_STOPBITS_1,
                                              .Parity = UART_PARITY_NONE}};
 
+#if UART_STATS_ENABLE
+static uart_stats_t uart4_stats;
+#endif /* UART_STATS_ENABLE */
+
 #if UART4_RX_DMA
 
 static DMA_HandleTypeDef uart4_dmarx_handle = {
@@ -1320,11 +2206,39 @@ static DMA_HandleTypeDef uart4_dmarx_handle = {
              .PeriphInc = DMA_PINC_DISABLE,
              .Priority = UART4_RX_DMA_PRIORITY}};
 
-static uart_rx_fifo_t uart4_rx_fifo = {.buf_size = UART4_RX_DMA_BUF_SIZE,
-                                        .fifo_size = UART4_RX_DMA_FIFO_SIZE};
+#if UART_STATIC_BUFFER
+static uint8_t uart4_recv_buf[UART4_RX_DMA_BUF_SIZE] UART_RX_BUF_ATTR;
+#if !UART4_RX_DMA_ZERO_COPY
+static uint8_t uart4_rx_fifo_buf[UART4_RX_DMA_FIFO_SIZE] UART_RX_BUF_ATTR;
+#else  /* !UART4_RX_DMA_ZERO_COPY */
+#define uart4_rx_fifo_buf NULL
+#endif /* !UART4_RX_DMA_ZERO_COPY */
+#else  /* UART_STATIC_BUFFER */
+#define uart4_recv_buf    NULL
+#define uart4_rx_fifo_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_rx_fifo_t uart4_rx_fifo = {.recv_buf = uart4_recv_buf,
+                                        .rx_fifo_buf = uart4_rx_fifo_buf,
+                                        .buf_size = UART4_RX_DMA_BUF_SIZE,
+                                        .fifo_size = UART4_RX_DMA_FIFO_SIZE,
+                                        .zero_copy = UART4_RX_DMA_ZERO_COPY};
 
 #endif /* UART4_RX_DMA */
 
+#if UART4_RX_IT
+
+#if UART_STATIC_BUFFER
+static uint8_t uart4_rx_fifo_buf[UART4_RX_IT_FIFO_SIZE] UART_RX_BUF_ATTR;
+#else  /* UART_STATIC_BUFFER */
+#define uart4_rx_fifo_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_rx_fifo_t uart4_rx_fifo = {.rx_fifo_buf = uart4_rx_fifo_buf,
+                                        .fifo_size = UART4_RX_IT_FIFO_SIZE};
+
+#endif /* UART4_RX_IT */
+
 #if UART4_TX_DMA
 
 static DMA_HandleTypeDef uart4_dmatx_handle = {
@@ -1338,9 +2252,30 @@ static DMA_HandleTypeDef uart4_dmatx_handle = {
              .PeriphInc = DMA_PINC_DISABLE,
              .Priority = UART4_TX_DMA_PRIORITY}};
 
-static uart_tx_buf_t uart4_tx_buf = {.buf_size = UART4_TX_DMA_BUF_SIZE};
+#if UART_STATIC_BUFFER
+static uint8_t uart4_send_buf[UART4_TX_DMA_BUF_SIZE * 2] UART_TX_BUF_ATTR;
+#else  /* UART_STATIC_BUFFER */
+#define uart4_send_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_tx_buf_t uart4_tx_buf = {.send_buf = uart4_send_buf,
+                                      .buf_size = UART4_TX_DMA_BUF_SIZE};
+
+#endif /* UART4_TX_DMA */
+
+/**
+ * @brief Release the buffers of UART4.
+ *
+ */
+static void uart4_buf_free(void) {
+#if UART4_RX_DMA || UART4_RX_IT
+    uart_rx_fifo_free(&uart4_rx_fifo);
+#endif /* UART4_RX_DMA || UART4_RX_IT */
 
+#if UART4_TX_DMA
+    uart_tx_buf_free(&uart4_tx_buf);
 #endif /* UART4_TX_DMA */
+}
 
 /**
  * @brief UART4 initialization
@@ -1363,13 +2298,25 @@ uint8_t uart4_init(uint32_t baud_rate) {
                                          .Speed = GPIO_SPEED_FREQ_HIGH,
                                          .Mode = GPIO_MODE_AF_PP};
     uart4_handle.Init.BaudRate = baud_rate;
+#if UART_BAUD_PLANNER
+    if (uart_baud_setup(&uart4_handle, baud_rate) != 0) {
+        return UART_INIT_FAIL;
+    }
+#endif /* UART_BAUD_PLANNER */
+
 #if UART4_TX
     uart4_handle.Init.Mode |= UART_MODE_TX;
 
     CSP_GPIO_CLK_ENABLE(UART4_TX_PORT);
     gpio_init_struct.Pin = UART4_TX_PIN;
     gpio_init_struct.Alternate = UART4_TX_GPIO_AF;
+#if (UART4_BUS_MODE == 2)
+    /* Single-wire, receive on TX pin. */
+    uart4_handle.Init.Mode |= UART_MODE_RX;
+    gpio_init_struct.Mode = GPIO_MODE_AF_OD;
+#endif /* UART4_BUS_MODE */
     HAL_GPIO_Init(CSP_GPIO_PORT(UART4_TX_PORT), &gpio_init_struct);
+    gpio_init_struct.Mode = GPIO_MODE_AF_PP;
 #endif /* UART4_TX */
 
 #if UART4_RX
@@ -1391,7 +2338,10 @@ uint8_t uart4_init(uint32_t baud_rate) {
 #endif /* UART4_UART4_CTS */
 
 #if UART4_RTS
+#if (UART4_BUS_MODE != 1)
+    /* RTS pin is DE in RS-485 mode. */
     uart4_handle.Init.HwFlowCtl |= UART_HWCONTROL_RTS;
+#endif /* UART4_BUS_MODE */
 
     CSP_GPIO_CLK_ENABLE(UART4_RTS_PORT);
     gpio_init_struct.Pin = UART4_RTS_PIN;
@@ -1406,26 +2356,13 @@ uint8_t uart4_init(uint32_t baud_rate) {
 #endif /* UART4_IT_ENABLE */
 
 #if UART4_RX_DMA
-    uart4_rx_fifo.head_ptr = 0;
-
-    uart4_rx_fifo.recv_buf = CSP_MALLOC(uart4_rx_fifo.buf_size);
-    if (uart4_rx_fifo.recv_buf == NULL) {
-        return UART_INIT_MEM_FAIL;
-    }
-
-    uart4_rx_fifo.rx_fifo_buf = CSP_MALLOC(uart4_rx_fifo.fifo_size);
-    if (uart4_rx_fifo.rx_fifo_buf == NULL) {
-        return UART_INIT_MEM_FAIL;
-    }
-
-    uart4_rx_fifo.rx_fifo = ring_fifo_init(
-        uart4_rx_fifo.rx_fifo_buf, uart4_rx_fifo.fifo_size, RF_TYPE_STREAM);
-    if (uart4_rx_fifo.rx_fifo == NULL) {
+    if (uart_rx_fifo_alloc(&uart4_rx_fifo, 1) != 0) {
         return UART_INIT_MEM_FAIL;
     }
 
     CSP_DMA_CLK_ENABLE(UART4_RX_DMA_NUMBER);
     if (HAL_DMA_Init(&uart4_dmarx_handle) != HAL_OK) {
+        uart4_buf_free();
         return UART_INIT_DMA_FAIL;
     }
 
@@ -1437,14 +2374,21 @@ uint8_t uart4_init(uint32_t baud_rate) {
 
 #endif /* UART4_RX_DMA */
 
+#if UART4_RX_IT
+    if (uart_rx_fifo_alloc(&uart4_rx_fifo, 0) != 0) {
+        return UART_INIT_MEM_FAIL;
+    }
+#endif /* UART4_RX_IT */
+
 #if UART4_TX_DMA
-    uart4_tx_buf.send_buf = CSP_MALLOC(uart4_tx_buf.buf_size);
-    if (uart4_tx_buf.send_buf == NULL) {
+    if (uart_tx_buf_alloc(&uart4_tx_buf) != 0) {
+        uart4_buf_free();
         return UART_INIT_MEM_FAIL;
     }
 
     CSP_DMA_CLK_ENABLE(UART4_TX_DMA_NUMBER);
     if (HAL_DMA_Init(&uart4_dmatx_handle) != HAL_OK) {
+        uart4_buf_free();
         return UART_INIT_DMA_FAIL;
     }
 
@@ -1455,11 +2399,44 @@ uint8_t uart4_init(uint32_t baud_rate) {
     HAL_NVIC_EnableIRQ(UART4_TX_DMA_IRQn);
 #endif /* UART4_TX_DMA */
 
+#if (UART4_BUS_MODE == 1)
+    if (HAL_RS485Ex_Init(&uart4_handle, UART_DE_POLARITY_HIGH,
+                         UART4_DE_ASSERT_TIME,
+                         UART4_DE_DEASSERT_TIME) != HAL_OK) {
+        uart4_buf_free();
+        return UART_INIT_FAIL;
+    }
+#elif (UART4_BUS_MODE == 2)
+    if (HAL_HalfDuplex_Init(&uart4_handle) != HAL_OK) {
+        uart4_buf_free();
+        return UART_INIT_FAIL;
+    }
+#else  /* UART4_BUS_MODE */
     if (HAL_UART_Init(&uart4_handle) != HAL_OK) {
+        uart4_buf_free();
         return UART_INIT_FAIL;
     }
+#endif /* UART4_BUS_MODE */
     
+#if UART4_FIFO_ENABLE
+    HAL_UARTEx_SetTxFifoThreshold(&uart4_handle, UART4_TX_FIFO_THRESHOLD);
+    HAL_UARTEx_SetRxFifoThreshold(&uart4_handle, UART4_RX_FIFO_THRESHOLD);
+    HAL_UARTEx_EnableFifoMode(&uart4_handle);
+#else  /* UART4_FIFO_ENABLE */
     HAL_UARTEx_DisableFifoMode(&uart4_handle);
+#endif /* UART4_FIFO_ENABLE */
+
+#if UART4_MUTE_MODE
+    if (uart_mute_config(&uart4_handle, UART4_MUTE_WAKEUP,
+                         UART4_MUTE_ADDR_7BIT, UART4_MUTE_ADDRESS) != 0) {
+        uart4_buf_free();
+        return UART_INIT_FAIL;
+    }
+#endif /* UART4_MUTE_MODE */
+
+#if UART4_CHAR_MATCH
+    uart_set_match_char(&uart4_handle, UART4_MATCH_CHAR);
+#endif /* UART4_CHAR_MATCH */
     
 #if UART4_RX_DMA
     __HAL_UART_ENABLE_IT(&uart4_handle, UART_IT_IDLE);
@@ -1475,6 +2452,27 @@ uint8_t uart4_init(uint32_t baud_rate) {
                               uart_dmarx_done_callback);
 #endif /* USE_HAL_UART_REGISTER_CALLBACKS */
 #endif /* UART4_RX_DMA */
+
+#if UART4_RX_IT
+#if UART4_FIFO_ENABLE
+    /* Drain a threshold level per interrupt, the rest at line idle. */
+    __HAL_UART_CLEAR_IDLEFLAG(&uart4_handle);
+    __HAL_UART_ENABLE_IT(&uart4_handle, UART_IT_IDLE);
+    __HAL_UART_ENABLE_IT(&uart4_handle, UART_IT_RXFT);
+#else  /* UART4_FIFO_ENABLE */
+    __HAL_UART_ENABLE_IT(&uart4_handle, UART_IT_RXNE);
+#endif /* UART4_FIFO_ENABLE */
+    __HAL_UART_ENABLE_IT(&uart4_handle, UART_IT_ERR);
+#endif /* UART4_RX_IT */
+
+#if UART4_TX_DMA && USE_HAL_UART_REGISTER_CALLBACKS
+    HAL_UART_RegisterCallback(&uart4_handle, HAL_UART_TX_COMPLETE_CB_ID,
+                              uart_dmatx_done_callback);
+#endif /* UART4_TX_DMA && USE_HAL_UART_REGISTER_CALLBACKS */
+
+#if UART4_STDIO
+    uart_stdio_init();
+#endif /* UART4_STDIO */
     return UART_INIT_OK;
 }
 
@@ -1485,6 +2483,26 @@ uint8_t uart4_init(uint32_t baud_rate) {
  *
  */
 void UART4_IRQHandler(void) {
+#if UART4_RX_IT
+    uart_rx_irq_handler(&uart4_handle);
+#endif /* UART4_RX_IT */
+
+#if UART4_RX_DMA
+    uart_dmarx_error_handler(&uart4_handle);
+#endif /* UART4_RX_DMA */
+
+    if (__HAL_UART_GET_FLAG(&uart4_handle, UART_FLAG_RTOF)) {
+        /* Handle before HAL, which takes it as an error. */
+        __HAL_UART_CLEAR_FLAG(&uart4_handle, UART_CLEAR_RTOF);
+        uart_rx_timeout_callback(&uart4_handle);
+    }
+
+    if (__HAL_UART_GET_FLAG(&uart4_handle, UART_FLAG_CMF)) {
+        /* Also set by `uart_set_match_char()` at run time. */
+        __HAL_UART_CLEAR_FLAG(&uart4_handle, UART_CLEAR_CMF);
+        uart_dmarx_match_callback(&uart4_handle);
+    }
+
     if (__HAL_UART_GET_FLAG(&uart4_handle, UART_FLAG_IDLE)) {
         __HAL_UART_CLEAR_IDLEFLAG(&uart4_handle);
         uart_dmarx_idle_callback(&uart4_handle);
@@ -1558,9 +2576,7 @@ uint8_t uart4_deinit(void) {
 #if UART4_RX_DMA
 
     HAL_DMA_Abort(&uart4_dmarx_handle);
-    CSP_FREE(uart4_rx_fifo.recv_buf);
-    CSP_FREE(uart4_rx_fifo.rx_fifo_buf);
-    ring_fifo_destroy(uart4_rx_fifo.rx_fifo);
+    uart_rx_fifo_free(&uart4_rx_fifo);
 
     if (HAL_DMA_DeInit(&uart4_dmarx_handle) != HAL_OK) {
         return UART_DEINIT_DMA_FAIL;
@@ -1576,9 +2592,13 @@ uint8_t uart4_deinit(void) {
 
 #endif /* UART4_RX_DMA */
 
+#if UART4_RX_IT
+    uart_rx_fifo_free(&uart4_rx_fifo);
+#endif /* UART4_RX_IT */
+
 #if UART4_TX_DMA
     HAL_DMA_Abort(&uart4_dmatx_handle);
-    CSP_FREE(uart4_tx_buf.send_buf);
+    uart_tx_buf_free(&uart4_tx_buf);
 
     if (HAL_DMA_DeInit(&uart4_dmatx_handle) != HAL_OK) {
         return UART_DEINIT_DMA_FAIL;
@@ -1586,6 +2606,9 @@ uint8_t uart4_deinit(void) {
 
     HAL_NVIC_DisableIRQ(UART4_TX_DMA_IRQn);
 
+#if USE_HAL_UART_REGISTER_CALLBACKS
+    HAL_UART_UnRegisterCallback(&uart4_handle, HAL_UART_TX_COMPLETE_CB_ID);
+#endif /* USE_HAL_UART_REGISTER_CALLBACKS */
     uart4_handle.hdmatx = NULL;
 #endif /* UART4_TX_DMA */
 
@@ -1615,6 +2638,10 @@ UART_HandleTypeDef uart5_handle = {.Instance = UART5,
                                              .StopBits = UART_STOPBITS_1,
                                              .Parity = UART_PARITY_NONE}};
 
+#if UART_STATS_ENABLE
+static uart_stats_t uart5_stats;
+#endif /* UART_STATS_ENABLE */
+
 #if UART5_RX_DMA
 
 static DMA_HandleTypeDef uart5_dmarx_handle = {
@@ -1628,11 +2655,39 @@ static DMA_HandleTypeDef uart5_dmarx_handle = {
              .PeriphInc = DMA_PINC_DISABLE,
              .Priority = UART5_RX_DMA_PRIORITY}};
 
-static uart_rx_fifo_t uart5_rx_fifo = {.buf_size = UART5_RX_DMA_BUF_SIZE,
-                                        .fifo_size = UART5_RX_DMA_FIFO_SIZE};
+#if UART_STATIC_BUFFER
+static uint8_t uart5_recv_buf[UART5_RX_DMA_BUF_SIZE] UART_RX_BUF_ATTR;
+#if !UART5_RX_DMA_ZERO_COPY
+static uint8_t uart5_rx_fifo_buf[UART5_RX_DMA_FIFO_SIZE] UART_RX_BUF_ATTR;
+#else  /* !UART5_RX_DMA_ZERO_COPY */
+#define uart5_rx_fifo_buf NULL
+#endif /* !UART5_RX_DMA_ZERO_COPY */
+#else  /* UART_STATIC_BUFFER */
+#define uart5_recv_buf    NULL
+#define uart5_rx_fifo_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_rx_fifo_t uart5_rx_fifo = {.recv_buf = uart5_recv_buf,
+                                        .rx_fifo_buf = uart5_rx_fifo_buf,
+                                        .buf_size = UART5_RX_DMA_BUF_SIZE,
+                                        .fifo_size = UART5_RX_DMA_FIFO_SIZE,
+                                        .zero_copy = UART5_RX_DMA_ZERO_COPY};
 
 #endif /* UART5_RX_DMA */
 
+#if UART5_RX_IT
+
+#if UART_STATIC_BUFFER
+static uint8_t uart5_rx_fifo_buf[UART5_RX_IT_FIFO_SIZE] UART_RX_BUF_ATTR;
+#else  /* UART_STATIC_BUFFER */
+#define uart5_rx_fifo_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_rx_fifo_t uart5_rx_fifo = {.rx_fifo_buf = uart5_rx_fifo_buf,
+                                        .fifo_size = UART5_RX_IT_FIFO_SIZE};
+
+#endif /* UART5_RX_IT */
+
 #if UART5_TX_DMA
 
 static DMA_HandleTypeDef uart5_dmatx_handle = {
@@ -1646,9 +2701,30 @@ static DMA_HandleTypeDef uart5_dmatx_handle = {
              .PeriphInc = DMA_PINC_DISABLE,
              .Priority = UART5_TX_DMA_PRIORITY}};
 
-static uart_tx_buf_t uart5_tx_buf = {.buf_size = UART5_TX_DMA_BUF_SIZE};
+#if UART_STATIC_BUFFER
+static uint8_t uart5_send_buf[UART5_TX_DMA_BUF_SIZE * 2] UART_TX_BUF_ATTR;
+#else  /* UART_STATIC_BUFFER */
+#define uart5_send_buf NULL
+#endif /* UART_STATIC_BUFFER */
+
+static uart_tx_buf_t uart5_tx_buf = {.send_buf = uart5_send_buf,
+                                      .buf_size = UART5_TX_DMA_BUF_SIZE};
+
+#endif /* UART5_TX_DMA */
+
+/**
+ * @brief Release the buffers of UART5.
+ *
+ */
+static void uart5_buf_free(void) {
+#if UART5_RX_DMA || UART5_RX_IT
+    uart_rx_fifo_free(&uart5_rx_fifo);
+#endif /* UART5_RX_DMA || UART5_RX_IT */
 
+#if UART5_TX_DMA
+    uart_tx_buf_free(&uart5_tx_buf);
 #endif /* UART5_TX_DMA */
+}
 
 /**
  * @brief UART5 initialization
@@ -1671,13 +2747,25 @@ uint8_t uart5_init(uint32_t baud_rate) {
                                          .Speed = GPIO_SPEED_FREQ_HIGH,
                                          .Mode = GPIO_MODE_AF_PP};
     uart5_handle.Init.BaudRate = baud_rate;
+#if UART_BAUD_PLANNER
+    if (uart_baud_setup(&uart5_handle, baud_rate) != 0) {
+        return UART_INIT_FAIL;
+    }
+#endif /* UART_BAUD_PLANNER */
+
 #if UART5_TX
     uart5_handle.Init.Mode |= UART_MODE_TX;
 
     CSP_GPIO_CLK_ENABLE(UART5_TX_PORT);
     gpio_init_struct.Pin = UART5_TX_PIN;
     gpio_init_struct.Alternate = UART5_TX_GPIO_AF;
+#if (UART5_BUS_MODE == 2)
+    /* Single-wire, receive on TX pin. */
+    uart5_handle.Init.Mode |= UART_MODE_RX;
+    gpio_init_struct.Mode = GPIO_MODE_AF_OD;
+#endif /* UART5_BUS_MODE */
     HAL_GPIO_Init(CSP_GPIO_PORT(UART5_TX_PORT), &gpio_init_struct);
+    gpio_init_struct.Mode = GPIO_MODE_AF_PP;
 #endif /* UART5_TX */
 
 #if UART5_RX
@@ -1699,7 +2787,10 @@ uint8_t uart5_init(uint32_t baud_rate) {
 #endif /* UART5_UART5_CTS */
 
 #if UART5_RTS
+#if (UART5_BUS_MODE != 1)
+    /* RTS pin is DE in RS-485 mode. */
     uart5_handle.Init.HwFlowCtl |= UART_HWCONTROL_RTS;
+#endif /* UART5_BUS_MODE */
 
     CSP_GPIO_CLK_ENABLE(UART5_RTS_PORT);
     gpio_init_struct.Pin = UART5_RTS_PIN;
@@ -1714,26 +2805,13 @@ uint8_t uart5_init(uint32_t baud_rate) {
 #endif /* UART5_IT_ENABLE */
 
 #if UART5_RX_DMA
-    uart5_rx_fifo.head_ptr = 0;
-
-    uart5_rx_fifo.recv_buf = CSP_MALLOC(uart5_rx_fifo.buf_size);
-    if (uart5_rx_fifo.recv_buf == NULL) {
-        return UART_INIT_MEM_FAIL;
-    }
-
-    uart5_rx_fifo.rx_fifo_buf = CSP_MALLOC(uart5_rx_fifo.fifo_size);
-    if (uart5_rx_fifo.rx_fifo_buf == NULL) {
-        return UART_INIT_MEM_FAIL;
-    }
-
-    uart5_rx_fifo.rx_fifo = ring_fifo_init(
-        uart5_rx_fifo.rx_fifo_buf, uart5_rx_fifo.fifo_size, RF_TYPE_STREAM);
-    if (uart5_rx_fifo.rx_fifo == NULL) {
+    if (uart_rx_fifo_alloc(&uart5_rx_fifo, 1) != 0) {
         return UART_INIT_MEM_FAIL;
     }
 
     CSP_DMA_CLK_ENABLE(UART5_RX_DMA_NUMBER);
     if (HAL_DMA_Init(&uart5_dmarx_handle) != HAL_OK) {
+        uart5_buf_free();
         return UART_INIT_DMA_FAIL;
     }
 
@@ -1745,14 +2823,21 @@ uint8_t uart5_init(uint32_t baud_rate) {
 
 #endif /* UART5_RX_DMA */
 
+#if UART5_RX_IT
+    if (uart_rx_fifo_alloc(&uart5_rx_fifo, 0) != 0) {
+        return UART_INIT_MEM_FAIL;
+    }
+#endif /* UART5_RX_IT */
+
 #if UART5_TX_DMA
-    uart5_tx_buf.send_buf = CSP_MALLOC(uart5_tx_buf.buf_size);
-    if (uart5_tx_buf.send_buf == NULL) {
+    if (uart_tx_buf_alloc(&uart5_tx_buf) != 0) {
+        uart5_buf_free();
         return UART_INIT_MEM_FAIL;
     }
 
     CSP_DMA_CLK_ENABLE(UART5_TX_DMA_NUMBER);
     if (HAL_DMA_Init(&uart5_dmatx_handle) != HAL_OK) {
+        uart5_buf_free();
         return UART_INIT_DMA_FAIL;
     }
 
@@ -1763,11 +2848,44 @@ uint8_t uart5_init(uint32_t baud_rate) {
     HAL_NVIC_EnableIRQ(UART5_TX_DMA_IRQn);
 #endif /* UART5_TX_DMA */
 
+#if (UART5_BUS_MODE == 1)
+    if (HAL_RS485Ex_Init(&uart5_handle, UART_DE_POLARITY_HIGH,
+                         UART5_DE_ASSERT_TIME,
+                         UART5_DE_DEASSERT_TIME) != HAL_OK) {
+        uart5_buf_free();
+        return UART_INIT_FAIL;
+    }
+#elif (UART5_BUS_MODE == 2)
+    if (HAL_HalfDuplex_Init(&uart5_handle) != HAL_OK) {
+        uart5_buf_free();
+        return UART_INIT_FAIL;
+    }
+#else  /* UART5_BUS_MODE */
     if (HAL_UART_Init(&uart5_handle) != HAL_OK) {
+        uart5_buf_free();
         return UART_INIT_FAIL;
     }
+#endif /* UART5_BUS_MODE */
     
+#if UART5_FIFO_ENABLE
+    HAL_UARTEx_SetTxFifoThreshold(&uart5_handle, UART5_TX_FIFO_THRESHOLD);
+    HAL_UARTEx_SetRxFifoThreshold(&uart5_handle, UART5_RX_FIFO_THRESHOLD);
+    HAL_UARTEx_EnableFifoMode(&uart5_handle);
+#else  /* UART5_FIFO_ENABLE */
     HAL_UARTEx_DisableFifoMode(&uart5_handle);
+#endif /* UART5_FIFO_ENABLE */
+
+#if UART5_MUTE_MODE
+    if (uart_mute_config(&uart5_handle, UART5_MUTE_WAKEUP,
+                         UART5_MUTE_ADDR_7BIT, UART5_MUTE_ADDRESS) != 0) {
+        uart5_buf_free();
+        return UART_INIT_FAIL;
+    }
+#endif /* UART5_MUTE_MODE */
+
+#if UART5_CHAR_MATCH
+    uart_set_match_char(&uart5_handle, UART5_MATCH_CHAR);
+#endif /* UART5_CHAR_MATCH */
     
 #if UART5_RX_DMA
     __HAL_UART_ENABLE_IT(&uart5_handle, UART_IT_IDLE);
@@ -1783,6 +2901,27 @@ uint8_t uart5_init(uint32_t baud_rate) {
                               uart_dmarx_done_callback);
 #endif /* USE_HAL_UART_REGISTER_CALLBACKS */
 #endif /* UART5_RX_DMA */
+
+#if UART5_RX_IT
+#if UART5_FIFO_ENABLE
+    /* Drain a threshold level per interrupt, the rest at line idle. */
+    __HAL_UART_CLEAR_IDLEFLAG(&uart5_handle);
+    __HAL_UART_ENABLE_IT(&uart5_handle, UART_IT_IDLE);
+    __HAL_UART_ENABLE_IT(&uart5_handle, UART_IT_RXFT);
+#else  /* UART5_FIFO_ENABLE */
+    __HAL_UART_ENABLE_IT(&uart5_handle, UART_IT_RXNE);
+#endif /* UART5_FIFO_ENABLE */
+    __HAL_UART_ENABLE_IT(&uart5_handle, UART_IT_ERR);
+#endif /* UART5_RX_IT */
+
+#if UART5_TX_DMA && USE_HAL_UART_REGISTER_CALLBACKS
+    HAL_UART_RegisterCallback(&uart5_handle, HAL_UART_TX_COMPLETE_CB_ID,
+                              uart_dmatx_done_callback);
+#endif /* UART5_TX_DMA && USE_HAL_UART_REGISTER_CALLBACKS */
+
+#if UART5_STDIO
+    uart_stdio_init();
+#endif /* UART5_STDIO */
     return UART_INIT_OK;
 }
 
@@ -1793,6 +2932,26 @@ uint8_t uart5_init(uint32_t baud_rate) {
  *
  */
 void UART5_IRQHandler(void) {
+#if UART5_RX_IT
+    uart_rx_irq_handler(&uart5_handle);
+#endif /* UART5_RX_IT */
+
+#if UART5_RX_DMA
+    uart_dmarx_error_handler(&uart5_handle);
+#endif /* UART5_RX_DMA */
+
+    if (__HAL_UART_GET_FLAG(&uart5_handle, UART_FLAG_RTOF)) {
+        /* Handle before HAL, which takes it as an error. */
+        __HAL_UART_CLEAR_FLAG(&uart5_handle, UART_CLEAR_RTOF);
+        uart_rx_timeout_callback(&uart5_handle);
+    }
+
+    if (__HAL_UART_GET_FLAG(&uart5_handle, UART_FLAG_CMF)) {
+        /* Also set by `uart_set_match_char()` at run time. */
+        __HAL_UART_CLEAR_FLAG(&uart5_handle, UART_CLEAR_CMF);
+        uart_dmarx_match_callback(&uart5_handle);
+    }
+
     if (__HAL_UART_GET_FLAG(&uart5_handle, UART_FLAG_IDLE)) {
         __HAL_UART_CLEAR_IDLEFLAG(&uart5_handle);
         uart_dmarx_idle_callback(&uart5_handle);
@@ -1866,9 +3025,7 @@ uint8_t uart5_deinit(void) {
 #if UART5_RX_DMA
 
     HAL_DMA_Abort(&uart5_dmarx_handle);
-    CSP_FREE(uart5_rx_fifo.recv_buf);
-    CSP_FREE(uart5_rx_fifo.rx_fifo_buf);
-    ring_fifo_destroy(uart5_rx_fifo.rx_fifo);
+    uart_rx_fifo_free(&uart5_rx_fifo);
 
     if (HAL_DMA_DeInit(&uart5_dmarx_handle) != HAL_OK) {
         return UART_DEINIT_DMA_FAIL;
@@ -1884,9 +3041,13 @@ uint8_t uart5_deinit(void) {
 
 #endif /* UART5_RX_DMA */
 
+#if UART5_RX_IT
+    uart_rx_fifo_free(&uart5_rx_fifo);
+#endif /* UART5_RX_IT */
+
 #if UART5_TX_DMA
     HAL_DMA_Abort(&uart5_dmatx_handle);
-    CSP_FREE(uart5_tx_buf.send_buf);
+    uart_tx_buf_free(&uart5_tx_buf);
 
     if (HAL_DMA_DeInit(&uart5_dmatx_handle) != HAL_OK) {
         return UART_DEINIT_DMA_FAIL;
@@ -1894,6 +3055,9 @@ uint8_t uart5_deinit(void) {
 
     HAL_NVIC_DisableIRQ(UART5_TX_DMA_IRQn);
 
+#if USE_HAL_UART_REGISTER_CALLBACKS
+    HAL_UART_UnRegisterCallback(&uart5_handle, HAL_UART_TX_COMPLETE_CB_ID);
+#endif /* USE_HAL_UART_REGISTER_CALLBACKS */
     uart5_handle.hdmatx = NULL;
 #endif /* UART5_TX_DMA */
 
@@ -1910,18 +3074,516 @@ uint8_t uart5_deinit(void) {
  * @}
  */ 
 
+/*****************************************************************************
+ * @defgroup UART compact formatter.
+ * @{
+ */
+
+#if UART_PRINTF_COMPACT
+
+#define UART_VSNPRINTF uart_vsnprintf
+
+#define UART_FMT_LEFT  (1U << 0) /*!< '-': Left justify.            */
+#define UART_FMT_PLUS  (1U << 1) /*!< '+': Always print the sign.   */
+#define UART_FMT_SPACE (1U << 2) /*!< ' ': Space for positive sign. */
+#define UART_FMT_ZERO  (1U << 3) /*!< '0': Pad with zeros.          */
+#define UART_FMT_ALT   (1U << 4) /*!< '#': Base prefix of x X o.    */
+
+/* Fraction digits of %f that are computed, the rest are zeros. */
+#define UART_FMT_FLOAT_DIGITS 9
+
+/**
+ * @brief Output of the formatter.
+ */
+typedef struct {
+    char *buf;   /*!< Output buf.                               */
+    size_t size; /*!< Size of output buf.                       */
+    size_t pos;  /*!< Length that would have been written.      */
+} uart_fmt_out_t;
+
+/**
+ * @brief Put a character to the output, drop it if the buf is full.
+ *
+ * @param out The output.
+ * @param c The character.
+ */
+static inline void uart_fmt_putc(uart_fmt_out_t *out, char c) {
+    if (out->pos + 1 < out->size) {
+        out->buf[out->pos] = c;
+    }
+    ++out->pos;
+}
+
+/**
+ * @brief Put a character several times.
+ *
+ * @param out The output.
+ * @param c The character.
+ * @param n Repeat times.
+ */
+static void uart_fmt_fill(uart_fmt_out_t *out, char c, int n) {
+    while (n-- > 0) {
+        uart_fmt_putc(out, c);
+    }
+}
+
+/**
+ * @brief Put a field with padding.
+ *
+ * @param out The output.
+ * @param prefix Sign or base prefix, can be empty.
+ * @param body The digits or string.
+ * @param len The length of body.
+ * @param zeros The zeros between prefix and body (precision of integer).
+ * @param width The minimum width of the field.
+ * @param flags The format flags.
+ */
+static void uart_fmt_field(uart_fmt_out_t *out, const char *prefix,
+                           const char *body, int len, int zeros, int width,
+                           uint8_t flags) {
+    int prefix_len = (int)strlen(prefix);
+    int pad = width - prefix_len - zeros - len;
+
+    if (((flags & UART_FMT_LEFT) == 0) && ((flags & UART_FMT_ZERO) == 0)) {
+        uart_fmt_fill(out, ' ', pad);
+    }
+
+    while (*prefix) {
+        uart_fmt_putc(out, *prefix++);
+    }
+
+    if (((flags & UART_FMT_LEFT) == 0) && (flags & UART_FMT_ZERO)) {
+        uart_fmt_fill(out, '0', pad);
+    }
+
+    uart_fmt_fill(out, '0', zeros);
+
+    while (len-- > 0) {
+        uart_fmt_putc(out, *body++);
+    }
+
+    if (flags & UART_FMT_LEFT) {
+        uart_fmt_fill(out, ' ', pad);
+    }
+}
+
+/**
+ * @brief Convert unsigned integer to digits.
+ *
+ * @param[out] buf The buf, must be large enough for 64-bit octal.
+ * @param value The value.
+ * @param base 8, 10 or 16.
+ * @param upper Use upper case hex digits.
+ * @return The number of digits.
+ */
+static int uart_fmt_utoa(char *buf, unsigned long long value, unsigned base,
+                         uint8_t upper) {
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char tmp[24];
+    int len = 0, i;
+
+    do {
+        tmp[len++] = digits[value % base];
+        value /= base;
+    } while (value != 0);
+
+    for (i = 0; i < len; ++i) {
+        buf[i] = tmp[len - 1 - i];
+    }
+
+    return len;
+}
+
+/**
+ * @brief Compact replacement of `vsnprintf`.
+ *
+ * @param buf The output buf.
+ * @param size The size of output buf.
+ * @param __format The string with format.
+ * @param ap The arguments.
+ * @return The number of characters that would have been written in the
+ *         array, not counting the terminating null character.
+ * @note The output is the same as `vsnprintf` for this subset:
+ *       - conversions d i u x X o c s p % and f F,
+ *       - flags - + space 0 #, width and precision (also `*`),
+ *       - length hh h l ll z.
+ *       %f is fixed-point: up to `UART_FMT_FLOAT_DIGITS` fraction digits are
+ *       computed, a larger precision is padded with zeros. Values of 2^64
+ *       and more print "inf". %e E g G a A take the double argument and
+ *       print the specifier as is, other conversions (n, L j t lengths)
+ *       are printed as is without taking an argument.
+ */
+static int uart_vsnprintf(char *buf, size_t size, const char *__format,
+                          va_list ap) {
+    uart_fmt_out_t out = {.buf = buf, .size = size, .pos = 0};
+    char num[48];
+    const char *prefix;
+    uint8_t flags;
+    int width, precision, length, len;
+
+    while (*__format) {
+        if (*__format != '%') {
+            uart_fmt_putc(&out, *__format++);
+            continue;
+        }
+        ++__format;
+
+        /* Flags. */
+        flags = 0;
+        for (;; ++__format) {
+            if (*__format == '-') {
+                flags |= UART_FMT_LEFT;
+            } else if (*__format == '+') {
+                flags |= UART_FMT_PLUS;
+            } else if (*__format == ' ') {
+                flags |= UART_FMT_SPACE;
+            } else if (*__format == '0') {
+                flags |= UART_FMT_ZERO;
+            } else if (*__format == '#') {
+                flags |= UART_FMT_ALT;
+            } else {
+                break;
+            }
+        }
+
+        /* Width. */
+        width = 0;
+        if (*__format == '*') {
+            width = va_arg(ap, int);
+            if (width < 0) {
+                flags |= UART_FMT_LEFT;
+                width = -width;
+            }
+            ++__format;
+        }
+        while ((*__format >= '0') && (*__format <= '9')) {
+            width = width * 10 + (*__format++ - '0');
+        }
+
+        /* Precision. */
+        precision = -1;
+        if (*__format == '.') {
+            ++__format;
+            precision = 0;
+            if (*__format == '*') {
+                precision = va_arg(ap, int);
+                ++__format;
+            }
+            while ((*__format >= '0') && (*__format <= '9')) {
+                precision = precision * 10 + (*__format++ - '0');
+            }
+        }
+
+        /* Length: -2: char, -1: short, 0: int, 1: long, 2: long long,
+         * 3: size_t. */
+        length = 0;
+        while ((*__format == 'h') || (*__format == 'l') || (*__format == 'z')) {
+            if (*__format == 'l') {
+                ++length;
+            } else if (*__format == 'h') {
+                --length;
+            } else if (*__format == 'z') {
+                length = 3;
+            }
+            ++__format;
+        }
+
+        prefix = "";
+        switch (*__format) {
+            case 'd':
+            case 'i': {
+                long long value;
+                unsigned long long abs_value;
+
+                if (length == 1) {
+                    value = va_arg(ap, long);
+                } else if (length == 2) {
+                    value = va_arg(ap, long long);
+                } else if (length == 3) {
+                    value = (long long)va_arg(ap, size_t);
+                } else if (length == -1) {
+                    value = (short)va_arg(ap, int);
+                } else if (length == -2) {
+                    value = (signed char)va_arg(ap, int);
+                } else {
+                    value = va_arg(ap, int);
+                }
+
+                if (value < 0) {
+                    prefix = "-";
+                    abs_value = 0ULL - (unsigned long long)value;
+                } else {
+                    prefix = (flags & UART_FMT_PLUS)    ? "+"
+                             : (flags & UART_FMT_SPACE) ? " "
+                                                        : "";
+                    abs_value = (unsigned long long)value;
+                }
+
+                len = ((precision == 0) && (abs_value == 0))
+                          ? 0
+                          : uart_fmt_utoa(num, abs_value, 10, 0);
+                if (precision >= 0) {
+                    flags &= ~UART_FMT_ZERO;
+                }
+                uart_fmt_field(&out, prefix, num, len,
+                               (precision > len) ? (precision - len) : 0,
+                               width, flags);
+            } break;
+
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'p': {
+                unsigned long long value;
+                unsigned base = 10;
+
+                if (*__format == 'p') {
+                    value = (uintptr_t)va_arg(ap, void *);
+                    prefix = "0x";
+                    base = 16;
+                } else {
+                    if (length == 1) {
+                        value = va_arg(ap, unsigned long);
+                    } else if (length == 2) {
+                        value = va_arg(ap, unsigned long long);
+                    } else if (length == 3) {
+                        value = va_arg(ap, size_t);
+                    } else if (length == -1) {
+                        value = (unsigned short)va_arg(ap, unsigned int);
+                    } else if (length == -2) {
+                        value = (unsigned char)va_arg(ap, unsigned int);
+                    } else {
+                        value = va_arg(ap, unsigned int);
+                    }
+
+                    if ((*__format == 'x') || (*__format == 'X')) {
+                        base = 16;
+                        if ((flags & UART_FMT_ALT) && (value != 0)) {
+                            prefix = (*__format == 'x') ? "0x" : "0X";
+                        }
+                    } else if (*__format == 'o') {
+                        base = 8;
+                    }
+                }
+
+                len = ((precision == 0) && (value == 0))
+                          ? 0
+                          : uart_fmt_utoa(num, value, base, *__format == 'X');
+                if (precision >= 0) {
+                    flags &= ~UART_FMT_ZERO;
+                }
+                if ((base == 8) && (flags & UART_FMT_ALT) &&
+                    ((len == 0) || (num[0] != '0')) && (precision <= len)) {
+                    /* The leading zero of octal. */
+                    precision = len + 1;
+                }
+                uart_fmt_field(&out, prefix, num, len,
+                               (precision > len) ? (precision - len) : 0,
+                               width, flags);
+            } break;
+
+            case 'f':
+            case 'F': {
+                double value = va_arg(ap, double);
+                unsigned long long int_part, frac_part, scale = 1;
+                int i, extra = 0;
+
+                if (precision < 0) {
+                    precision = UART_PRINTF_FLOAT_PRECISION;
+                } else if (precision > UART_FMT_FLOAT_DIGITS) {
+                    extra = precision - UART_FMT_FLOAT_DIGITS;
+                    precision = UART_FMT_FLOAT_DIGITS;
+                }
+
+                if (value < 0) {
+                    prefix = "-";
+                    value = -value;
+                } else {
+                    prefix = (flags & UART_FMT_PLUS)    ? "+"
+                             : (flags & UART_FMT_SPACE) ? " "
+                                                        : "";
+                }
+
+                if (value != value) {
+                    uart_fmt_field(&out, "", "nan", 3, 0, width,
+                                   flags & ~UART_FMT_ZERO);
+                    break;
+                }
+
+                if (value >= 18446744073709551615.0) {
+                    /* Out of the fixed-point range, including inf. */
+                    uart_fmt_field(&out, prefix, "inf", 3, 0, width,
+                                   flags & ~UART_FMT_ZERO);
+                    break;
+                }
+
+                for (i = 0; i < precision; ++i) {
+                    scale *= 10;
+                }
+
+                int_part = (unsigned long long)value;
+                frac_part = (unsigned long long)((value - (double)int_part) *
+                                                     (double)scale +
+                                                 0.5);
+                if (frac_part >= scale) {
+                    /* Carry of rounding. */
+                    ++int_part;
+                    frac_part -= scale;
+                }
+
+                len = uart_fmt_utoa(num, int_part, 10, 0);
+                if ((precision > 0) || (flags & UART_FMT_ALT)) {
+                    num[len++] = '.';
+                }
+                if (precision > 0) {
+                    i = uart_fmt_utoa(num + len, frac_part, 10, 0);
+                    /* Leading zeros of fraction part. */
+                    memmove(num + len + precision - i, num + len, i);
+                    memset(num + len, '0', precision - i);
+                    len += precision;
+                }
+
+                if (extra == 0) {
+                    uart_fmt_field(&out, prefix, num, len, 0, width, flags);
+                } else if (flags & UART_FMT_LEFT) {
+                    /* The digits that are not computed, then the padding. */
+                    uart_fmt_field(&out, prefix, num, len, 0, 0, flags);
+                    uart_fmt_fill(&out, '0', extra);
+                    uart_fmt_fill(&out, ' ',
+                                  width - (int)strlen(prefix) - len - extra);
+                } else {
+                    uart_fmt_field(&out, prefix, num, len, 0, width - extra,
+                                   flags);
+                    uart_fmt_fill(&out, '0', extra);
+                }
+            } break;
+
+            case 'c': {
+                num[0] = (char)va_arg(ap, int);
+                uart_fmt_field(&out, "", num, 1, 0, width,
+                               flags & ~UART_FMT_ZERO);
+            } break;
+
+            case 's': {
+                const char *str = va_arg(ap, const char *);
+
+                if (str == NULL) {
+                    str = "(null)";
+                }
+
+                for (len = 0; str[len] && ((precision < 0) || (len < precision));
+                     ++len) {
+                }
+                uart_fmt_field(&out, "", str, len, 0, width,
+                               flags & ~UART_FMT_ZERO);
+            } break;
+
+            case '%': {
+                uart_fmt_putc(&out, '%');
+            } break;
+
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A': {
+                /* Not supported, keep the next arguments in place. */
+                (void)va_arg(ap, double);
+                uart_fmt_putc(&out, '%');
+                uart_fmt_putc(&out, *__format);
+            } break;
+
+            case '\0': {
+                /* Incomplete specifier at the end. */
+                --__format;
+            } break;
+
+            default: {
+                /* Unsupported specifier, print it as is. */
+                uart_fmt_putc(&out, '%');
+                uart_fmt_putc(&out, *__format);
+            } break;
+        }
+        ++__format;
+    }
+
+    if (size != 0) {
+        buf[(out.pos < size) ? out.pos : (size - 1)] = '\0';
+    }
+
+    return (int)out.pos;
+}
+
+#else /* UART_PRINTF_COMPACT */
+
+#define UART_VSNPRINTF vsnprintf
+
+#endif /* UART_PRINTF_COMPACT */
+
+/**
+ * @}
+ */
+
 /*****************************************************************************
  * @defgroup Public UART functions.
  * @{
  */
 
+/**
+ * @brief Transmit without DMA.
+ *
+ * @param huart The handle of UART.
+ * @param buf The data to transmit.
+ * @param len The length of data.
+ * @param timeout Timeout in ms.
+ * @return HAL status.
+ * @note If the hardware FIFO is enabled, the FIFO is refilled by interrupt a
+ *       threshold level at a time and the CPU sleeps until it finishes.
+ *       Otherwise (or in interrupt) it is transmitted by polling.
+ */
+static HAL_StatusTypeDef uart_transmit(UART_HandleTypeDef *huart,
+                                       const uint8_t *buf, uint16_t len,
+                                       uint32_t timeout) {
+    uint32_t start = HAL_GetTick();
+    HAL_StatusTypeDef res = HAL_OK;
+
+    uart_bus_rx_suspend(huart);
+
+    if ((huart->FifoMode != UART_FIFOMODE_ENABLE) || (__get_IPSR() != 0)) {
+        res = HAL_UART_Transmit(huart, buf, len, timeout);
+    } else if (HAL_UART_Transmit_IT(huart, buf, len) != HAL_OK) {
+        res = HAL_BUSY;
+    } else {
+        while (huart->gState != HAL_UART_STATE_READY) {
+            if (HAL_GetTick() - start >= timeout) {
+                HAL_UART_AbortTransmit_IT(huart);
+                res = HAL_TIMEOUT;
+                break;
+            }
+            __WFI();
+        }
+    }
+
+    uart_bus_rx_resume(huart);
+
+    return res;
+}
+
 /**
  * @brief Formatted print to the UART.
  *
  * @param huart The handle of UART.
  * @param __format The string with format.
- * @return The number of characters that would have been written in the
- *         array, not counting the terminating null character.
+ * @return The number of characters that are written to the transmit buffer.
+ * @note With DMA Tx, the string is formatted into the transmit buffer of this
+ *       UART directly and the function returns without waiting for the
+ *       transfer. A full buffer is handled by `UART_PRINTF_FULL_POLICY`.
+ *       Calling it from an interrupt which preempts another writer of the
+ *       same UART drops the string.
+ *       Without DMA Tx, the string is formatted on the stack and sent in
+ *       blocking mode.
  */
 int uart_printf(UART_HandleTypeDef *huart, const char *__format, ...) {
     int len;
@@ -1932,18 +3594,29 @@ int uart_printf(UART_HandleTypeDef *huart, const char *__format, ...) {
         return 0;
     }
 
-    /* Wait for last transfer end. */
-    while (__HAL_UART_GET_FLAG(huart, UART_FLAG_TC) == RESET)
-        ;
+    if (huart->hdmatx != NULL) {
+        va_start(ap, __format);
+        len = uart_dmatx_vprintf(huart, __format, ap);
+        va_end(ap);
+        return len;
+    }
+
+    char buf[UART_FORMAT_BUF_SIZE];
 
     va_start(ap, __format);
-    len = vsnprintf(uart_buffer, sizeof(uart_buffer), __format, ap);
+    len = UART_VSNPRINTF(buf, sizeof(buf), __format, ap);
     va_end(ap);
 
-    if (huart->hdmatx != NULL) {
-        HAL_UART_Transmit_DMA(huart, (uint8_t *)uart_buffer, len);
-    } else {
-        HAL_UART_Transmit(huart, (uint8_t *)uart_buffer, len, 1000);
+    if (len < 0) {
+        return 0;
+    }
+
+    if (len >= (int)sizeof(buf)) {
+        len = sizeof(buf) - 1;
+    }
+
+    if (uart_transmit(huart, (uint8_t *)buf, len, 1000) == HAL_OK) {
+        UART_STATS_ADD(huart, tx_bytes, len);
     }
 
     return len;
@@ -1960,6 +3633,7 @@ int uart_printf(UART_HandleTypeDef *huart, const char *__format, ...) {
  *         even zero, in the event of an early matching failure.
  */
 int uart_scanf(UART_HandleTypeDef *huart, const char *__format, ...) {
+    char buf[UART_FORMAT_BUF_SIZE];
     uint16_t str_len = 0;
     int res;
     va_list ap;
@@ -1969,17 +3643,18 @@ int uart_scanf(UART_HandleTypeDef *huart, const char *__format, ...) {
         return 0;
     }
 
-    if (huart->hdmarx != NULL) {
-        while (str_len == 0) {
-            str_len = uart_dmarx_read(huart, uart_buffer, sizeof(uart_buffer));
-        }
+    if (uart_rx_identify(huart) != NULL) {
+        /* Wait for a whole line, the rest is kept in the fifo. */
+        str_len = uart_dmarx_read_timeout(huart, buf, sizeof(buf) - 1,
+                                          sizeof(buf) - 1, '\n', HAL_MAX_DELAY);
     } else {
-        HAL_UARTEx_ReceiveToIdle(huart, (uint8_t *)uart_buffer,
-                                 sizeof(uart_buffer), &str_len, 0xFFFF);
+        HAL_UARTEx_ReceiveToIdle(huart, (uint8_t *)buf, sizeof(buf) - 1,
+                                 &str_len, 0xFFFF);
     }
+    buf[str_len] = '\0';
 
     va_start(ap, __format);
-    res = vsscanf((char *)uart_buffer, __format, ap);
+    res = vsscanf(buf, __format, ap);
     va_end(ap);
 
     return res;
@@ -1990,53 +3665,470 @@ int uart_scanf(UART_HandleTypeDef *huart, const char *__format, ...) {
  */
 
 /*****************************************************************************
- * @defgroup Public UART DMA Rx functions.
+ * @defgroup Public UART mute mode and character match functions.
  * @{
  */
 
 /**
- * @brief Identify the UART receive fifo by handle.
+ * @brief Configure the mute mode and mute the receiver.
  *
  * @param huart The handle of UART
- * @return The point of UART rx fifo.
+ * @param idle_line Wake up on idle line instead of address mark.
+ * @param addr_7bit Use 7-bit address instead of 4-bit.
+ * @param address The node address.
+ * @return Config message:
+ *  @retval - 0: Success
+ *  @retval - 1: The UART does not become ready.
+ *  @retval - 2: Parameter error, address is out of range.
+ * @note `*_init` calls it with `*_MUTE_xxx`, call it to change the node
+ *       address at run time. It works with every bus mode. With 7-bit
+ *       address and 8-bit word the MSB of each byte is the address mark,
+ *       use 9-bit word to send 8-bit data.
  */
-static inline uart_rx_fifo_t *uart_rx_identify(UART_HandleTypeDef *huart) {
+uint8_t uart_mute_config(UART_HandleTypeDef *huart, uint8_t idle_line,
+                         uint8_t addr_7bit, uint8_t address) {
+    if (address > (addr_7bit ? 0x7F : 0x0F)) {
+        return 2;
+    }
 
-    switch ((uintptr_t)huart->Instance) {
-#if LPUART1_RX_DMA
-        case LPUART1_BASE: {
-            return &lpuart1_rx_fifo;
-        }
-#endif /* LPUART1_RX_DMA */
+    __HAL_UART_DISABLE(huart);
 
-#if USART1_RX_DMA
-        case USART1_BASE: {
-            return &usart1_rx_fifo;
-        }
-#endif /* USART1_RX_DMA */
+    MODIFY_REG(huart->Instance->CR1, USART_CR1_WAKE,
+               idle_line ? UART_WAKEUPMETHOD_IDLELINE
+                         : UART_WAKEUPMETHOD_ADDRESSMARK);
+    MODIFY_REG(huart->Instance->CR2, USART_CR2_ADDM7 | USART_CR2_ADD,
+               (addr_7bit ? UART_ADDRESS_DETECT_7B : UART_ADDRESS_DETECT_4B) |
+                   ((uint32_t)address << UART_CR2_ADDRESS_LSB_POS));
 
-#if USART2_RX_DMA
-        case USART2_BASE: {
-            return &usart2_rx_fifo;
+    __HAL_UART_ENABLE(huart);
+
+    if (HAL_MultiProcessor_EnableMuteMode(huart) != HAL_OK) {
+        return 1;
+    }
+
+    HAL_MultiProcessor_EnterMuteMode(huart);
+
+    return 0;
+}
+
+/**
+ * @brief Set the character to match, the received data is delivered as soon
+ *        as it arrives.
+ *
+ * @param huart The handle of UART
+ * @param match_char The character, -1 to disable.
+ * @return Set message:
+ *  @retval - 0: Success
+ *  @retval - 1: Parameter error.
+ * @note It shares the address register with address mark mute mode.
+ */
+uint8_t uart_set_match_char(UART_HandleTypeDef *huart, int match_char) {
+    if (match_char > 0xFF) {
+        return 1;
+    }
+
+    __HAL_UART_DISABLE_IT(huart, UART_IT_CM);
+
+    if (match_char < 0) {
+        return 0;
+    }
+
+    __HAL_UART_DISABLE(huart);
+    /* 7-bit address detection to compare all the 8 bits. */
+    MODIFY_REG(huart->Instance->CR2, USART_CR2_ADDM7 | USART_CR2_ADD,
+               UART_ADDRESS_DETECT_7B |
+                   ((uint32_t)match_char << UART_CR2_ADDRESS_LSB_POS));
+    __HAL_UART_ENABLE(huart);
+
+    __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_CMF);
+    __HAL_UART_ENABLE_IT(huart, UART_IT_CM);
+
+    return 0;
+}
+
+/**
+ * @brief Mute the receiver until the next frame for this node.
+ *
+ * @param huart The handle of UART
+ * @return Mute message:
+ *  @retval - 0: Success
+ *  @retval - 1: Mute mode is not enabled on this uart.
+ * @note Needed in idle line wakeup, after the application finds the frame
+ *       is not for it. In address mark wakeup the hardware mutes itself.
+ */
+uint8_t uart_mute(UART_HandleTypeDef *huart) {
+    if (READ_BIT(huart->Instance->CR1, USART_CR1_MME) == 0) {
+        return 1;
+    }
+
+    HAL_MultiProcessor_EnterMuteMode(huart);
+
+    return 0;
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup Public UART baud rate functions.
+ * @{
+ */
+
+/**
+ * @brief Divider of `UART_PRESCALER_DIVx`.
+ */
+static const uint16_t uart_prescaler_div[] = {1,  2,  4,  6,   8,   10,
+                                              12, 16, 32, 64, 128, 256};
+
+/**
+ * @brief Get the frequency of kernel clock source.
+ *
+ * @param huart The handle of UART
+ * @param clock_source `UART_CLOCK_xxx`.
+ * @return The frequency, 0 if the clock is not ready.
+ */
+static uint32_t uart_kernel_clock(UART_HandleTypeDef *huart,
+                                  uint8_t clock_source) {
+    switch (clock_source) {
+        case UART_CLOCK_PCLK: {
+            return (huart->Instance == USART1) ? HAL_RCC_GetPCLK2Freq()
+                                               : HAL_RCC_GetPCLK1Freq();
         }
-#endif /* USART2_RX_DMA */
-#if USART3_RX_DMA
+
+        case UART_CLOCK_SYSCLK: {
+            return HAL_RCC_GetSysClockFreq();
+        }
+
+        case UART_CLOCK_HSI: {
+            return __HAL_RCC_GET_FLAG(RCC_FLAG_HSIRDY) ? HSI_VALUE : 0;
+        }
+
+        case UART_CLOCK_LSE: {
+            return __HAL_RCC_GET_FLAG(RCC_FLAG_LSERDY) ? LSE_VALUE : 0;
+        }
+
+        default: {
+        } break;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Select the kernel clock source of UART.
+ *
+ * @param huart The handle of UART
+ * @param clock_source `UART_CLOCK_xxx`.
+ */
+static void uart_set_clock_source(UART_HandleTypeDef *huart,
+                                  uint8_t clock_source) {
+#define UART_CLOCK_SOURCE(name, pclk)                                          \
+    ((clock_source == UART_CLOCK_SYSCLK) ? RCC_##name##CLKSOURCE_SYSCLK        \
+     : (clock_source == UART_CLOCK_HSI)  ? RCC_##name##CLKSOURCE_HSI           \
+     : (clock_source == UART_CLOCK_LSE)  ? RCC_##name##CLKSOURCE_LSE           \
+                                         : RCC_##name##CLKSOURCE_##pclk)
+
+    switch ((uintptr_t)huart->Instance) {
+#if LPUART1_ENABLE
+        case LPUART1_BASE: {
+            __HAL_RCC_LPUART1_CONFIG(UART_CLOCK_SOURCE(LPUART1, PCLK1));
+        } break;
+#endif /* LPUART1_ENABLE */
+
+#if USART1_ENABLE
+        case USART1_BASE: {
+            __HAL_RCC_USART1_CONFIG(UART_CLOCK_SOURCE(USART1, PCLK2));
+        } break;
+#endif /* USART1_ENABLE */
+
+#if USART2_ENABLE
+        case USART2_BASE: {
+            __HAL_RCC_USART2_CONFIG(UART_CLOCK_SOURCE(USART2, PCLK1));
+        } break;
+#endif /* USART2_ENABLE */
+
+#if USART3_ENABLE
         case USART3_BASE: {
-            return &usart3_rx_fifo;
+            __HAL_RCC_USART3_CONFIG(UART_CLOCK_SOURCE(USART3, PCLK1));
+        } break;
+#endif /* USART3_ENABLE */
+
+#if UART4_ENABLE
+        case UART4_BASE: {
+            __HAL_RCC_UART4_CONFIG(UART_CLOCK_SOURCE(UART4, PCLK1));
+        } break;
+#endif /* UART4_ENABLE */
+
+#if UART5_ENABLE
+        case UART5_BASE: {
+            __HAL_RCC_UART5_CONFIG(UART_CLOCK_SOURCE(UART5, PCLK1));
+        } break;
+#endif /* UART5_ENABLE */
+
+        default: {
+        } break;
+    }
+
+#undef UART_CLOCK_SOURCE
+}
+
+/**
+ * @brief Search the settings with the lowest error of baud rate.
+ *
+ * @param huart The handle of UART
+ * @param baud_rate The required baud rate.
+ * @param[out] plan The best settings.
+ * @return Plan message:
+ *  @retval - 0: Success
+ *  @retval - 1: The error is larger than `UART_BAUD_MAX_ERROR`.
+ *  @retval - 2: Parameter error.
+ * @note All ready kernel clock sources and prescalers are searched, with
+ *       16x and 8x oversampling (8x is USART only). On the same error the
+ *       16x oversampling, PCLK and the smaller prescaler is preferred.
+ *       Nothing is changed, use `uart_set_baud` to apply it.
+ */
+uint8_t uart_baud_plan(UART_HandleTypeDef *huart, uint32_t baud_rate,
+                       uart_baud_plan_t *plan) {
+    uint8_t lpuart, source, over8, presc;
+    uint64_t clock, div, actual, best = UINT64_MAX;
+    int64_t error;
+
+    if ((plan == NULL) || (baud_rate == 0)) {
+        return 2;
+    }
+
+    lpuart = IS_LPUART_INSTANCE(huart->Instance) ? 1 : 0;
+
+    for (over8 = 0; over8 <= (lpuart ? 0 : 1); ++over8) {
+        for (source = UART_CLOCK_PCLK; source <= UART_CLOCK_LSE; ++source) {
+            clock = uart_kernel_clock(huart, source);
+            if (clock == 0) {
+                continue;
+            }
+
+            for (presc = 0; presc < sizeof(uart_prescaler_div) /
+                                        sizeof(uart_prescaler_div[0]);
+                 ++presc) {
+                uint64_t scale = (uint64_t)baud_rate * uart_prescaler_div[presc];
+
+                if (lpuart) {
+                    /* BRR = 256 * f / baud, f must be in [3, 4096] * baud. */
+                    if ((clock < 3 * scale) || (clock > 4096 * scale)) {
+                        continue;
+                    }
+                    div = (clock * 256 + scale / 2) / scale;
+                    if ((div < 0x300) || (div > 0xFFFFF)) {
+                        continue;
+                    }
+                    actual = (clock * 256 + div * uart_prescaler_div[presc] / 2) /
+                             (div * uart_prescaler_div[presc]);
+                } else {
+                    /* USARTDIV = f / baud (16x) or 2 * f / baud (8x). */
+                    div = ((clock << over8) + scale / 2) / scale;
+                    if ((div < 0x10) || (div > 0xFFFF)) {
+                        continue;
+                    }
+                    actual =
+                        ((clock << over8) + div * uart_prescaler_div[presc] / 2) /
+                        (div * uart_prescaler_div[presc]);
+                }
+
+                error = ((int64_t)actual - (int64_t)baud_rate) * 1000000 /
+                        (int64_t)baud_rate;
+                if ((uint64_t)((error < 0) ? -error : error) >= best) {
+                    continue;
+                }
+
+                best = (uint64_t)((error < 0) ? -error : error);
+                plan->baud_rate = (uint32_t)actual;
+                plan->error_ppm = (int32_t)error;
+                plan->kernel_clock = (uint32_t)clock;
+                plan->clock_source = source;
+                plan->prescaler = presc;
+                plan->over8 = over8;
+                plan->brr = over8 ? (uint32_t)((div & 0xFFF0) | ((div & 0xF) >> 1))
+                                  : (uint32_t)div;
+            }
         }
-#endif /* USART3_RX_DMA */
+    }
 
-#if UART4_RX_DMA
+    if (best > UART_BAUD_MAX_ERROR) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Get the highest baud rate of UART with the ready clock sources.
+ *
+ * @param huart The handle of UART
+ * @return The highest baud rate.
+ */
+uint32_t uart_baud_max(UART_HandleTypeDef *huart) {
+    uint32_t clock, max = 0;
+    uint8_t source;
+
+    for (source = UART_CLOCK_PCLK; source <= UART_CLOCK_LSE; ++source) {
+        clock = uart_kernel_clock(huart, source);
+        if (clock > max) {
+            max = clock;
+        }
+    }
+
+    /* LPUART: f / 3, USART: 8x oversampling with USARTDIV = 16. */
+    return IS_LPUART_INSTANCE(huart->Instance) ? (max / 3) : (max / 8);
+}
+
+#if UART_BAUD_PLANNER
+
+/**
+ * @brief Plan the baud rate and fill the init struct of UART.
+ *
+ * @param huart The handle of UART
+ * @param baud_rate The required baud rate.
+ * @return 0 if success, or the error of `uart_baud_plan`.
+ * @note Called before `HAL_UART_Init`, which computes the same BRR.
+ */
+static uint8_t uart_baud_setup(UART_HandleTypeDef *huart, uint32_t baud_rate) {
+    uart_baud_plan_t plan;
+    uint8_t res = uart_baud_plan(huart, baud_rate, &plan);
+    if (res != 0) {
+        return res;
+    }
+
+    uart_set_clock_source(huart, plan.clock_source);
+    huart->Init.ClockPrescaler = plan.prescaler;
+    huart->Init.OverSampling =
+        plan.over8 ? UART_OVERSAMPLING_8 : UART_OVERSAMPLING_16;
+    huart->Init.OneBitSampling =
+        plan.over8 ? UART_ONE_BIT_SAMPLE_ENABLE : UART_ONE_BIT_SAMPLE_DISABLE;
+
+    return 0;
+}
+
+#endif /* UART_BAUD_PLANNER */
+
+/**
+ * @brief Change the baud rate of UART without reinitialize.
+ *
+ * @param huart The handle of UART
+ * @param baud_rate The new baud rate.
+ * @param[out] plan The applied settings, can be NULL.
+ * @return Set message:
+ *  @retval - 0: Success
+ *  @retval - 1: This uart is not inited.
+ *  @retval - 2: No settings within `UART_BAUD_MAX_ERROR`.
+ *  @retval - 3: This uart is transmitting now.
+ * @note The UART is disabled for a few cycles to write the registers, a
+ *       byte that is being received at that time is lost. DMA Rx keeps
+ *       running.
+ */
+uint8_t uart_set_baud(UART_HandleTypeDef *huart, uint32_t baud_rate,
+                      uart_baud_plan_t *plan) {
+    uart_baud_plan_t new_plan;
+
+    if (huart->gState == HAL_UART_STATE_RESET) {
+        return 1;
+    }
+
+    if (uart_baud_plan(huart, baud_rate, &new_plan) != 0) {
+        return 2;
+    }
+
+    if ((huart->gState != HAL_UART_STATE_READY) ||
+        !__HAL_UART_GET_FLAG(huart, UART_FLAG_TC)) {
+        return 3;
+    }
+
+    uint32_t primask = uart_critical_enter();
+    __HAL_UART_DISABLE(huart);
+
+    uart_set_clock_source(huart, new_plan.clock_source);
+    MODIFY_REG(huart->Instance->PRESC, USART_PRESC_PRESCALER,
+               new_plan.prescaler);
+    MODIFY_REG(huart->Instance->CR1, USART_CR1_OVER8,
+               new_plan.over8 ? USART_CR1_OVER8 : 0);
+    MODIFY_REG(huart->Instance->CR3, USART_CR3_ONEBIT,
+               new_plan.over8 ? USART_CR3_ONEBIT : 0);
+    WRITE_REG(huart->Instance->BRR, new_plan.brr);
+    if (READ_BIT(huart->Instance->CR2, USART_CR2_RTOEN)) {
+        /* Keep the Modbus RTU gap at 3.5 characters. */
+        HAL_UART_ReceiverTimeout_Config(huart, uart_modbus_rto(baud_rate));
+    }
+
+    __HAL_UART_ENABLE(huart);
+    uart_critical_exit(primask);
+
+    huart->Init.BaudRate = baud_rate;
+    huart->Init.ClockPrescaler = new_plan.prescaler;
+    huart->Init.OverSampling =
+        new_plan.over8 ? UART_OVERSAMPLING_8 : UART_OVERSAMPLING_16;
+    huart->Init.OneBitSampling = new_plan.over8 ? UART_ONE_BIT_SAMPLE_ENABLE
+                                                : UART_ONE_BIT_SAMPLE_DISABLE;
+
+    if (plan != NULL) {
+        *plan = new_plan;
+    }
+
+    return 0;
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup Public UART statistics functions.
+ * @{
+ */
+
+#if UART_STATS_ENABLE
+
+/**
+ * @brief Identify the UART statistics by handle.
+ *
+ * @param huart The handle of UART
+ * @return The statistics of UART.
+ */
+static uart_stats_t *uart_stats_identify(UART_HandleTypeDef *huart) {
+    switch ((uintptr_t)huart->Instance) {
+#if LPUART1_ENABLE
+        case LPUART1_BASE: {
+            return &lpuart1_stats;
+        }
+#endif /* LPUART1_ENABLE */
+
+#if USART1_ENABLE
+        case USART1_BASE: {
+            return &usart1_stats;
+        }
+#endif /* USART1_ENABLE */
+
+#if USART2_ENABLE
+        case USART2_BASE: {
+            return &usart2_stats;
+        }
+#endif /* USART2_ENABLE */
+
+#if USART3_ENABLE
+        case USART3_BASE: {
+            return &usart3_stats;
+        }
+#endif /* USART3_ENABLE */
+
+#if UART4_ENABLE
         case UART4_BASE: {
-            return &uart4_rx_fifo;
+            return &uart4_stats;
         }
-#endif /* UART4_RX_DMA */
+#endif /* UART4_ENABLE */
 
-#if UART5_RX_DMA
+#if UART5_ENABLE
         case UART5_BASE: {
-            return &uart5_rx_fifo;
+            return &uart5_stats;
         }
-#endif /* UART5_RX_DMA */
+#endif /* UART5_ENABLE */
 
         default: {
         } break;
@@ -2046,388 +4138,2586 @@ static inline uart_rx_fifo_t *uart_rx_identify(UART_HandleTypeDef *huart) {
 }
 
 /**
- * @brief UART received idle callback.
+ * @brief Get the statistics of UART.
  *
  * @param huart The handle of UART
+ * @param[out] stats The statistics.
+ * @return Get message:
+ *  @retval - 0: Success
+ *  @retval - 1: This uart is not enabled.
+ *  @retval - 2: Parameter error.
  */
-void uart_dmarx_idle_callback(UART_HandleTypeDef *huart) {
-    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
-    if (uart_rx_fifo == NULL) {
-        return;
+uint8_t uart_get_stats(UART_HandleTypeDef *huart, uart_stats_t *stats) {
+    if (stats == NULL) {
+        return 2;
     }
 
-    uint32_t tail_ptr;
-    uint32_t copy, offset;
-
-    /**
-     * +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~+
-     * |     head_ptr          tail_ptr         |
-     * |         |                 |            |
-     * |         v                 v            |
-     * | --------*******************----------- |
-     * +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~+
-     */
-
-    /* Received */
-    tail_ptr = huart->RxXferSize - __HAL_DMA_GET_COUNTER(huart->hdmarx);
+    uart_stats_t *uart_stats = uart_stats_identify(huart);
+    if (uart_stats == NULL) {
+        return 1;
+    }
 
-    offset = (uart_rx_fifo->head_ptr) % (uint32_t)(huart->RxXferSize);
-    copy = tail_ptr - offset;
-    uart_rx_fifo->head_ptr += copy;
+    uint32_t primask = uart_critical_enter();
+    *stats = *uart_stats;
+    uart_critical_exit(primask);
 
-    ring_fifo_write(uart_rx_fifo->rx_fifo, huart->pRxBuffPtr + offset, copy);
+    return 0;
 }
 
 /**
- * @brief UART DMA half overflow callback.
+ * @brief Clear the statistics of UART.
  *
  * @param huart The handle of UART
+ * @return Reset message:
+ *  @retval - 0: Success
+ *  @retval - 1: This uart is not enabled.
  */
-void uart_dmarx_halfdone_callback(UART_HandleTypeDef *huart) {
-    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
-    if (uart_rx_fifo == NULL) {
-        return;
+uint8_t uart_reset_stats(UART_HandleTypeDef *huart) {
+    uart_stats_t *uart_stats = uart_stats_identify(huart);
+    if (uart_stats == NULL) {
+        return 1;
     }
 
-    uint32_t tail_ptr;
-    uint32_t offset, copy;
+    uint32_t primask = uart_critical_enter();
+    memset(uart_stats, 0, sizeof(uart_stats_t));
+    uart_critical_exit(primask);
 
-    /**
-     * +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~+
-     * |                  half                  |
-     * |     head_ptr   tail_ptr                |
-     * |         |          |                   |
-     * |         v          v                   |
-     * | --------*******************----------- |
-     * +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~+
-     */
+    return 0;
+}
+
+#endif /* UART_STATS_ENABLE */
+
+/**
+ * @}
+ */
 
-    tail_ptr = (huart->RxXferSize >> 1) + (huart->RxXferSize & 1);
+/*****************************************************************************
+ * @defgroup Public UART DMA Rx functions.
+ * @{
+ */
+
+/**
+ * @brief Identify the UART receive fifo by handle.
+ *
+ * @param huart The handle of UART
+ * @return The point of UART rx fifo.
+ */
+static inline uart_rx_fifo_t *uart_rx_identify(UART_HandleTypeDef *huart) {
+
+    switch ((uintptr_t)huart->Instance) {
+#if LPUART1_RX_DMA || LPUART1_RX_IT
+        case LPUART1_BASE: {
+            return &lpuart1_rx_fifo;
+        }
+#endif /* LPUART1_RX_DMA || LPUART1_RX_IT */
+
+#if USART1_RX_DMA || USART1_RX_IT
+        case USART1_BASE: {
+            return &usart1_rx_fifo;
+        }
+#endif /* USART1_RX_DMA || USART1_RX_IT */
+
+#if USART2_RX_DMA || USART2_RX_IT
+        case USART2_BASE: {
+            return &usart2_rx_fifo;
+        }
+#endif /* USART2_RX_DMA || USART2_RX_IT */
+#if USART3_RX_DMA || USART3_RX_IT
+        case USART3_BASE: {
+            return &usart3_rx_fifo;
+        }
+#endif /* USART3_RX_DMA || USART3_RX_IT */
+
+#if UART4_RX_DMA || UART4_RX_IT
+        case UART4_BASE: {
+            return &uart4_rx_fifo;
+        }
+#endif /* UART4_RX_DMA || UART4_RX_IT */
+
+#if UART5_RX_DMA || UART5_RX_IT
+        case UART5_BASE: {
+            return &uart5_rx_fifo;
+        }
+#endif /* UART5_RX_DMA || UART5_RX_IT */
+
+        default: {
+        } break;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Calculate CRC16-CCITT (poly 0x1021, init 0xFFFF).
+ *
+ * @param data The data.
+ * @param len The length of data.
+ * @return The CRC.
+ */
+static uint16_t uart_crc16_ccitt(const uint8_t *data, uint32_t len) {
+    uint16_t crc = 0xFFFF;
+    uint8_t i;
+
+    while (len--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (i = 0; i < 8; ++i) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021)
+                                 : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/**
+ * @brief Table of CRC16/MODBUS (poly 0xA001 reflected).
+ */
+static const uint16_t uart_crc16_modbus_table[256] = {
+    0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+    0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+    0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+    0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+    0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+    0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+    0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+    0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+    0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+    0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+    0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+    0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+    0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+    0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+    0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+    0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+    0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+    0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+    0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+    0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+    0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+    0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+    0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+    0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+    0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+    0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+    0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+    0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+    0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+    0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+    0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+    0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040,
+};
+
+/**
+ * @brief Calculate CRC16/MODBUS (init 0xFFFF).
+ *
+ * @param data The data.
+ * @param len The length of data.
+ * @return The CRC.
+ */
+static uint16_t uart_crc16_modbus(const uint8_t *data, uint32_t len) {
+    uint16_t crc = 0xFFFF;
+
+    while (len--) {
+        crc = (crc >> 8) ^ uart_crc16_modbus_table[(crc ^ *data++) & 0xFF];
+    }
+
+    return crc;
+}
+
+/**
+ * @brief Finish the frame, check it and call the callback.
+ *
+ * @param huart The handle of UART
+ * @param frame The frame decoder.
+ * @param valid The frame ends correctly.
+ */
+static void uart_rx_frame_end(UART_HandleTypeDef *huart,
+                              uart_rx_frame_t *frame, uint8_t valid) {
+    uint32_t len = frame->len;
+
+    if (frame->overflow || (len == 0)) {
+        valid = 0;
+    }
+
+    if (valid && (frame->mode == UART_FRAME_MODBUS)) {
+        /* CRC is appended in little endian. */
+        if ((len < 2) ||
+            (uart_crc16_modbus(frame->buf, len - 2) !=
+             (uint16_t)((frame->buf[len - 1] << 8) | frame->buf[len - 2]))) {
+            valid = 0;
+        }
+        len -= 2;
+    } else if (valid && (frame->mode & UART_FRAME_CRC16)) {
+        /* CRC is appended in big endian. */
+        if ((len < 2) ||
+            (uart_crc16_ccitt(frame->buf, len - 2) !=
+             (uint16_t)((frame->buf[len - 2] << 8) | frame->buf[len - 1]))) {
+            valid = 0;
+        }
+        len -= 2;
+    }
+
+    if (valid && (frame->callback != NULL)) {
+        frame->callback(huart, frame->buf, len, frame->arg);
+    }
+
+    frame->escape = 0;
+    frame->code = 0;
+    frame->zero = 0;
+    frame->overflow = 0;
+    frame->len = 0;
+}
+
+/**
+ * @brief Append a decoded byte to the frame.
+ *
+ * @param frame The frame decoder.
+ * @param byte The byte.
+ */
+static inline void uart_rx_frame_put(uart_rx_frame_t *frame, uint8_t byte) {
+    if (frame->len < frame->size) {
+        frame->buf[frame->len++] = byte;
+    } else {
+        frame->overflow = 1;
+    }
+}
+
+/**
+ * @brief Decode the new received bytes.
+ *
+ * @param huart The handle of UART
+ * @param frame The frame decoder.
+ * @param data The new received bytes.
+ * @param len The length of data.
+ * @note It keeps the state between calls, so the frame can be split in any
+ *       chunks.
+ */
+static void uart_rx_frame_decode(UART_HandleTypeDef *huart,
+                                 uart_rx_frame_t *frame, const uint8_t *data,
+                                 uint32_t len) {
+    uint8_t byte;
+
+    if (frame->mode == UART_FRAME_MODBUS) {
+        /* The frame ends at receiver timeout. */
+        while (len--) {
+            uart_rx_frame_put(frame, *data++);
+        }
+        return;
+    }
+
+    while (len--) {
+        byte = *data++;
+
+        if ((frame->mode & ~UART_FRAME_CRC16) == UART_FRAME_COBS) {
+            if (byte == 0x00) {
+                uart_rx_frame_end(huart, frame, frame->code == 0);
+            } else if (frame->code == 0) {
+                /* Code byte, start of a block. */
+                if (frame->zero) {
+                    uart_rx_frame_put(frame, 0x00);
+                }
+                frame->zero = (byte != 0xFF);
+                frame->code = byte - 1;
+            } else {
+                uart_rx_frame_put(frame, byte);
+                --frame->code;
+            }
+        } else {
+            if (byte == 0xC0) {
+                /* SLIP END, empty frames are skipped. */
+                if (frame->len || frame->overflow) {
+                    uart_rx_frame_end(huart, frame, !frame->escape);
+                }
+            } else if (byte == 0xDB) {
+                frame->escape = 1;
+            } else if (frame->escape) {
+                frame->escape = 0;
+                uart_rx_frame_put(frame, (byte == 0xDC)   ? 0xC0
+                                         : (byte == 0xDD) ? 0xDB
+                                                          : byte);
+            } else {
+                uart_rx_frame_put(frame, byte);
+            }
+        }
+    }
+}
+
+#if UART_RX_TIMESTAMP
+
+/**
+ * @brief Record the timestamp of the chunk which is just received.
+ *
+ * @param uart_rx_fifo The receive fifo of UART.
+ * @note The chunk is merged into the newest one if the records are full.
+ */
+static void uart_rx_ts_record(uart_rx_fifo_t *uart_rx_fifo) {
+    uint32_t end_cnt = uart_rx_fifo->recv_cnt - uart_rx_fifo->drop_cnt;
+    uint32_t last;
+
+    if (uart_rx_fifo->ts_count != 0) {
+        last = (uart_rx_fifo->ts_head + uart_rx_fifo->ts_count - 1U) %
+               UART_RX_TIMESTAMP_DEPTH;
+        if (uart_rx_fifo->ts[last].end_cnt == end_cnt) {
+            /* Nothing is stored. */
+            return;
+        }
+    }
+
+    if (uart_rx_fifo->ts_count < UART_RX_TIMESTAMP_DEPTH) {
+        ++uart_rx_fifo->ts_count;
+    }
+
+    last = (uart_rx_fifo->ts_head + uart_rx_fifo->ts_count - 1U) %
+           UART_RX_TIMESTAMP_DEPTH;
+    uart_rx_fifo->ts[last].end_cnt = end_cnt;
+    uart_rx_fifo->ts[last].timestamp = UART_RX_TIMESTAMP_GET();
+}
+
+#endif /* UART_RX_TIMESTAMP */
+
+/**
+ * @brief Hand over the new received data to the fifo or frame decoder.
+ *
+ * @param huart The handle of UART
+ * @param uart_rx_fifo The receive fifo of UART.
+ * @param data The new received data.
+ * @param len The length of data.
+ * @note In zero-copy mode the data stays in `recv_buf` until the application
+ *       commits it, only the receive count is advanced.
+ */
+static void uart_rx_deliver(UART_HandleTypeDef *huart,
+                            uart_rx_fifo_t *uart_rx_fifo, const uint8_t *data,
+                            uint32_t len) {
+    uart_rx_fifo->recv_cnt += len;
+    UART_STATS_ADD(huart, rx_bytes, len);
+
+    if (uart_rx_fifo->bridge != NULL) {
+        uart_bridge_forward(huart, uart_rx_fifo, data, len);
+        return;
+    }
+
+    if (uart_rx_fifo->frame.mode != UART_FRAME_NONE) {
+        uart_rx_fifo->read_cnt = uart_rx_fifo->recv_cnt;
+        uart_rx_frame_decode(huart, &uart_rx_fifo->frame, data, len);
+        return;
+    }
+
+    if (!uart_rx_fifo->zero_copy) {
+        uint32_t written = ring_fifo_write(uart_rx_fifo->rx_fifo, data, len);
+        if (written < len) {
+            uart_rx_fifo->drop_cnt += len - written;
+            UART_STATS_ADD(huart, rx_dropped, len - written);
+        }
+    }
+
+#if UART_RX_TIMESTAMP
+    uart_rx_ts_record(uart_rx_fifo);
+#endif /* UART_RX_TIMESTAMP */
+
+#if UART_STATS_ENABLE
+    uart_stats_t *uart_stats = uart_stats_identify(huart);
+    if (uart_stats != NULL) {
+        uint32_t fill = uart_rx_fifo->recv_cnt - uart_rx_fifo->drop_cnt -
+                        uart_rx_fifo->read_cnt;
+        if (fill > uart_stats->rx_max_fill) {
+            uart_stats->rx_max_fill = fill;
+        }
+    }
+#endif /* UART_STATS_ENABLE */
+
+    if (len != 0) {
+        uart_dmarx_signal(huart);
+    }
+}
+
+/**
+ * @brief Hand over the data that DMA wrote between `head_ptr` and `tail_ptr`.
+ *
+ * @param huart The handle of UART
+ * @param uart_rx_fifo The receive fifo of UART.
+ * @param tail_ptr The position in receive buf that DMA has written up to,
+ *                 not less than `head_ptr`.
+ */
+static void uart_dmarx_push(UART_HandleTypeDef *huart,
+                            uart_rx_fifo_t *uart_rx_fifo, uint32_t tail_ptr) {
+    uint32_t offset = uart_rx_fifo->head_ptr;
+
+    uart_rx_fifo->head_ptr = (tail_ptr >= huart->RxXferSize) ? 0 : tail_ptr;
+    uart_rx_deliver(huart, uart_rx_fifo, huart->pRxBuffPtr + offset,
+                    tail_ptr - offset);
+}
+
+/**
+ * @brief Hand over the data that DMA has written up to NDTR.
+ *
+ * @param huart The handle of UART
+ * @param uart_rx_fifo The receive fifo of UART.
+ * @note Called by the owner of update only.
+ */
+static void uart_dmarx_flush(UART_HandleTypeDef *huart,
+                             uart_rx_fifo_t *uart_rx_fifo) {
+    /**
+     * +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~+
+     * |     head_ptr          tail_ptr         |
+     * |         |                 |            |
+     * |         v                 v            |
+     * | --------*******************----------- |
+     * +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~+
+     * |  tail_ptr                 head_ptr     |
+     * |     |                        |         |
+     * |     v                        v         |
+     * | *****------------------------********* |
+     * +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~+
+     */
+
+    /* NDTR is 0 only when DMA has stopped at the end (normal mode), the
+     * same position as the start. */
+    uint32_t tail_ptr =
+        (huart->RxXferSize - __HAL_DMA_GET_COUNTER(huart->hdmarx)) %
+        huart->RxXferSize;
+    if (tail_ptr < uart_rx_fifo->head_ptr) {
+        /* Wrapped, the end of buf first. */
+        uart_dmarx_push(huart, uart_rx_fifo, huart->RxXferSize);
+    }
+    uart_dmarx_push(huart, uart_rx_fifo, tail_ptr);
+}
+
+/**
+ * @brief Reload DMA Rx from the start of receive buf.
+ *
+ * @param huart The handle of UART
+ * @param uart_rx_fifo The receive fifo of UART.
+ * @note Called by the owner of update. DMA may have written more after the
+ *       owner read NDTR, it is handed over once DMA is stopped. DMA restarts
+ *       by registers at the start of buf. In zero-copy mode the unread
+ *       data is discarded, since DMA overwrites it earlier than the reader
+ *       expects.
+ */
+static void uart_dmarx_reload(UART_HandleTypeDef *huart,
+                              uart_rx_fifo_t *uart_rx_fifo) {
+    DMA_HandleTypeDef *hdma = huart->hdmarx;
+    uint32_t primask = uart_critical_enter();
+
+    __HAL_DMA_DISABLE(hdma);
+    __HAL_DMA_CLEAR_FLAG(hdma, __HAL_DMA_GET_GI_FLAG_INDEX(hdma));
+    uart_dmarx_flush(huart, uart_rx_fifo);
+
+    if (uart_rx_fifo->zero_copy) {
+        UART_STATS_ADD(huart, rx_dropped,
+                       uart_rx_fifo->recv_cnt - uart_rx_fifo->read_cnt);
+        uart_rx_fifo->read_cnt = uart_rx_fifo->recv_cnt;
+        uart_rx_fifo->read_ptr = 0;
+    }
+
+    __HAL_DMA_SET_COUNTER(hdma, huart->RxXferSize);
+    uart_rx_fifo->head_ptr = 0;
+    hdma->State = HAL_DMA_STATE_BUSY;
+    __HAL_DMA_ENABLE_IT(hdma, DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
+    __HAL_DMA_ENABLE(hdma);
+
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    if (huart->Init.Parity != UART_PARITY_NONE) {
+        SET_BIT(huart->Instance->CR1, USART_CR1_PEIE);
+    }
+    SET_BIT(huart->Instance->CR3, USART_CR3_EIE);
+    if (!uart_rx_fifo->bridge_pause) {
+        SET_BIT(huart->Instance->CR3, USART_CR3_DMAR);
+    }
+
+    uart_critical_exit(primask);
+    UART_STATS_ADD(huart, dma_restarts, 1);
+}
+
+/**
+ * @brief Hand over the data that DMA has written since the last update.
+ *
+ * @param huart The handle of UART
+ * @param uart_rx_fifo The receive fifo of UART.
+ * @note All the DMA Rx events (idle, half, complete, match, timeout) use it,
+ *       the position is always taken from NDTR, so a late or missed event
+ *       does not duplicate or lose data. The events may preempt each other:
+ *       the first one owns the update and repeats it until no request is
+ *       left, a preempting one only counts its request and returns. The
+ *       restart of aborted DMA is done by the owner too, after the data is
+ *       handed over.
+ */
+static void uart_dmarx_update(UART_HandleTypeDef *huart,
+                              uart_rx_fifo_t *uart_rx_fifo) {
+    uint32_t req;
+
+    if (uart_atomic_add(&uart_rx_fifo->update_req, 1) != 1) {
+        /* The preempted owner will do it. */
+        return;
+    }
+
+    do {
+        req = uart_rx_fifo->update_req;
+        uart_dmarx_flush(huart, uart_rx_fifo);
+
+        if (uart_rx_fifo->restart_req) {
+            uart_rx_fifo->restart_req = 0;
+            uart_dmarx_reload(huart, uart_rx_fifo);
+        }
+    } while (uart_atomic_add(&uart_rx_fifo->update_req, -(int32_t)req) != 0);
+}
+
+/**
+ * @brief Count and clear the receive errors.
+ *
+ * @param huart The handle of UART
+ * @note The byte with PE, NE or FE is still received, ORE only loses the
+ *       byte that the receiver can not hold.
+ */
+static void uart_rx_error_clear(UART_HandleTypeDef *huart) {
+    if (__HAL_UART_GET_FLAG(huart, UART_FLAG_PE)) {
+        __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_PEF);
+        UART_STATS_ADD(huart, pe_errors, 1);
+    }
+
+    if (__HAL_UART_GET_FLAG(huart, UART_FLAG_FE)) {
+        __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_FEF);
+        UART_STATS_ADD(huart, fe_errors, 1);
+    }
+
+    if (__HAL_UART_GET_FLAG(huart, UART_FLAG_NE)) {
+        __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_NEF);
+        UART_STATS_ADD(huart, ne_errors, 1);
+    }
+
+    if (__HAL_UART_GET_FLAG(huart, UART_FLAG_ORE)) {
+        __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_OREF);
+        UART_STATS_ADD(huart, ore_errors, 1);
+        UART_STATS_ADD(huart, rx_dropped, 1);
+    }
+}
+
+/**
+ * @brief Receive by interrupt, drain the Rx register (or hardware FIFO) into
+ *        the receive fifo.
+ *
+ * @param huart The handle of UART
+ * @note Called in UART IRQ handler before `HAL_UART_IRQHandler`, for UART
+ *       which receives without DMA (`*_RX_IT`). The receive errors are
+ *       counted and cleared here, otherwise HAL disables the Rx interrupts.
+ */
+void uart_rx_irq_handler(UART_HandleTypeDef *huart) {
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+    if ((uart_rx_fifo == NULL) || (huart->hdmarx != NULL)) {
+        return;
+    }
+
+    uint8_t buf[8];
+    uint32_t len;
+
+    /* HAL ends the reception on any error, keep it receiving. */
+    uart_rx_error_clear(huart);
+
+    if (__HAL_UART_GET_FLAG(huart, UART_FLAG_IDLE)) {
+        /* Line idle, flush the bytes below the Rx FIFO threshold. */
+        __HAL_UART_CLEAR_IDLEFLAG(huart);
+    }
+
+    do {
+        len = 0;
+        while ((len < sizeof(buf)) &&
+               __HAL_UART_GET_FLAG(huart, UART_FLAG_RXNE)) {
+            buf[len++] = (uint8_t)READ_REG(huart->Instance->RDR);
+        }
+
+        if (len != 0) {
+            uart_rx_deliver(huart, uart_rx_fifo, buf, len);
+        }
+    } while (len == sizeof(buf));
+}
+
+/**
+ * @brief UART received idle callback.
+ *
+ * @param huart The handle of UART
+ */
+void uart_dmarx_idle_callback(UART_HandleTypeDef *huart) {
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+    if ((uart_rx_fifo == NULL) || (huart->hdmarx == NULL)) {
+        return;
+    }
+
+    uart_dmarx_update(huart, uart_rx_fifo);
+    UART_STATS_ADD(huart, idle_events, 1);
+}
+
+/**
+ * @brief Clear the receive errors of DMA Rx before HAL takes them.
+ *
+ * @param huart The handle of UART
+ * @note Called in UART IRQ handler before `HAL_UART_IRQHandler`, which
+ *       aborts DMA Rx on any error. The DMA does not need it, so the errors
+ *       are counted and cleared here, DMA keeps running.
+ */
+void uart_dmarx_error_handler(UART_HandleTypeDef *huart) {
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+    if ((uart_rx_fifo == NULL) || (huart->hdmarx == NULL)) {
+        return;
+    }
+
+    uart_rx_error_clear(huart);
+}
+
+/**
+ * @brief Restart DMA Rx after it is aborted, without waiting.
+ *
+ * @param huart The handle of UART
+ * @param uart_rx_fifo The receive fifo of UART.
+ * @note Called in UART IRQ, which may preempt an update in progress. The
+ *       request is handed to the owner of update, which restarts DMA after
+ *       it has handed over the data, see `uart_dmarx_reload()`.
+ */
+static void uart_dmarx_restart(UART_HandleTypeDef *huart,
+                               uart_rx_fifo_t *uart_rx_fifo) {
+    uart_rx_fifo->restart_req = 1;
+    uart_dmarx_update(huart, uart_rx_fifo);
+}
+
+/**
+ * @brief UART character match callback.
+ *
+ * @param huart The handle of UART
+ * @note CMF is set when the character is in RDR. The data that DMA has
+ *       moved is delivered like the idle line, without waiting in the
+ *       interrupt. If DMA has not taken the character yet, it is delivered
+ *       at the idle line that follows.
+ */
+void uart_dmarx_match_callback(UART_HandleTypeDef *huart) {
+    if (huart->hdmarx == NULL) {
+        /* Interrupt Rx has drained it already. */
+        return;
+    }
+
+    uart_dmarx_idle_callback(huart);
+}
+
+/**
+ * @brief UART receiver timeout callback.
+ *
+ * @param huart The handle of UART
+ * @note The data is flushed like the idle line, then a Modbus RTU frame is
+ *       finished.
+ */
+void uart_rx_timeout_callback(UART_HandleTypeDef *huart) {
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+    if (uart_rx_fifo == NULL) {
+        return;
+    }
+
+    if (huart->hdmarx != NULL) {
+        uart_dmarx_idle_callback(huart);
+    }
+
+    if ((uart_rx_fifo->frame.mode == UART_FRAME_MODBUS) &&
+        (uart_rx_fifo->frame.len || uart_rx_fifo->frame.overflow)) {
+        uart_rx_frame_end(huart, &uart_rx_fifo->frame, 1);
+    }
+}
+
+/**
+ * @brief UART DMA half overflow callback.
+ *
+ * @param huart The handle of UART
+ */
+void uart_dmarx_halfdone_callback(UART_HandleTypeDef *huart) {
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+    if (uart_rx_fifo == NULL) {
+        return;
+    }
+
+    uart_dmarx_update(huart, uart_rx_fifo);
+    UART_STATS_ADD(huart, half_events, 1);
+}
+
+/**
+ * @brief UART DMA overflow callback.
+ *
+ * @param huart The handle of UART
+ */
+void uart_dmarx_done_callback(UART_HandleTypeDef *huart) {
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+    if (uart_rx_fifo == NULL) {
+        return;
+    }
+
+    UART_STATS_ADD(huart, done_events, 1);
+
+    if (huart->hdmarx->Init.Mode != DMA_CIRCULAR) {
+        /* DMA has stopped, the owner of update reloads it. */
+        uart_dmarx_restart(huart, uart_rx_fifo);
+    } else {
+        uart_dmarx_update(huart, uart_rx_fifo);
+    }
+}
+
+/**
+ * @brief Read from UART Receive fifo.
+ *
+ * @param huart The handle of UART
+ * @param[out] buf The data buf which receive the data from the fifo.
+ * @param buf_size The size of buf.
+ * @return The length that be received.
+ */
+uint32_t uart_dmarx_read(UART_HandleTypeDef *huart, void *buf,
+                         size_t buf_size) {
+    if ((buf == NULL) || (buf_size == 0)) {
+        return 0;
+    }
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+
+    if (uart_rx_fifo == NULL) {
+        return 0;
+    }
+
+    if (uart_rx_fifo->zero_copy) {
+        uart_rx_span_t span;
+        uint32_t len, first;
+
+        len = uart_dmarx_peek(huart, &span);
+        if (len == 0) {
+            return 0;
+        }
+        if (len > buf_size) {
+            len = buf_size;
+        }
+
+        first = (len < span.len[0]) ? len : span.len[0];
+        memcpy(buf, span.buf[0], first);
+        memcpy((uint8_t *)buf + first, span.buf[1], len - first);
+
+        return uart_dmarx_commit(huart, len);
+    }
+
+    uint32_t len = ring_fifo_read(uart_rx_fifo->rx_fifo, buf, buf_size);
+    uart_rx_fifo->read_cnt += len;
+
+    return len;
+}
+
+#if UART_RX_TIMESTAMP
+
+/**
+ * @brief Read from UART Receive fifo with the timestamps.
+ *
+ * @param huart The handle of UART
+ * @param[out] buf The data buf which receive the data from the fifo.
+ * @param buf_size The size of buf.
+ * @param[out] first_ts The timestamp of the first byte. Can be NULL.
+ * @param[out] last_ts The timestamp of the last byte. Can be NULL.
+ * @return The length that be received.
+ * @note The timestamp of a byte is the time of the Rx event (idle, half,
+ *       complete, match or interrupt) which delivered it, taken by
+ *       `UART_RX_TIMESTAMP_GET()`.
+ */
+uint32_t uart_dmarx_read_ts(UART_HandleTypeDef *huart, void *buf,
+                            size_t buf_size, uint32_t *first_ts,
+                            uint32_t *last_ts) {
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+    if (uart_rx_fifo == NULL) {
+        return 0;
+    }
+
+    uint32_t start = uart_rx_fifo->read_cnt;
+    uint32_t len = uart_dmarx_read(huart, buf, buf_size);
+    uint32_t first = 0, last = 0, i;
+    uint8_t found = 0;
+    uart_rx_ts_t *ts;
+
+    if (len == 0) {
+        return 0;
+    }
+
+    uint32_t primask = uart_critical_enter();
+
+    for (i = 0; i < uart_rx_fifo->ts_count; ++i) {
+        ts = &uart_rx_fifo->ts[(uart_rx_fifo->ts_head + i) %
+                               UART_RX_TIMESTAMP_DEPTH];
+        last = ts->timestamp;
+
+        if (!found && ((int32_t)(ts->end_cnt - start) > 0)) {
+            first = ts->timestamp;
+            found = 1;
+        }
+
+        if ((int32_t)(ts->end_cnt - (start + len)) >= 0) {
+            break;
+        }
+    }
+
+    if (!found) {
+        first = last;
+    }
+
+    /* Retire the chunks which are read. */
+    while ((uart_rx_fifo->ts_count != 0) &&
+           ((int32_t)(uart_rx_fifo->ts[uart_rx_fifo->ts_head].end_cnt -
+                      uart_rx_fifo->read_cnt) <= 0)) {
+        uart_rx_fifo->ts_head =
+            (uart_rx_fifo->ts_head + 1U) % UART_RX_TIMESTAMP_DEPTH;
+        --uart_rx_fifo->ts_count;
+    }
+
+    uart_critical_exit(primask);
+
+    if (first_ts != NULL) {
+        *first_ts = first;
+    }
+
+    if (last_ts != NULL) {
+        *last_ts = last;
+    }
+
+    return len;
+}
+
+#endif /* UART_RX_TIMESTAMP */
+
+/**
+ * @brief Read from UART Receive fifo, stop after the delimiter.
+ *
+ * @param huart The handle of UART
+ * @param uart_rx_fifo The receive fifo of UART.
+ * @param[out] buf The data buf which receive the data from the fifo.
+ * @param buf_size The size of buf.
+ * @param delim The delimiter.
+ * @param[out] found Set to 1 if the delimiter is read.
+ * @return The length that be received.
+ */
+static uint32_t uart_dmarx_read_until(UART_HandleTypeDef *huart,
+                                      uart_rx_fifo_t *uart_rx_fifo,
+                                      uint8_t *buf, size_t buf_size,
+                                      uint8_t delim, uint8_t *found) {
+    uint32_t len = 0;
+
+    if (uart_rx_fifo->zero_copy) {
+        uart_rx_span_t span;
+        const uint8_t *pos;
+        uint32_t total, first;
+
+        total = uart_dmarx_peek(huart, &span);
+        if (total > buf_size) {
+            total = buf_size;
+        }
+
+        first = (total < span.len[0]) ? total : span.len[0];
+        pos = memchr(span.buf[0], delim, first);
+        if (pos != NULL) {
+            total = (uint32_t)(pos - span.buf[0]) + 1;
+            *found = 1;
+        } else if (total > first) {
+            pos = memchr(span.buf[1], delim, total - first);
+            if (pos != NULL) {
+                total = first + (uint32_t)(pos - span.buf[1]) + 1;
+                *found = 1;
+            }
+        }
+
+        first = (total < span.len[0]) ? total : span.len[0];
+        memcpy(buf, span.buf[0], first);
+        memcpy(buf + first, span.buf[1], total - first);
+
+        return uart_dmarx_commit(huart, total);
+    }
+
+    /* The fifo can not be peeked, read byte by byte to leave the rest. */
+    while ((len < buf_size) &&
+           (ring_fifo_read(uart_rx_fifo->rx_fifo, &buf[len], 1) == 1)) {
+        ++uart_rx_fifo->read_cnt;
+        if (buf[len++] == delim) {
+            *found = 1;
+            break;
+        }
+    }
+
+    return len;
+}
+
+/**
+ * @brief Read from UART Receive fifo, wait until enough data is received.
+ *
+ * @param huart The handle of UART
+ * @param[out] buf The data buf which receive the data from the fifo.
+ * @param buf_size The size of buf.
+ * @param min_len Return when at least `min_len` bytes are received.
+ * @param delim Return when this byte is received, it is the last byte of
+ *              buf. -1 for no delimiter.
+ * @param timeout Timeout in ms, `HAL_MAX_DELAY` to wait forever.
+ * @return The length that be received.
+ * @note It sleeps in `uart_dmarx_wait` between the Rx callbacks, do not
+ *       call it in interrupt.
+ */
+uint32_t uart_dmarx_read_timeout(UART_HandleTypeDef *huart, void *buf,
+                                 size_t buf_size, size_t min_len, int delim,
+                                 uint32_t timeout) {
+    uint32_t len = 0, elapsed;
+    uint32_t start = HAL_GetTick();
+    uint8_t found = 0;
+
+    if ((buf == NULL) || (buf_size == 0)) {
+        return 0;
+    }
+
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+    if (uart_rx_fifo == NULL) {
+        return 0;
+    }
+
+    if (min_len > buf_size) {
+        min_len = buf_size;
+    }
+
+    while (1) {
+        if (delim < 0) {
+            len += uart_dmarx_read(huart, (uint8_t *)buf + len,
+                                   buf_size - len);
+        } else {
+            len += uart_dmarx_read_until(huart, uart_rx_fifo,
+                                         (uint8_t *)buf + len, buf_size - len,
+                                         (uint8_t)delim, &found);
+        }
+
+        if (found || (len >= min_len) || (len == buf_size)) {
+            break;
+        }
+
+        elapsed = HAL_GetTick() - start;
+        if (timeout != HAL_MAX_DELAY) {
+            if (elapsed >= timeout) {
+                break;
+            }
+            uart_dmarx_wait(huart, timeout - elapsed);
+        } else {
+            uart_dmarx_wait(huart, HAL_MAX_DELAY);
+        }
+    }
+
+    return len;
+}
+
+/**
+ * @brief Wait for the Rx callbacks of UART.
+ *
+ * @param huart The handle of UART
+ * @param timeout Max wait time in ms, `HAL_MAX_DELAY` for no limit.
+ * @note The default one sleeps until any interrupt, SysTick wakes it up at
+ *       least every tick. Override it with a semaphore take on RTOS, the
+ *       semaphore must keep the signal that is given before waiting.
+ */
+__weak void uart_dmarx_wait(UART_HandleTypeDef *huart, uint32_t timeout) {
+    UNUSED(huart);
+    UNUSED(timeout);
+
+    __WFI();
+}
+
+/**
+ * @brief Signal the waiter of `uart_dmarx_wait`.
+ *
+ * @param huart The handle of UART
+ * @note Called in interrupt when new data is received. Override it with a
+ *       semaphore give on RTOS.
+ */
+__weak void uart_dmarx_signal(UART_HandleTypeDef *huart) {
+    UNUSED(huart);
+}
+
+/**
+ * @brief Get the received data in the DMA buffer without copying it.
+ *
+ * @param huart The handle of UART
+ * @param[out] span The readable region, split into two spans on wrap.
+ * @return The total length that can be read.
+ * @note Only available in zero-copy mode (`*_RX_DMA_ZERO_COPY`). The data
+ *       is valid until it is committed, or until DMA has written a whole
+ *       buffer over it. If the reader falls behind by more than the buffer
+ *       size, the pending data is discarded.
+ */
+uint32_t uart_dmarx_peek(UART_HandleTypeDef *huart, uart_rx_span_t *span) {
+    if (span == NULL) {
+        return 0;
+    }
+
+    span->len[0] = 0;
+    span->len[1] = 0;
+
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+    if ((uart_rx_fifo == NULL) || (uart_rx_fifo->zero_copy == 0) ||
+        (uart_rx_fifo->bridge != NULL)) {
+        return 0;
+    }
+
+    uint32_t len = uart_rx_fifo->recv_cnt - uart_rx_fifo->read_cnt;
+
+    if (len > uart_rx_fifo->buf_size) {
+        /* DMA has overwritten the unread data, drop it. */
+        UART_STATS_ADD(huart, rx_dropped, len);
+        uart_rx_fifo->read_cnt += len;
+        uart_rx_fifo->read_ptr =
+            (uart_rx_fifo->read_ptr + len) % uart_rx_fifo->buf_size;
+        return 0;
+    }
+
+    /**
+     * +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~+
+     * |                   read_ptr             |
+     * |                       |                |
+     * |  buf[1]               v     buf[0]     |
+     * | *******---------------**************** |
+     * +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~+
+     */
+
+    span->buf[0] = uart_rx_fifo->recv_buf + uart_rx_fifo->read_ptr;
+    span->buf[1] = uart_rx_fifo->recv_buf;
+
+    if (uart_rx_fifo->read_ptr + len > uart_rx_fifo->buf_size) {
+        span->len[0] = uart_rx_fifo->buf_size - uart_rx_fifo->read_ptr;
+        span->len[1] = len - span->len[0];
+    } else {
+        span->len[0] = len;
+    }
+
+    return len;
+}
+
+/**
+ * @brief Release the data which is returned by `uart_dmarx_peek`.
+ *
+ * @param huart The handle of UART
+ * @param len The length that has been consumed.
+ * @return The length that be released.
+ */
+uint32_t uart_dmarx_commit(UART_HandleTypeDef *huart, uint32_t len) {
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+    if ((uart_rx_fifo == NULL) || (uart_rx_fifo->zero_copy == 0)) {
+        return 0;
+    }
+
+    uint32_t pending = uart_rx_fifo->recv_cnt - uart_rx_fifo->read_cnt;
+    if (len > pending) {
+        len = pending;
+    }
+
+    uart_rx_fifo->read_ptr =
+        (uart_rx_fifo->read_ptr + len) % uart_rx_fifo->buf_size;
+    uart_rx_fifo->read_cnt += len;
+
+    return len;
+}
+
+/**
+ * @brief Set the frame decoder of receive path.
+ *
+ * @param huart The handle of UART
+ * @param mode `UART_FRAME_COBS` or `UART_FRAME_SLIP`, or with
+ *             `UART_FRAME_CRC16` to check the CRC at the end of frame.
+ *             `UART_FRAME_NONE` to disable it.
+ * @param buf The buffer to store the decoded frame.
+ * @param size The size of buf, frames longer than it are dropped.
+ * @param callback Called in interrupt when a checked frame is received.
+ * @param arg The argument of callback.
+ * @return Set message:
+ *  @retval - 0: Success
+ *  @retval - 1: This uart not enable DMA Rx.
+ *  @retval - 2: Parameter error.
+ * @note The new bytes are decoded in the DMA Rx callbacks, they are not
+ *       readable by `uart_dmarx_read` while the decoder is enabled.
+ */
+uint8_t uart_dmarx_set_frame(UART_HandleTypeDef *huart, uint8_t mode,
+                             uint8_t *buf, uint32_t size,
+                             uart_rx_frame_cb_t callback, void *arg) {
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+    if (uart_rx_fifo == NULL) {
+        return 1;
+    }
+
+    if (mode != UART_FRAME_NONE) {
+        if (((mode & ~UART_FRAME_CRC16) != UART_FRAME_COBS) &&
+            ((mode & ~UART_FRAME_CRC16) != UART_FRAME_SLIP) &&
+            (mode != UART_FRAME_MODBUS)) {
+            return 2;
+        }
+
+        if ((buf == NULL) || (size == 0)) {
+            return 2;
+        }
+    }
+
+    uint32_t primask = uart_critical_enter();
+    memset(&uart_rx_fifo->frame, 0, sizeof(uart_rx_frame_t));
+    uart_rx_fifo->frame.mode = mode;
+    uart_rx_fifo->frame.buf = buf;
+    uart_rx_fifo->frame.size = size;
+    uart_rx_fifo->frame.callback = callback;
+    uart_rx_fifo->frame.arg = arg;
+    uart_critical_exit(primask);
+
+    return 0;
+}
+
+#if !UART_STATIC_BUFFER
+
+/**
+ * @brief Move the unread data of receive fifo to a new fifo.
+ *
+ * @param from The old fifo.
+ * @param to The new fifo.
+ * @return The length that is dropped because of `to` is full.
+ */
+static uint32_t uart_rx_fifo_move(ring_fifo_t *from, ring_fifo_t *to) {
+    uint8_t buf[32];
+    uint32_t len, dropped = 0;
+
+    while ((len = ring_fifo_read(from, buf, sizeof(buf))) != 0) {
+        dropped += len - ring_fifo_write(to, buf, len);
+    }
+
+    return dropped;
+}
+
+/**
+ * @brief Move the unread data of receive buf to a new buf (zero-copy mode).
+ *
+ * @param huart The handle of UART
+ * @param uart_rx_fifo The receive fifo of UART.
+ * @param buf The new receive buf.
+ * @param size The size of new buf.
+ * @note The data is placed at the end of new buf, DMA restarts from the
+ *       beginning of it. If the new buf is smaller, the oldest data is
+ *       dropped.
+ */
+static void uart_rx_buf_move(UART_HandleTypeDef *huart,
+                             uart_rx_fifo_t *uart_rx_fifo, uint8_t *buf,
+                             uint32_t size) {
+    uint32_t len = uart_rx_fifo->recv_cnt - uart_rx_fifo->read_cnt;
+    uint32_t drop = 0, first;
+
+    if (len > uart_rx_fifo->buf_size) {
+        /* DMA has overwritten the unread data. */
+        drop = len;
+    } else if (len > size) {
+        drop = len - size;
+    }
+
+    if (drop != 0) {
+        UART_STATS_ADD(huart, rx_dropped, drop);
+        uart_rx_fifo->read_cnt += drop;
+        uart_rx_fifo->read_ptr =
+            (uart_rx_fifo->read_ptr + drop) % uart_rx_fifo->buf_size;
+        len -= drop;
+    }
+
+    first = uart_rx_fifo->buf_size - uart_rx_fifo->read_ptr;
+    if (first > len) {
+        first = len;
+    }
+
+    memcpy(buf + size - len, uart_rx_fifo->recv_buf + uart_rx_fifo->read_ptr,
+           first);
+    memcpy(buf + size - len + first, uart_rx_fifo->recv_buf, len - first);
+    uart_rx_fifo->read_ptr = (size - len) % size;
+}
+
+#endif /* !UART_STATIC_BUFFER */
+
+/**
+ * @brief Resize the receive buf and fifo of UART.
+ *
+ * @param huart The handle of UART
+ * @param buf_size New buf size
+ * @param fifo_size New fifo size
+ * @return Resize message:
+ *  @retval - 0: Success
+ *  @retval - 1: This uart not enable DMA Rx.
+ *  @retval - 2: Allocate memory failed, the old buf and fifo are kept.
+ *  @retval - 3: Parameter Error, size can't be 0 or larger than 65535.
+ *  @retval - 4: The UART is bridged, the Tx queue of the bridge points into
+ *               the receive buf. Remove the bridge first.
+ *  @retval - 5: Not supported, the buffers are fixed by
+ *               `UART_STATIC_BUFFER`.
+ * @note If the UART is running, the new buf and fifo are allocated first,
+ *       the unread data is moved to them. The received data is handed over
+ *       first, then the DMA is paused only while the last few bytes are
+ *       flushed and the buf is swapped. The UART holds one incoming byte
+ *       (or its Rx FIFO) meanwhile, no data is lost unless the window is
+ *       longer than that at a high baud rate. Otherwise only the size is
+ *       recorded, it takes effect at next `u(s)artx_init()`.
+ * @note Don't call it concurrently with the read functions of this UART.
+ */
+uint8_t uart_dmarx_resize_fifo(UART_HandleTypeDef *huart, uint32_t buf_size,
+                               uint32_t fifo_size) {
+    if ((buf_size == 0) || (buf_size > UINT16_MAX) || (fifo_size == 0)) {
+        return 3;
+    }
+
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+    if (uart_rx_fifo == NULL) {
+        return 1;
+    }
+
+#if UART_STATIC_BUFFER
+    /* The buffers are fixed. */
+    return 5;
+#else  /* UART_STATIC_BUFFER */
+    if (huart->gState == HAL_UART_STATE_RESET) {
+        /* The UART is uninitialized, just adjust the size. */
+        uart_rx_fifo->buf_size = buf_size;
+        uart_rx_fifo->fifo_size = fifo_size;
+        return 0;
+    }
+
+    if (uart_rx_fifo->bridge != NULL) {
+        /* The sending chunks would be freed with the old buf. */
+        return 4;
+    }
+
+    uint8_t *recv_buf = NULL;
+    uint8_t *rx_fifo_buf = NULL;
+    ring_fifo_t *rx_fifo = NULL;
+    uint32_t primask;
+
+    if (huart->hdmarx != NULL) {
+        recv_buf = CSP_MALLOC(buf_size);
+        if (recv_buf == NULL) {
+            return 2;
+        }
+    }
+
+    if (!uart_rx_fifo->zero_copy) {
+        rx_fifo_buf = CSP_MALLOC(fifo_size);
+        if (rx_fifo_buf != NULL) {
+            rx_fifo = ring_fifo_init(rx_fifo_buf, fifo_size, RF_TYPE_STREAM);
+        }
+
+        if (rx_fifo == NULL) {
+            CSP_FREE(rx_fifo_buf);
+            CSP_FREE(recv_buf);
+            return 2;
+        }
+
+        /* DMA keeps receiving to the old buf, the callbacks are held off. */
+        primask = uart_critical_enter();
+        uint32_t dropped = uart_rx_fifo_move(uart_rx_fifo->rx_fifo, rx_fifo);
+        uart_rx_fifo->drop_cnt += dropped;
+        UART_STATS_ADD(huart, rx_dropped, dropped);
+
+        ring_fifo_t *old_fifo = uart_rx_fifo->rx_fifo;
+        uint8_t *old_fifo_buf = uart_rx_fifo->rx_fifo_buf;
+        uart_rx_fifo->rx_fifo = rx_fifo;
+        uart_rx_fifo->rx_fifo_buf = rx_fifo_buf;
+        uart_critical_exit(primask);
+
+        CSP_FREE(old_fifo_buf);
+        ring_fifo_destroy(old_fifo);
+    }
+    uart_rx_fifo->fifo_size = fifo_size;
+
+    if (recv_buf == NULL) {
+        /* Receive by interrupt, there is no DMA buf. */
+        uart_rx_fifo->buf_size = buf_size;
+        return 0;
+    }
+
+    DMA_HandleTypeDef *hdma = huart->hdmarx;
+    uint8_t *old_recv_buf = uart_rx_fifo->recv_buf;
+
+    /* Hand over the data before DMA is paused, only the few bytes after it
+     * are left for the window below. */
+    uart_dmarx_update(huart, uart_rx_fifo);
+
+    primask = uart_critical_enter();
+    __HAL_DMA_DISABLE(hdma);
+
+    /* Flush the rest, the pending events are void. */
+    uart_dmarx_update(huart, uart_rx_fifo);
+    __HAL_DMA_CLEAR_FLAG(hdma, __HAL_DMA_GET_TC_FLAG_INDEX(hdma) |
+                                   __HAL_DMA_GET_HT_FLAG_INDEX(hdma));
+
+    if (uart_rx_fifo->zero_copy) {
+        uart_rx_buf_move(huart, uart_rx_fifo, recv_buf, buf_size);
+    }
+
+    uart_rx_fifo->recv_buf = recv_buf;
+    uart_rx_fifo->buf_size = buf_size;
+    uart_rx_fifo->head_ptr = 0;
+    huart->pRxBuffPtr = recv_buf;
+    huart->RxXferSize = (uint16_t)buf_size;
+
+    /* Restart the DMA with the new buf. */
+    WRITE_REG(hdma->Instance->CMAR, (uint32_t)(uintptr_t)recv_buf);
+    __HAL_DMA_SET_COUNTER(hdma, buf_size);
+    __HAL_DMA_ENABLE(hdma);
+    uart_critical_exit(primask);
+
+    CSP_FREE(old_recv_buf);
+    return 0;
+#endif /* UART_STATIC_BUFFER */
+}
+
+/**
+ * @brief Get the buffer size of UART DMA Rx.
+ *
+ * @param huart The handle of UART.
+ * @return The buffer size of UART.
+ */
+uint32_t uart_dmarx_get_buf_size(UART_HandleTypeDef *huart) {
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+    if (uart_rx_fifo == NULL) {
+        return 0;
+    }
+
+    return uart_rx_fifo->buf_size;
+}
+
+/**
+ * @brief Get the fifo size of UART DMA Rx.
+ *
+ * @param huart The handle of UART.
+ * @return The buffer size of UART.
+ */
+uint32_t uart_dmarx_get_fifo_size(UART_HandleTypeDef *huart) {
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+    if (uart_rx_fifo == NULL) {
+        return 0;
+    }
+
+    return uart_rx_fifo->fifo_size;
+}
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup Public UART DMA Tx functions.
+ * @{
+ */
+
+/**
+ * @brief Identify the UART transmit buffer by handle.
+ *
+ * @param huart The handle of UART
+ * @return The point of UART tx buffer.
+ */
+static inline uart_tx_buf_t *uart_tx_identify(UART_HandleTypeDef *huart) {
+    switch ((uintptr_t)(huart->Instance)) {
+#if LPUART1_TX_DMA
+        case LPUART1_BASE: {
+            return &lpuart1_tx_buf;
+        }
+#endif /* LPUART1_TX_DMA */
+
+#if USART1_TX_DMA
+        case USART1_BASE: {
+            return &usart1_tx_buf;
+        }
+#endif /* USART1_TX_DMA */
+
+#if USART2_TX_DMA
+        case USART2_BASE: {
+            return &usart2_tx_buf;
+        }
+#endif /* USART2_TX_DMA */
+
+#if USART3_TX_DMA
+        case USART3_BASE: {
+            return &usart3_tx_buf;
+        }
+#endif /* USART3_TX_DMA */
+
+#if UART4_TX_DMA
+        case UART4_BASE: {
+            return &uart4_tx_buf;
+        }
+#endif /* UART4_TX_DMA */
+
+#if UART5_TX_DMA
+        case UART5_BASE: {
+            return &uart5_tx_buf;
+        }
+#endif /* UART5_TX_DMA */
+
+        default: {
+        } break;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Lock the filling bank to write.
+ *
+ * @param send_tx_buf The transmit buffer of UART.
+ * @param[out] remain The remain length of the filling bank.
+ * @return The write position of the filling bank. NULL if the bank is locked
+ *         by the writer which is preempted by this one.
+ */
+static uint8_t *uart_dmatx_lock(uart_tx_buf_t *send_tx_buf, uint32_t *remain) {
+    uint32_t primask = uart_critical_enter();
+    if (send_tx_buf->locked) {
+        uart_critical_exit(primask);
+        return NULL;
+    }
+    send_tx_buf->locked = 1;
+    uart_critical_exit(primask);
+
+    *remain = send_tx_buf->buf_size - send_tx_buf->head_ptr;
+    return send_tx_buf->send_buf +
+           send_tx_buf->fill_bank * send_tx_buf->buf_size +
+           send_tx_buf->head_ptr;
+}
+
+/**
+ * @brief Commit the written data and unlock the filling bank.
+ *
+ * @param huart The handle of UART.
+ * @param send_tx_buf The transmit buffer of UART.
+ * @param len The length that is written.
+ */
+static void uart_dmatx_unlock(UART_HandleTypeDef *huart,
+                              uart_tx_buf_t *send_tx_buf, uint32_t len) {
+    send_tx_buf->head_ptr += len;
+    send_tx_buf->locked = 0;
+
+    if (send_tx_buf->deferred) {
+        /* The last transfer completed while we were writing. */
+        uart_dmatx_kick(huart, send_tx_buf);
+    }
+}
+
+/**
+ * @brief Start the next transfer if DMA is idle.
+ *
+ * @param huart The handle of UART.
+ * @param send_tx_buf The transmit buffer of UART.
+ * @return The length which is started to transmit.
+ * @note The filling bank is sent first, then the queued descriptors.
+ */
+static uint32_t uart_dmatx_kick(UART_HandleTypeDef *huart,
+                                uart_tx_buf_t *send_tx_buf) {
+    const uint8_t *data;
+    uint32_t len;
+    uint8_t from_queue;
+    uint32_t primask = uart_critical_enter();
+
+    if ((send_tx_buf->busy) || (huart->gState != HAL_UART_STATE_READY)) {
+        /* The transfer complete callback will start the next one. */
+        uart_critical_exit(primask);
+        return 0;
+    }
+
+    if ((send_tx_buf->head_ptr != 0) && (send_tx_buf->locked == 0)) {
+        data = send_tx_buf->send_buf +
+               send_tx_buf->fill_bank * send_tx_buf->buf_size;
+        len = send_tx_buf->head_ptr;
+        from_queue = 0;
+    } else if (send_tx_buf->queue_count != 0) {
+        uart_tx_desc_t *desc = &send_tx_buf->queue[send_tx_buf->queue_head];
+
+        data = desc->data + send_tx_buf->queue_sent;
+        len = desc->len - send_tx_buf->queue_sent;
+        if (len > UINT16_MAX) {
+            /* Split the huge buffer, DMA transfers 65535 bytes at most. */
+            len = UINT16_MAX;
+        }
+        from_queue = 1;
+    } else {
+        if (send_tx_buf->head_ptr != 0) {
+            /* The writer will start it after it finishes. */
+            send_tx_buf->deferred = 1;
+        }
+        uart_critical_exit(primask);
+        return 0;
+    }
+
+    uart_bus_rx_suspend(huart);
+    if (HAL_UART_Transmit_DMA(huart, data, (uint16_t)len) != HAL_OK) {
+        if (send_tx_buf->busy == 0) {
+            uart_bus_rx_resume(huart);
+        }
+        uart_critical_exit(primask);
+        return 0;
+    }
+
+    send_tx_buf->busy = 1;
+    send_tx_buf->xfer_desc = from_queue;
+    send_tx_buf->xfer_len = (uint16_t)len;
+
+    if (from_queue == 0) {
+        send_tx_buf->deferred = 0;
+        send_tx_buf->fill_bank ^= 1;
+        send_tx_buf->head_ptr = 0;
+    }
+
+    uart_critical_exit(primask);
+    return len;
+}
+
+/**
+ * @brief UART DMA transmit complete callback, start the next transfer.
+ *
+ * @param huart The handle of UART.
+ */
+static void uart_dmatx_done_callback(UART_HandleTypeDef *huart) {
+    uart_tx_buf_t *send_tx_buf = uart_tx_identify(huart);
+    if (send_tx_buf == NULL) {
+        return;
+    }
+
+    uart_tx_desc_t done = {.callback = NULL};
+
+    UART_STATS_ADD(huart, tx_bytes, send_tx_buf->xfer_len);
+
+    if (send_tx_buf->xfer_desc) {
+        uart_tx_desc_t *desc = &send_tx_buf->queue[send_tx_buf->queue_head];
+
+        send_tx_buf->queue_sent += send_tx_buf->xfer_len;
+        if (send_tx_buf->queue_sent >= desc->len) {
+            done = *desc;
+            send_tx_buf->queue_sent = 0;
+            send_tx_buf->queue_head =
+                (send_tx_buf->queue_head + 1) % UART_TX_DMA_QUEUE_SIZE;
+            --send_tx_buf->queue_count;
+        }
+        send_tx_buf->xfer_desc = 0;
+    }
+
+    send_tx_buf->busy = 0;
+    uart_dmatx_kick(huart, send_tx_buf);
+
+    if (send_tx_buf->busy == 0) {
+        /* Nothing more to send, turn the bus around. */
+        uart_bus_rx_resume(huart);
+    }
+
+    if (done.callback != NULL) {
+        /* Give the buffer back after the next transfer is started. */
+        done.callback(huart, done.data, done.len, done.arg);
+    }
+}
+
+/**
+ * @brief Write the transmit data to the buffer.
+ *
+ * @param huart The handle of UART.
+ * @param data The data will be write.
+ * @param len The data length will be written.
+ * @return The length that be written.
+ */
+uint32_t uart_dmatx_write(UART_HandleTypeDef *huart, const void *data,
+                          size_t len) {
+    if ((data == NULL) || (len == 0)) {
+        return 0;
+    }
+
+    uart_tx_buf_t *send_tx_buf = uart_tx_identify(huart);
+    if (send_tx_buf == NULL) {
+        return 0;
+    }
+
+    uint32_t buf_remain;
+    uint8_t *ptr = uart_dmatx_lock(send_tx_buf, &buf_remain);
+    if (ptr == NULL) {
+        return 0;
+    }
+
+    /* Prevent overflow. */
+    if (buf_remain < len) {
+        len = buf_remain;
+    }
+
+    memcpy(ptr, data, len);
+    uart_dmatx_unlock(huart, send_tx_buf, len);
+
+    return len;
+}
+
+/**
+ * @brief Format the string into the transmit buffer and start to send.
+ *
+ * @param huart The handle of UART.
+ * @param __format The string with format.
+ * @param ap The arguments.
+ * @return The number of characters that are written to the transmit buffer.
+ */
+static int uart_dmatx_vprintf(UART_HandleTypeDef *huart, const char *__format,
+                              va_list ap) {
+    uart_tx_buf_t *send_tx_buf = uart_tx_identify(huart);
+    if (send_tx_buf == NULL) {
+        return 0;
+    }
+
+#if UART_PRINTF_FULL_POLICY == UART_PRINTF_BLOCK
+    uint8_t retried = 0;
+#endif /* UART_PRINTF_FULL_POLICY == UART_PRINTF_BLOCK */
+    uint32_t buf_remain;
+    char *ptr;
+    va_list aq;
+    int len;
+
+    for (;;) {
+        ptr = (char *)uart_dmatx_lock(send_tx_buf, &buf_remain);
+        if (ptr == NULL) {
+            return 0;
+        }
+
+        va_copy(aq, ap);
+        len = UART_VSNPRINTF(ptr, buf_remain, __format, aq);
+        va_end(aq);
+
+        if (len < 0) {
+            uart_dmatx_unlock(huart, send_tx_buf, 0);
+            return 0;
+        }
+
+        if ((uint32_t)len < buf_remain) {
+            break;
+        }
+
+#if UART_PRINTF_FULL_POLICY == UART_PRINTF_BLOCK
+        if ((retried == 0) && (buf_remain < send_tx_buf->buf_size) &&
+            (__get_IPSR() == 0) && (__get_PRIMASK() == 0)) {
+            /* Wait for the other bank and try again with a whole bank, at
+             * most twice the time to send a bank (10 bits a byte), plus a
+             * tick for the resolution of `HAL_GetTick`. */
+            uint32_t timeout =
+                2U * send_tx_buf->buf_size * 10000U / huart->Init.BaudRate +
+                1U;
+            uint32_t tickstart = HAL_GetTick();
+
+            uart_dmatx_unlock(huart, send_tx_buf, 0);
+            uart_dmatx_kick(huart, send_tx_buf);
+            while (send_tx_buf->head_ptr != 0) {
+                if ((send_tx_buf->busy == 0) &&
+                    (uart_dmatx_kick(huart, send_tx_buf) == 0)) {
+                    /* DMA is not sending, it will not make progress. */
+                    break;
+                }
+
+                if (HAL_GetTick() - tickstart > timeout) {
+                    break;
+                }
+
+                __WFI();
+            }
+            retried = 1;
+            continue;
+        }
+#endif /* UART_PRINTF_FULL_POLICY == UART_PRINTF_BLOCK */
+
+#if UART_PRINTF_FULL_POLICY == UART_PRINTF_DROP
+        len = 0;
+#else  /* UART_PRINTF_FULL_POLICY == UART_PRINTF_DROP */
+        /* The formatter keeps the last byte for '\0'. */
+        len = (buf_remain != 0) ? (int)buf_remain - 1 : 0;
+#endif /* UART_PRINTF_FULL_POLICY == UART_PRINTF_DROP */
+        break;
+    }
+
+    uart_dmatx_unlock(huart, send_tx_buf, len);
+    uart_dmatx_kick(huart, send_tx_buf);
+
+    return len;
+}
+
+/**
+ * @brief Transmit the data in the buf.
+ *
+ * @param huart The handle of UART.
+ * @return The length which is started to transmit. 0 if the last transfer
+ *         is not finished, the data will be sent automatically when it
+ *         finishes.
+ * @note If you want transmit data, using `uart_dmatx_write` before.
+ *       This function never waits, the other bank can be written while
+ *       the data is transferring.
+ */
+uint32_t uart_dmatx_send(UART_HandleTypeDef *huart) {
+    uart_tx_buf_t *send_tx_buf = uart_tx_identify(huart);
+    if (send_tx_buf == NULL) {
+        return 0;
+    }
+
+    if (huart->hdmatx == NULL) {
+        return 0;
+    }
+
+    return uart_dmatx_kick(huart, send_tx_buf);
+}
+
+/**
+ * @brief Queue a buffer to transmit without copying it.
+ *
+ * @param huart The handle of UART.
+ * @param data The data to transmit, it must stay valid until `callback`.
+ * @param len The length of data.
+ * @param callback Called in interrupt when the buffer is sent, can be NULL.
+ * @param arg The argument of callback.
+ * @return Enqueue message:
+ *  @retval - 0: Success
+ *  @retval - 1: This uart not enable DMA Tx.
+ *  @retval - 2: The queue is full.
+ *  @retval - 3: Parameter error.
+ * @note The buffers are sent back to back in the order they are queued.
+ *       Data written by `uart_dmatx_write` is sent between them, at the
+ *       boundary of each transfer.
+ */
+uint8_t uart_dmatx_enqueue(UART_HandleTypeDef *huart, const void *data,
+                           size_t len, uart_tx_cplt_cb_t callback, void *arg) {
+    if ((data == NULL) || (len == 0)) {
+        return 3;
+    }
+
+    uart_tx_buf_t *send_tx_buf = uart_tx_identify(huart);
+    if ((send_tx_buf == NULL) || (huart->hdmatx == NULL)) {
+        return 1;
+    }
+
+    uint32_t primask = uart_critical_enter();
+
+    if (send_tx_buf->queue_count >= UART_TX_DMA_QUEUE_SIZE) {
+        uart_critical_exit(primask);
+        return 2;
+    }
+
+    uart_tx_desc_t *desc =
+        &send_tx_buf->queue[(send_tx_buf->queue_head +
+                             send_tx_buf->queue_count) %
+                            UART_TX_DMA_QUEUE_SIZE];
+    desc->data = data;
+    desc->len = len;
+    desc->callback = callback;
+    desc->arg = arg;
+    ++send_tx_buf->queue_count;
+
+    uart_critical_exit(primask);
+
+    uart_dmatx_kick(huart, send_tx_buf);
+    return 0;
+}
+
+#if UART_LOG_ENABLE
+
+/**
+ * @brief Write a binary log record to the Tx buffer and start transmit.
+ *
+ * @param huart The handle of UART.
+ * @param fmt The format string in `.uart_log_fmt` section.
+ * @param args The arguments.
+ * @param nargs The number of arguments.
+ * @return Write message:
+ *  @retval - 0: Success
+ *  @retval - 1: This uart not enable DMA Tx.
+ *  @retval - 2: The record is dropped, buffer is full or being written.
+ *  @retval - 3: More than `UART_LOG_MAX_ARGS` arguments, the record is
+ *               dropped. `uart_log` checks it at compile time.
+ * @note Use `uart_log` instead. It never waits, so it can be called in
+ *       interrupt. The record is
+ *       | sync | nargs | ID (4) | timestamp (4) | args (4 * nargs) | xor |
+ *       in little endian, xor is the checksum of all the bytes before it.
+ */
+uint8_t uart_log_write(UART_HandleTypeDef *huart, const char *fmt,
+                       const uint32_t *args, uint32_t nargs) {
+    uint32_t buf_remain, len, i;
+    uint32_t timestamp = UART_LOG_TIMESTAMP();
+    uint32_t id = (uint32_t)(uintptr_t)fmt;
+    uint8_t *ptr, check = 0;
+
+    uart_tx_buf_t *send_tx_buf = uart_tx_identify(huart);
+    if ((send_tx_buf == NULL) || (huart->hdmatx == NULL)) {
+        return 1;
+    }
+
+    if (nargs > UART_LOG_MAX_ARGS) {
+        /* The decoder would miss the arguments of format. */
+        return 3;
+    }
+    len = UART_LOG_HEAD_SIZE + nargs * sizeof(uint32_t) + 1;
+
+    ptr = uart_dmatx_lock(send_tx_buf, &buf_remain);
+    if (ptr == NULL) {
+        return 2;
+    }
+
+    if (buf_remain < len) {
+        uart_dmatx_unlock(huart, send_tx_buf, 0);
+        return 2;
+    }
+
+    ptr[0] = UART_LOG_SYNC;
+    ptr[1] = (uint8_t)nargs;
+    memcpy(&ptr[2], &id, sizeof(id));
+    memcpy(&ptr[6], &timestamp, sizeof(timestamp));
+    memcpy(&ptr[UART_LOG_HEAD_SIZE], args, nargs * sizeof(uint32_t));
+
+    for (i = 0; i < len - 1; ++i) {
+        check ^= ptr[i];
+    }
+    ptr[len - 1] = check;
+
+    uart_dmatx_unlock(huart, send_tx_buf, len);
+    uart_dmatx_kick(huart, send_tx_buf);
+
+    return 0;
+}
+
+#endif /* UART_LOG_ENABLE */
+
+/**
+ * @brief Resize the send buf of UART.
+ *
+ * @param huart The handle of UART
+ * @param size New size
+ * @return Resize message:
+ *  @retval - 0: Success
+ *  @retval - 1: This uart not enable DMA Tx.
+ *  @retval - 2: No free memory to allocate.
+ *  @retval - 3: This uart is busy now.
+ *  @retval - 4: Parameter error, size can't be 0.
+ *  @retval - 5: Not supported, the buffer is fixed by
+ *               `UART_STATIC_BUFFER`.
+ */
+uint8_t uart_dmatx_resize_buf(UART_HandleTypeDef *huart, uint32_t size) {
+    if (size == 0) {
+        return 4;
+    }
+
+    uart_tx_buf_t *send_tx_buf = uart_tx_identify(huart);
+    if (send_tx_buf == NULL) {
+        return 1;
+    }
+
+#if UART_STATIC_BUFFER
+    /* The buffer is fixed. */
+    return 5;
+#else  /* UART_STATIC_BUFFER */
+    if (((huart->gState) & (HAL_UART_STATE_BUSY_TX | HAL_UART_STATE_BUSY) &
+         ~HAL_UART_STATE_READY) ||
+        (send_tx_buf->busy) || (send_tx_buf->locked)) {
+        /* The UART is busy. */
+        return 3;
+    }
+
+    /* The UART is uninitialized, just adjust the size. */
+    if (huart->hdmatx == NULL) {
+        send_tx_buf->buf_size = size;
+        return 0;
+    }
+
+    if (send_tx_buf->fill_bank != 0) {
+        /* Move the pending data to the first bank. */
+        memmove(send_tx_buf->send_buf,
+                send_tx_buf->send_buf + send_tx_buf->buf_size,
+                send_tx_buf->head_ptr);
+        send_tx_buf->fill_bank = 0;
+    }
+
+    uint8_t *new_ptr = CSP_REALLOC(send_tx_buf->send_buf, size * 2);
+
+    if (new_ptr == NULL) {
+        return 2;
+    }
+
+    send_tx_buf->send_buf = new_ptr;
+    send_tx_buf->buf_size = size;
+    if (send_tx_buf->head_ptr > size) {
+        send_tx_buf->head_ptr = size;
+    }
+
+    return 0;
+#endif /* UART_STATIC_BUFFER */
+}
+
+/**
+ * @brief Get the buffer size of UART DMA Tx.
+ *
+ * @param huart The handle of UART.
+ * @return The size of UART DMA Tx buf.
+ */
+uint32_t uart_damtx_get_buf_szie(UART_HandleTypeDef *huart) {
+    uart_tx_buf_t *uart_tx_buf = uart_tx_identify(huart);
+
+    if (uart_tx_buf == NULL) {
+        return 0;
+    }
+
+    return uart_tx_buf->buf_size;
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup Public UART line reader functions.
+ * @{
+ */
+
+/**
+ * @brief Initialize the line reader.
+ *
+ * @param line The line reader.
+ * @param buf The line buffer, the longest line is `size - 1` bytes.
+ * @param size The size of buf.
+ */
+void uart_line_init(uart_line_t *line, char *buf, uint32_t size) {
+    if (line == NULL) {
+        return;
+    }
+
+    memset(line, 0, sizeof(uart_line_t));
+    line->buf = buf;
+    line->size = size;
+}
+
+/**
+ * @brief Read a line which ends with the delimiter, don't wait.
+ *
+ * @param huart The handle of UART
+ * @param line The line reader.
+ * @param delim The delimiter.
+ * @param[out] len The length of line, without the delimiter. Can be NULL.
+ * @return The line in the line buffer, the delimiter is replaced by '\0'.
+ *         It is valid until the next call. NULL if no complete line.
+ * @note The new received bytes are appended to the line buffer, only they
+ *       are scanned for the delimiter. A partial line is kept for the next
+ *       call. A line longer than the buffer is dropped.
+ */
+char *uart_read_until(UART_HandleTypeDef *huart, uart_line_t *line,
+                      uint8_t delim, uint32_t *len) {
+    char *pos;
+
+    if ((line == NULL) || (line->buf == NULL) || (line->size < 2)) {
+        return NULL;
+    }
+
+    while (1) {
+        if (line->line != 0) {
+            /* Remove the line returned last time. */
+            line->len -= line->line;
+            memmove(line->buf, line->buf + line->line, line->len);
+            line->line = 0;
+            line->scan = 0;
+        }
+
+        while ((pos = memchr(line->buf + line->scan, delim,
+                             line->len - line->scan)) == NULL) {
+            line->scan = line->len;
+
+            if (line->len == line->size - 1) {
+                /* The line is too long, drop it until the next delimiter. */
+                line->dropped += line->len;
+                line->overflow = 1;
+                line->len = 0;
+                line->scan = 0;
+            }
+
+            uint32_t read = uart_dmarx_read(huart, line->buf + line->len,
+                                            line->size - 1 - line->len);
+            if (read == 0) {
+                return NULL;
+            }
+            line->len += read;
+        }
+
+        line->line = (uint32_t)(pos - line->buf) + 1;
+
+        if (line->overflow) {
+            /* The tail of a long line. */
+            line->dropped += line->line;
+            line->overflow = 0;
+            continue;
+        }
+
+        break;
+    }
+
+    *pos = '\0';
+    if (len != NULL) {
+        *len = line->line - 1;
+    }
+
+    return line->buf;
+}
+
+/**
+ * @brief Read a line which ends with "\n" or "\r\n", wait until it is
+ *        received.
+ *
+ * @param huart The handle of UART
+ * @param line The line reader.
+ * @param[out] len The length of line, without the line ending. Can be NULL.
+ * @param timeout Timeout in ms, `HAL_MAX_DELAY` to wait forever.
+ * @return The line in the line buffer, valid until the next call. NULL if
+ *         timeout, or at once if `line` is not initialized.
+ * @note It sleeps in `uart_dmarx_wait` between the Rx callbacks, do not
+ *       call it in interrupt.
+ */
+char *uart_readline(UART_HandleTypeDef *huart, uart_line_t *line,
+                    uint32_t *len, uint32_t timeout) {
+    uint32_t start = HAL_GetTick();
+    uint32_t line_len, elapsed;
+    char *str;
+
+    if ((line == NULL) || (line->buf == NULL) || (line->size < 2)) {
+        /* `uart_read_until` would never return a line. */
+        return NULL;
+    }
+
+    if (uart_rx_identify(huart) == NULL) {
+        return NULL;
+    }
+
+    while ((str = uart_read_until(huart, line, '\n', &line_len)) == NULL) {
+        elapsed = HAL_GetTick() - start;
+        if (timeout != HAL_MAX_DELAY) {
+            if (elapsed >= timeout) {
+                return NULL;
+            }
+            uart_dmarx_wait(huart, timeout - elapsed);
+        } else {
+            uart_dmarx_wait(huart, HAL_MAX_DELAY);
+        }
+    }
+
+    if ((line_len != 0) && (str[line_len - 1] == '\r')) {
+        str[--line_len] = '\0';
+    }
+
+    if (len != NULL) {
+        *len = line_len;
+    }
+
+    return str;
+}
+
+/**
+ * @brief Split a string into tokens in place.
+ *
+ * @param str The string, the delimiters are replaced by '\0'.
+ * @param delims The delimiter characters, e.g. " \t" or " =,".
+ * @param[out] argv The tokens.
+ * @param max_args The size of argv, the rest of string is the last token.
+ * @return The number of tokens.
+ * @note Empty tokens are skipped. A token in double quotes may contain the
+ *       delimiters, the quotes are removed.
+ */
+uint32_t uart_tokenize(char *str, const char *delims, char *argv[],
+                       uint32_t max_args) {
+    uint32_t argc = 0;
+
+    if ((str == NULL) || (delims == NULL) || (argv == NULL)) {
+        return 0;
+    }
+
+    while (argc < max_args) {
+        while ((*str != '\0') && (strchr(delims, *str) != NULL)) {
+            ++str;
+        }
+
+        if (*str == '\0') {
+            break;
+        }
+
+        if (argc == max_args - 1) {
+            /* The last one takes the rest. */
+            argv[argc++] = str;
+            break;
+        }
+
+        if (*str == '"') {
+            argv[argc++] = ++str;
+            str = strchr(str, '"');
+        } else {
+            argv[argc++] = str;
+            str += strcspn(str, delims);
+        }
+
+        if ((str == NULL) || (*str == '\0')) {
+            break;
+        }
+        *str++ = '\0';
+    }
+
+    return argc;
+}
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup Public UART bridge functions.
+ * @{
+ */
+
+/**
+ * @brief The bridge has sent a received chunk.
+ *
+ * @param huart The handle of UART which sends.
+ * @param data The chunk in receive buf.
+ * @param len The length of chunk.
+ * @param arg The handle of UART which receives.
+ */
+static void uart_bridge_tx_done(UART_HandleTypeDef *huart, const void *data,
+                                size_t len, void *arg) {
+    UART_HandleTypeDef *from = arg;
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(from);
+    UNUSED(huart);
+    UNUSED(data);
+
+    if ((uart_rx_fifo == NULL) || (uart_rx_fifo->bridge != huart)) {
+        /* The bridge is removed. */
+        return;
+    }
+
+    /* The Rx IRQ of `from` may run at another priority. */
+    uint32_t primask = uart_critical_enter();
+    uart_rx_fifo->read_cnt += len;
+
+    if (uart_rx_fifo->bridge_pause &&
+        (uart_rx_fifo->recv_cnt - uart_rx_fifo->read_cnt <=
+         (uart_rx_fifo->buf_size >> 2))) {
+        uart_rx_fifo->bridge_pause = 0;
+        SET_BIT(from->Instance->CR3, USART_CR3_DMAR);
+    }
+    uart_critical_exit(primask);
+}
+
+/**
+ * @brief Forward the received data to the bridged UART.
+ *
+ * @param huart The handle of UART which receives.
+ * @param uart_rx_fifo The receive fifo of UART.
+ * @param data The new received data.
+ * @param len The length of data.
+ * @note Called in the Rx callbacks. DMA Tx sends from the receive buf
+ *       directly, the chunk is released when it is sent.
+ */
+static void uart_bridge_forward(UART_HandleTypeDef *huart,
+                                uart_rx_fifo_t *uart_rx_fifo,
+                                const uint8_t *data, uint32_t len) {
+    UART_HandleTypeDef *to = uart_rx_fifo->bridge;
+    uart_tx_buf_t *send_tx_buf = uart_tx_identify(to);
+    uint32_t written = 0;
+    uint32_t primask;
+
+    if (len == 0) {
+        return;
+    }
+
+    if (huart->hdmarx != NULL) {
+        if (uart_dmatx_enqueue(to, data, len, uart_bridge_tx_done, huart) ==
+            0) {
+            /* `uart_bridge_tx_done` runs in the Tx DMA IRQ of `to`, which may
+             * preempt here. Decide with its count. */
+            primask = uart_critical_enter();
+            if (uart_rx_fifo->bridge_flow &&
+                (uart_rx_fifo->recv_cnt - uart_rx_fifo->read_cnt >
+                 (uart_rx_fifo->buf_size >> 1))) {
+                /* Stop the DMA request, the receiver holds RTS (if enabled). */
+                uart_rx_fifo->bridge_pause = 1;
+                CLEAR_BIT(huart->Instance->CR3, USART_CR3_DMAR);
+            }
+            uart_critical_exit(primask);
+            return;
+        }
+
+        /* The queue is full. The filling bank is sent before the queue, a copy
+         * would overtake the pending chunks, drop it instead. */
+        primask = uart_critical_enter();
+        if (uart_rx_fifo->bridge_flow &&
+            (uart_rx_fifo->recv_cnt - uart_rx_fifo->read_cnt > len)) {
+            /* Hold the rest until a chunk is sent. Not if the queue has been
+             * sent meanwhile, nothing would resume. */
+            uart_rx_fifo->bridge_pause = 1;
+            CLEAR_BIT(huart->Instance->CR3, USART_CR3_DMAR);
+        }
+        uart_rx_fifo->read_cnt += len;
+        uart_critical_exit(primask);
+    } else {
+        if ((send_tx_buf != NULL) && (send_tx_buf->queue_count == 0)) {
+            /* Receive by interrupt, copy to the Tx buf. */
+            written = uart_dmatx_write(to, data, len);
+            uart_dmatx_send(to);
+        }
 
-    offset = (uart_rx_fifo->head_ptr) % (uint32_t)(huart->RxXferSize);
-    copy = tail_ptr - offset;
-    uart_rx_fifo->head_ptr += copy;
+        primask = uart_critical_enter();
+        uart_rx_fifo->read_cnt += len;
+        uart_critical_exit(primask);
+    }
 
-    ring_fifo_write(uart_rx_fifo->rx_fifo, huart->pRxBuffPtr + offset, copy);
+    if (written < len) {
+        uart_rx_fifo->drop_cnt += len - written;
+        UART_STATS_ADD(huart, rx_dropped, len - written);
+    }
 }
 
 /**
- * @brief UART DMA overflow callback.
+ * @brief Forward the received data of a UART to another one by DMA Tx.
  *
- * @param huart The handle of UART
+ * @param from The handle of UART which receives.
+ * @param to The handle of UART which sends, NULL to remove the bridge.
+ * @param flow_control Pause DMA Rx of `from` when half of the receive buf is
+ *                     waiting to be sent, resume when a quarter is left.
+ *                     Enable RTS of `from` to stop the remote sender.
+ * @return Bridge message:
+ *  @retval - 0: Success
+ *  @retval - 1: `from` not enable Rx.
+ *  @retval - 2: `to` not enable DMA Tx.
+ * @note Each Rx event (idle, half or full) starts the transfer from the
+ *       receive buf, there is no copy. The data is not readable on `from`
+ *       while bridged. Call it twice for both directions. Without flow
+ *       control, the data is overwritten if `to` is slower than `from`, and
+ *       a chunk is dropped when the Tx queue of `to` is full.
  */
-void uart_dmarx_done_callback(UART_HandleTypeDef *huart) {
-    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+uint8_t uart_bridge(UART_HandleTypeDef *from, UART_HandleTypeDef *to,
+                    uint8_t flow_control) {
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(from);
     if (uart_rx_fifo == NULL) {
-        return;
+        return 1;
     }
 
-    uint32_t tail_ptr;
-    uint32_t offset, copy;
-
-    /**
-     * +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~+
-     * |                  half                  |
-     * |                    | head_ptr tail_ptr |
-     * |                    |    |            | |
-     * |                    v    v            v |
-     * | ------------------------************** |
-     * +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~+
-     */
-
-    tail_ptr = huart->RxXferSize;
-
-    offset = (uart_rx_fifo->head_ptr) % (uint32_t)(huart->RxXferSize);
-    copy = tail_ptr - offset;
-    uart_rx_fifo->head_ptr += copy;
-
-    ring_fifo_write(uart_rx_fifo->rx_fifo, huart->pRxBuffPtr + offset, copy);
+    if ((to != NULL) && (to->hdmatx == NULL)) {
+        return 2;
+    }
 
-    if (huart->hdmarx->Init.Mode != DMA_CIRCULAR) {
-        /* Reopen the DMA receive. */
-        while (HAL_UART_Receive_DMA(huart, huart->pRxBuffPtr,
-                                    huart->RxXferSize) != HAL_OK) {
-            __HAL_UNLOCK(huart);
+    uint32_t primask = uart_critical_enter();
+    if (uart_rx_fifo->zero_copy || (uart_rx_fifo->bridge != NULL)) {
+        /* Skip the data which is unread or being forwarded. */
+        uart_rx_fifo->read_cnt = uart_rx_fifo->recv_cnt;
+        if (from->hdmarx != NULL) {
+            uart_rx_fifo->read_ptr =
+                uart_rx_fifo->head_ptr % uart_rx_fifo->buf_size;
         }
     }
+    uart_rx_fifo->bridge = to;
+    uart_rx_fifo->bridge_flow = flow_control;
+    if (uart_rx_fifo->bridge_pause) {
+        uart_rx_fifo->bridge_pause = 0;
+        SET_BIT(from->Instance->CR3, USART_CR3_DMAR);
+    }
+    uart_critical_exit(primask);
+
+    return 0;
 }
 
 /**
- * @brief Read from UART Receive fifo.
- *
- * @param huart The handle of UART
- * @param[out] buf The data buf which receive the data from the fifo.
- * @param buf_size The size of buf.
- * @return The length that be received.
+ * @}
  */
-uint32_t uart_dmarx_read(UART_HandleTypeDef *huart, void *buf,
-                         size_t buf_size) {
-    if ((buf == NULL) || (buf_size == 0)) {
-        return 0;
-    }
-    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
 
-    if (uart_rx_fifo == NULL) {
-        return 0;
+/*****************************************************************************
+ * @defgroup Public UART Modbus RTU functions.
+ * @{
+ */
+
+/**
+ * @brief Get the receiver timeout of 3.5 characters.
+ *
+ * @param baud_rate The baud rate.
+ * @return The timeout in bit time.
+ * @note 3.5 * 11 bits, or fixed 1750us above 19200 baud (Modbus over serial
+ *       line, 2.5.1.1).
+ */
+static uint32_t uart_modbus_rto(uint32_t baud_rate) {
+    if (baud_rate > 19200) {
+        return (uint32_t)(((uint64_t)baud_rate * 1750 + 999999) / 1000000);
     }
 
-    return ring_fifo_read(uart_rx_fifo->rx_fifo, buf, buf_size);
+    return 39;
 }
 
 /**
- * @brief Resize the receive buf and fifo of UART.
+ * @brief Start to receive Modbus RTU frames.
  *
  * @param huart The handle of UART
- * @param buf_size New buf size
- * @param fifo_size New fifo size
- * @return Resize message:
+ * @param buf The buffer of frame, 256 bytes for a full RTU frame.
+ * @param size The size of buf.
+ * @param callback Called in interrupt with the frame (CRC is checked and
+ *                 removed) when the 3.5 characters gap is detected.
+ * @param arg The argument of callback.
+ * @return Start message:
  *  @retval - 0: Success
- *  @retval - 1: This uart not enable DMA Rx.
- *  @retval - 2: This UART is enabled.
- *  @retval - 3: Parameter Error, size can't be 0.
- * @warning Must be disabled the UART before resize!
- *          You should call `u(s)artx_deinit()` before call this function,
- *          than call `u(s)artx_init()` to using new size.
- *          It may allocated fail when reinitialize uart.
+ *  @retval - 1: This uart not enable DMA Rx or interrupt Rx.
+ *  @retval - 2: Parameter error.
+ *  @retval - 3: LPUART has no receiver timeout.
+ * @note The gap is detected by the receiver timeout (RTO) of USART, the
+ *       bytes are collected from the DMA Rx ring (or interrupt Rx).
  */
-uint8_t uart_dmarx_resize_fifo(UART_HandleTypeDef *huart, uint32_t buf_size,
-                               uint32_t fifo_size) {
-    if ((buf_size == 0) || (fifo_size == 0)) {
+uint8_t uart_modbus_start(UART_HandleTypeDef *huart, uint8_t *buf,
+                          uint32_t size, uart_rx_frame_cb_t callback,
+                          void *arg) {
+    if (IS_LPUART_INSTANCE(huart->Instance)) {
         return 3;
     }
 
-    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
-    if (uart_rx_fifo == NULL) {
-        return 1;
+    uint8_t res = uart_dmarx_set_frame(huart, UART_FRAME_MODBUS, buf, size,
+                                       callback, arg);
+    if (res != 0) {
+        return res;
     }
 
-    if (huart->hdmatx != NULL) {
-        return 2;
-    }
+    HAL_UART_ReceiverTimeout_Config(huart,
+                                    uart_modbus_rto(huart->Init.BaudRate));
+    HAL_UART_EnableReceiverTimeout(huart);
+    __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_RTOF);
+    __HAL_UART_ENABLE_IT(huart, UART_IT_RTO);
 
-    uart_rx_fifo->buf_size = buf_size;
-    uart_rx_fifo->fifo_size = fifo_size;
     return 0;
 }
 
 /**
- * @brief Get the buffer size of UART DMA Rx.
+ * @brief Stop to receive Modbus RTU frames.
  *
- * @param huart The handle of UART.
- * @return The buffer size of UART.
+ * @param huart The handle of UART
+ * @return Stop message:
+ *  @retval - 0: Success
+ *  @retval - 1: This uart not enable DMA Rx or interrupt Rx.
  */
-uint32_t uart_dmarx_get_buf_size(UART_HandleTypeDef *huart) {
-    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
-    if (uart_rx_fifo == NULL) {
-        return 0;
+uint8_t uart_modbus_stop(UART_HandleTypeDef *huart) {
+    if (uart_rx_identify(huart) == NULL) {
+        return 1;
     }
 
-    return uart_rx_fifo->buf_size;
+    __HAL_UART_DISABLE_IT(huart, UART_IT_RTO);
+    HAL_UART_DisableReceiverTimeout(huart);
+
+    return uart_dmarx_set_frame(huart, UART_FRAME_NONE, NULL, 0, NULL, NULL);
 }
 
 /**
- * @brief Get the fifo size of UART DMA Rx.
+ * @brief Send a Modbus RTU frame, CRC is appended.
  *
- * @param huart The handle of UART.
- * @return The buffer size of UART.
+ * @param huart The handle of UART
+ * @param data The frame without CRC (address, function and data).
+ * @param len The length of data.
+ * @return Send message:
+ *  @retval - 0: Success
+ *  @retval - 1: This uart not enable DMA Tx.
+ *  @retval - 2: Tx buffer is full or being written.
+ *  @retval - 3: Parameter error.
+ * @note The request is delivered 3.5 characters after its last byte, so a
+ *       reply from the callback already keeps the turnaround gap.
  */
-uint32_t uart_dmarx_get_fifo_size(UART_HandleTypeDef *huart) {
-    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
-    if (uart_rx_fifo == NULL) {
-        return 0;
+uint8_t uart_modbus_reply(UART_HandleTypeDef *huart, const void *data,
+                          size_t len) {
+    uint32_t buf_remain;
+    uint16_t crc;
+    uint8_t *ptr;
+
+    if ((data == NULL) || (len == 0)) {
+        return 3;
     }
 
-    return uart_rx_fifo->fifo_size;
+    uart_tx_buf_t *send_tx_buf = uart_tx_identify(huart);
+    if ((send_tx_buf == NULL) || (huart->hdmatx == NULL)) {
+        return 1;
+    }
+
+    ptr = uart_dmatx_lock(send_tx_buf, &buf_remain);
+    if (ptr == NULL) {
+        return 2;
+    }
+
+    if (buf_remain < len + 2) {
+        uart_dmatx_unlock(huart, send_tx_buf, 0);
+        return 2;
+    }
+
+    crc = uart_crc16_modbus(data, len);
+    memcpy(ptr, data, len);
+    ptr[len] = (uint8_t)(crc & 0xFF);
+    ptr[len + 1] = (uint8_t)(crc >> 8);
+
+    uart_dmatx_unlock(huart, send_tx_buf, len + 2);
+    uart_dmatx_kick(huart, send_tx_buf);
+
+    return 0;
 }
+
 /**
  * @}
  */
 
 /*****************************************************************************
- * @defgroup Public UART DMA Tx functions.
+ * @defgroup Newlib stdio retarget functions.
  * @{
  */
 
+#if (LPUART1_STDIO + USART1_STDIO + USART2_STDIO + USART3_STDIO +              \
+     UART4_STDIO + UART5_STDIO) > 1
+#error "Only one UART can be retargeted to stdio!"
+#endif
+
+#if LPUART1_STDIO
+#define UART_STDIO        (&lpuart1_handle)
+#define UART_STDIO_TX_DMA LPUART1_TX_DMA
+#elif USART1_STDIO
+#define UART_STDIO        (&usart1_handle)
+#define UART_STDIO_TX_DMA USART1_TX_DMA
+#elif USART2_STDIO
+#define UART_STDIO        (&usart2_handle)
+#define UART_STDIO_TX_DMA USART2_TX_DMA
+#elif USART3_STDIO
+#define UART_STDIO        (&usart3_handle)
+#define UART_STDIO_TX_DMA USART3_TX_DMA
+#elif UART4_STDIO
+#define UART_STDIO        (&uart4_handle)
+#define UART_STDIO_TX_DMA UART4_TX_DMA
+#elif UART5_STDIO
+#define UART_STDIO        (&uart5_handle)
+#define UART_STDIO_TX_DMA UART5_TX_DMA
+#endif
+
+#ifdef UART_STDIO
+
+#define UART_STDIN_FILENO  0
+#define UART_STDOUT_FILENO 1
+#define UART_STDERR_FILENO 2
+
 /**
- * @brief Identify the UART transmit buffer by handle.
+ * @brief Set the stdio buffering to match the UART buffers.
  *
- * @param huart The handle of UART
- * @return The point of UART tx buffer.
+ * @note Called by `u(s)artx_init()`. stdout is line buffered with the size
+ *       of Tx buffer, so a line is passed to `_write` at once. stderr is
+ *       unbuffered.
  */
-static inline uart_tx_buf_t *uart_tx_identify(UART_HandleTypeDef *huart) {
-    switch ((uintptr_t)(huart->Instance)) {
-#if LPUART1_TX_DMA
-        case LPUART1_BASE: {
-            return &lpuart1_tx_buf;
-        }
-#endif /* LPUART1_TX_DMA */
-
-#if USART1_TX_DMA
-        case USART1_BASE: {
-            return &usart1_tx_buf;
-        }
-#endif /* USART1_TX_DMA */
-
-#if USART2_TX_DMA
-        case USART2_BASE: {
-            return &usart2_tx_buf;
-        }
-#endif /* USART2_TX_DMA */
-
-#if USART3_TX_DMA
-        case USART3_BASE: {
-            return &usart3_tx_buf;
-        }
-#endif /* USART3_TX_DMA */
-
-#if UART4_TX_DMA
-        case UART4_BASE: {
-            return &uart4_tx_buf;
-        }
-#endif /* UART4_TX_DMA */
-
-#if UART5_TX_DMA
-        case UART5_BASE: {
-            return &uart5_tx_buf;
-        }
-#endif /* UART5_TX_DMA */
-
-        default: {
-        } break;
+void uart_stdio_init(void) {
+    static char stdout_buf[UART_FORMAT_BUF_SIZE];
+    uint32_t size = sizeof(stdout_buf);
+
+#if UART_STDIO_TX_DMA
+    size = uart_damtx_get_buf_szie(UART_STDIO);
+    if (size > sizeof(stdout_buf)) {
+        /* Let newlib allocate it. */
+        setvbuf(stdout, NULL, _IOLBF, size);
+    } else
+#endif /* UART_STDIO_TX_DMA */
+    {
+        setvbuf(stdout, stdout_buf, _IOLBF, size);
     }
 
-    return NULL;
+    setvbuf(stderr, NULL, _IONBF, 0);
 }
 
 /**
- * @brief Write the transmit data to the buffer.
+ * @brief Newlib write syscall, stdout and stderr are sent by UART.
  *
- * @param huart The handle of UART.
- * @param data The data will be write.
- * @param len The data length will be written.
- * @return The length that be written.
+ * @param file The file descriptor.
+ * @param ptr The data.
+ * @param len The length of data.
+ * @return The length that be written, -1 on error.
+ * @note With DMA Tx the data is copied to the Tx buffer and sent at once,
+ *       newlib has buffered it already (line buffered, buffer full or
+ *       `fflush`). It waits only when the buffer is full, and never waits
+ *       in interrupt or with interrupts masked (the Tx DMA interrupt could
+ *       not free the buffer), the written length is returned then.
  */
-uint32_t uart_dmatx_write(UART_HandleTypeDef *huart, const void *data,
-                          size_t len) {
-    if ((data == NULL) || (len == 0)) {
-        return 0;
-    }
+int _write(int file, char *ptr, int len) {
+    UART_HandleTypeDef *huart = UART_STDIO;
 
-    uart_tx_buf_t *send_tx_buf = uart_tx_identify(huart);
-    if (send_tx_buf == NULL) {
-        return 0;
+    if ((file != UART_STDOUT_FILENO) && (file != UART_STDERR_FILENO)) {
+        errno = EBADF;
+        return -1;
     }
 
-    /* Get the remain length of buffer. */
-    uint32_t buf_remain = send_tx_buf->buf_size - send_tx_buf->head_ptr;
-
-    /* Prevent overflow. */
-    if (buf_remain < len) {
-        memcpy(send_tx_buf->send_buf + send_tx_buf->head_ptr, data, buf_remain);
-        send_tx_buf->head_ptr += buf_remain;
-        return buf_remain;
-    } else {
-        memcpy(send_tx_buf->send_buf + send_tx_buf->head_ptr, data, len);
-        send_tx_buf->head_ptr += len;
+    if (huart->hdmatx == NULL) {
+        if (HAL_UART_Transmit(huart, (uint8_t *)ptr, (uint16_t)len,
+                              HAL_MAX_DELAY) != HAL_OK) {
+            errno = EIO;
+            return -1;
+        }
         return len;
     }
-}
 
-/**
- * @brief Transmit the data in the buf.
- *
- * @param huart The handle of UART.
- * @return The length which is succeed transmitted.
- * @note If you want transmit data, using `uart_dmatx_write` before.
- *       If you have huge continous data to transmit, we recommand use
- *       `HAL_UART_Transmit_DMA()`.
- */
-uint32_t uart_dmatx_send(UART_HandleTypeDef *huart) {
-    uart_tx_buf_t *send_tx_buf = uart_tx_identify(huart);
-    if (send_tx_buf == NULL) {
-        return 0;
-    }
+    int written = 0;
+    uint32_t n;
 
-    if (huart->hdmatx == NULL) {
-        return 0;
-    }
+    while (written < len) {
+        n = uart_dmatx_write(huart, ptr + written, (size_t)(len - written));
+        written += (int)n;
 
-    uint32_t len = send_tx_buf->head_ptr;
-    if (len == 0) {
-        return 0;
+        if (written < len) {
+            /* The buffer is full, send it and wait for the other bank. */
+            uart_dmatx_send(huart);
+            if ((__get_IPSR() != 0) || (__get_PRIMASK() != 0)) {
+                break;
+            }
+
+            if (n == 0) {
+                __WFI();
+            }
+        }
     }
 
-    /* Wait for last transfer end. */
-    while (__HAL_UART_GET_FLAG(huart, UART_FLAG_TC) == RESET)
-        ;
+    uart_dmatx_send(huart);
 
-    HAL_UART_Transmit_DMA(huart, send_tx_buf->send_buf, (uint16_t)len);
-    send_tx_buf->head_ptr = 0;
-    return len;
+    if ((written == 0) && (len != 0)) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    return written;
 }
 
 /**
- * @brief Resize the send buf of UART.
+ * @brief Newlib read syscall, stdin is received by UART.
  *
- * @param huart The handle of UART
- * @param size New size
- * @return Resize message:
- *  @retval - 0: Success
- *  @retval - 1: This uart not enable DMA Tx.
- *  @retval - 2: No free memory to allocate.
- *  @retval - 3: This uart is busy now.
- *  @retval - 4: Parameter error, size can't be 0.
+ * @param file The file descriptor.
+ * @param[out] ptr The data buf.
+ * @param len The size of buf.
+ * @return The length that be read, -1 on error.
+ * @note Wait until at least one byte is received. With DMA Rx (or interrupt
+ *       Rx) it returns what the fifo has, it does not wait to fill `ptr`.
  */
-uint8_t uart_dmatx_resize_buf(UART_HandleTypeDef *huart, uint32_t size) {
-    if (size == 0) {
-        return 4;
-    }
-
-    uart_tx_buf_t *send_tx_buf = uart_tx_identify(huart);
-    if (send_tx_buf == NULL) {
-        return 1;
-    }
+int _read(int file, char *ptr, int len) {
+    UART_HandleTypeDef *huart = UART_STDIO;
+    uint16_t rx_len = 0;
 
-    if ((huart->gState) & (HAL_UART_STATE_BUSY_TX | HAL_UART_STATE_BUSY) &
-        ~HAL_UART_STATE_READY) {
-        /* The UART is busy. */
-        return 3;
+    if (file != UART_STDIN_FILENO) {
+        errno = EBADF;
+        return -1;
     }
 
-    /* The UART is uninitialized, just adjust the size. */
-    if (huart->hdmatx == NULL) {
-        send_tx_buf->buf_size = size;
+    if (len <= 0) {
         return 0;
     }
 
-    uint8_t *new_ptr = CSP_REALLOC(send_tx_buf->send_buf, size);
-
-    if (new_ptr == NULL) {
-        return 2;
+    if (uart_rx_identify(huart) != NULL) {
+        return (int)uart_dmarx_read_timeout(huart, ptr, (size_t)len, 1, -1,
+                                            HAL_MAX_DELAY);
     }
 
-    send_tx_buf->send_buf = new_ptr;
-    send_tx_buf->buf_size = size;
+    if (HAL_UARTEx_ReceiveToIdle(huart, (uint8_t *)ptr, (uint16_t)len,
+                                 &rx_len, HAL_MAX_DELAY) != HAL_OK) {
+        errno = EIO;
+        return -1;
+    }
 
-    return 0;
+    return rx_len;
 }
 
 /**
- * @brief Get the buffer size of UART DMA Tx.
+ * @brief Newlib isatty syscall, stdin, stdout and stderr are the UART.
  *
- * @param huart The handle of UART.
- * @return The size of UART DMA Tx buf.
+ * @param file The file descriptor.
+ * @return 1 if it is a terminal.
+ * @note Weak, the `syscalls.c` generated by STM32CubeIDE defines it too.
  */
-uint32_t uart_damtx_get_buf_szie(UART_HandleTypeDef *huart) {
-    uart_tx_buf_t *uart_tx_buf = uart_tx_identify(huart);
-
-    if (uart_tx_buf == NULL) {
-        return 0;
+__weak int _isatty(int file) {
+    if ((file == UART_STDIN_FILENO) || (file == UART_STDOUT_FILENO) ||
+        (file == UART_STDERR_FILENO)) {
+        return 1;
     }
 
-    return uart_tx_buf->buf_size;
+    errno = EBADF;
+    return 0;
 }
 
+#endif /* UART_STDIO */
+
 /**
  * @}
  */
@@ -2450,6 +6740,17 @@ void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
         return;
     }
 
+#if UART_STATS_ENABLE
+    uart_stats_t *uart_stats = uart_stats_identify(huart);
+    if (uart_stats != NULL) {
+        uart_stats->pe_errors += (error_code & HAL_UART_ERROR_PE) ? 1 : 0;
+        uart_stats->ne_errors += (error_code & HAL_UART_ERROR_NE) ? 1 : 0;
+        uart_stats->fe_errors += (error_code & HAL_UART_ERROR_FE) ? 1 : 0;
+        uart_stats->ore_errors += (error_code & HAL_UART_ERROR_ORE) ? 1 : 0;
+        uart_stats->dma_errors += (error_code & HAL_UART_ERROR_DMA) ? 1 : 0;
+    }
+#endif /* UART_STATS_ENABLE */
+
     switch (error_code) {
         case HAL_UART_ERROR_PE: {
             __HAL_UART_CLEAR_PEFLAG(huart);
@@ -2474,20 +6775,51 @@ void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
         } break;
     }
 
+    uart_tx_buf_t *send_tx_buf = uart_tx_identify(huart);
+
+    if ((error_code & HAL_UART_ERROR_DMA) && (send_tx_buf != NULL) &&
+        send_tx_buf->busy && (huart->gState == HAL_UART_STATE_READY)) {
+        /* DMA Tx is aborted, the transfer complete callback never comes.
+         * A descriptor is sent again, an aborted bank is lost. */
+        send_tx_buf->busy = 0;
+        send_tx_buf->xfer_desc = 0;
+        uart_bus_rx_resume(huart);
+        uart_dmatx_kick(huart, send_tx_buf);
+    }
+
+    uart_rx_fifo_t *uart_rx_fifo = uart_rx_identify(huart);
+
+    if ((NULL == huart->hdmarx) && (uart_rx_fifo != NULL)) {
+        /* Received by interrupt, HAL has disabled the Rx interrupts. */
+        if (READ_BIT(huart->Instance->CR1, USART_CR1_FIFOEN)) {
+            __HAL_UART_ENABLE_IT(huart, UART_IT_RXFT);
+        } else {
+            __HAL_UART_ENABLE_IT(huart, UART_IT_RXNE);
+        }
+        if (huart->Init.Parity != UART_PARITY_NONE) {
+            __HAL_UART_ENABLE_IT(huart, UART_IT_PE);
+        }
+        __HAL_UART_ENABLE_IT(huart, UART_IT_ERR);
+        return;
+    }
+
     if (NULL != huart->hdmarx) {
-        while (
-            HAL_UART_Receive_DMA(huart, huart->pRxBuffPtr, huart->RxXferSize)) {
-            __HAL_UNLOCK(huart);
+        if ((uart_rx_fifo == NULL) ||
+            ((huart->RxState == HAL_UART_STATE_BUSY_RX) &&
+             READ_BIT(huart->hdmarx->Instance->CCR, DMA_CCR_EN))) {
+            /* DMA Rx is still running. */
+            return;
         }
+
+        uart_dmarx_restart(huart, uart_rx_fifo);
     } else {
         /* Reset the receive pointer to buffer init address.
          * Init addr = current addr - received count,
-         * received count = buffer size - free count. */
-        while (HAL_UART_Receive_IT(
+         * received count = buffer size - free count.
+         * Try once, never wait in interrupt. */
+        HAL_UART_Receive_IT(
             huart, huart->pRxBuffPtr - (huart->RxXferSize - huart->RxXferCount),
-            huart->RxXferSize)) {
-            __HAL_UNLOCK(huart);
-        }
+            huart->RxXferSize);
     }
 }
 
@@ -2515,6 +6847,17 @@ void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart) {
     }
 }
 
+/**
+ * @brief Tx Transfer completed callbacks.
+ *
+ * @param huart The handle of UART.
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    if (huart->hdmatx != NULL) {
+        uart_dmatx_done_callback(huart);
+    }
+}
+
 #endif /* USE_HAL_UART_REGISTER_CALLBACKS == 0 */
 
 /**
@@ -32,6 +32,117 @@ extern "C" {
 #define UART_DEINIT_DMA_FAIL 2
 #define UART_NO_INIT         3
 
+#define UART_PRINTF_DROP     0
+#define UART_PRINTF_TRUNCATE 1
+#define UART_PRINTF_BLOCK    2
+
+#define UART_FRAME_NONE      0x00U /*!< Framing stage is disabled.         */
+#define UART_FRAME_COBS      0x01U /*!< COBS, frames end with 0x00.        */
+#define UART_FRAME_SLIP      0x02U /*!< SLIP (RFC 1055), frames end with 0xC0. */
+#define UART_FRAME_MODBUS    0x03U /*!< Modbus RTU, frames end with 3.5 char gap. */
+#define UART_FRAME_CRC16     0x80U /*!< Frames end with CRC16-CCITT.       */
+
+#define UART_CLOCK_PCLK      0U /*!< Kernel clock from APB clock. */
+#define UART_CLOCK_SYSCLK    1U /*!< Kernel clock from SYSCLK.    */
+#define UART_CLOCK_HSI       2U /*!< Kernel clock from HSI16.     */
+#define UART_CLOCK_LSE       3U /*!< Kernel clock from LSE.       */
+
+#define UART_LOG_SYNC        0xA5U /*!< The first byte of binary log record. */
+#define UART_LOG_HEAD_SIZE   10U   /*!< sync, nargs, ID, timestamp.          */
+
+/**
+ * @}
+ */
+
+/*****************************************************************************
+ * @defgroup UART Public Types.
+ * @{
+ */
+
+/**
+ * @brief Readable region of the DMA receive buffer (zero-copy mode).
+ * @note The region is split into two spans when it wraps around the end of
+ *       the circular buffer, `len[1]` is 0 if it does not wrap.
+ */
+typedef struct {
+    const uint8_t *buf[2]; /*!< Start of each span.  */
+    uint32_t len[2];       /*!< Length of each span. */
+} uart_rx_span_t;
+
+/**
+ * @brief Line reader of UART, the state is kept across calls.
+ * @note Initialize it with `uart_line_init`. The buffer is owned by caller.
+ */
+typedef struct {
+    char *buf;        /*!< Line buffer.                                    */
+    uint32_t size;    /*!< Size of `buf`, one byte is kept for '\0'.      */
+    uint32_t len;     /*!< Bytes in `buf`.                                 */
+    uint32_t scan;    /*!< Bytes in `buf` that have no delimiter.          */
+    uint32_t line;    /*!< Length of the line returned last time, it is
+                           removed at the next call.                       */
+    uint32_t dropped; /*!< Bytes of the lines that longer than `buf`.      */
+    uint8_t overflow; /*!< Discard until the next delimiter.               */
+} uart_line_t;
+
+/**
+ * @brief Callback when a queued buffer is transmitted.
+ *
+ * @param huart The handle of UART.
+ * @param data The buffer passed to `uart_dmatx_enqueue`.
+ * @param len The length of buffer.
+ * @param arg The argument passed to `uart_dmatx_enqueue`.
+ * @note Called in interrupt context, the buffer is owned by caller again.
+ */
+typedef void (*uart_tx_cplt_cb_t)(UART_HandleTypeDef *huart, const void *data,
+                                  size_t len, void *arg);
+
+/**
+ * @brief Baud rate settings found by `uart_baud_plan`.
+ */
+typedef struct {
+    uint32_t baud_rate;    /*!< Actual baud rate.                    */
+    int32_t error_ppm;     /*!< Error from the required baud rate.   */
+    uint32_t kernel_clock; /*!< Frequency of kernel clock.           */
+    uint32_t brr;          /*!< Value of BRR register.               */
+    uint8_t clock_source;  /*!< `UART_CLOCK_xxx`.                    */
+    uint8_t prescaler;     /*!< `UART_PRESCALER_DIVx`.               */
+    uint8_t over8;         /*!< 8x oversampling with one bit sample. */
+} uart_baud_plan_t;
+
+/**
+ * @brief Statistics of UART.
+ */
+typedef struct {
+    uint32_t rx_bytes;     /*!< Bytes received.                        */
+    uint32_t tx_bytes;     /*!< Bytes sent.                            */
+    uint32_t rx_dropped;   /*!< Bytes dropped, fifo or buf is full,
+                                overrun or discarded on DMA restart.   */
+    uint32_t rx_max_fill;  /*!< Max unread bytes in fifo (or buf).     */
+    uint32_t idle_events;  /*!< IDLE events of DMA Rx.                 */
+    uint32_t half_events;  /*!< Half transfer events of DMA Rx.        */
+    uint32_t done_events;  /*!< Transfer complete events of DMA Rx.    */
+    uint32_t pe_errors;    /*!< Parity errors.                         */
+    uint32_t ne_errors;    /*!< Noise errors.                          */
+    uint32_t fe_errors;    /*!< Frame errors.                          */
+    uint32_t ore_errors;   /*!< Overrun errors.                        */
+    uint32_t dma_errors;   /*!< DMA errors.                            */
+    uint32_t dma_restarts; /*!< Restarts of DMA Rx.                    */
+} uart_stats_t;
+
+/**
+ * @brief Callback when a complete frame is received.
+ *
+ * @param huart The handle of UART.
+ * @param frame The decoded frame, CRC is removed.
+ * @param len The length of frame.
+ * @param arg The argument passed to `uart_dmarx_set_frame`.
+ * @note Called in interrupt context, the frame is overwritten by the next
+ *       one once it returns.
+ */
+typedef void (*uart_rx_frame_cb_t)(UART_HandleTypeDef *huart,
+                                   const uint8_t *frame, uint32_t len,
+                                   void *arg);
+
 /**
  * @}
  */
@@ -108,7 +219,40 @@ uint8_t lpuart1_deinit(void);
       CSP_DMA_CHANNEL_IRQ(LPUART1_RX_DMA_NUMBER, LPUART1_RX_DMA_CHANNEL)
 #  endif /* LPUART1_RX_DMA */
 
+#  if LPUART1_FIFO_ENABLE && !LPUART1_IT_ENABLE
+#    error "LPUART1 FIFO needs LPUART1 interrupt to drain and refill it! "
+#  endif /* LPUART1_FIFO_ENABLE && !LPUART1_IT_ENABLE */
+
+#  if (LPUART1_BUS_MODE == 1) && !LPUART1_RTS
+#    error "LPUART1 RS-485 mode needs LPUART1 RTS pin as DE! "
+#  endif /* (LPUART1_BUS_MODE == 1) && !LPUART1_RTS */
+
+#  if LPUART1_MUTE_MODE && (LPUART1_MUTE_ADDRESS > (LPUART1_MUTE_ADDR_7BIT ? 127 : 15))
+#    error "LPUART1 mute mode address is out of range! "
+#  endif /* LPUART1_MUTE_MODE */
+
+#  if LPUART1_CHAR_MATCH
+#    if !LPUART1_IT_ENABLE
+#      error "LPUART1 character match needs LPUART1 interrupt! "
+#    endif /* !LPUART1_IT_ENABLE */
+#    if LPUART1_MUTE_MODE && (LPUART1_MUTE_WAKEUP == 0)
+#      error "LPUART1 character match and address mark mute mode both use the address register! "
+#    endif /* LPUART1_MUTE_MODE && (LPUART1_MUTE_WAKEUP == 0) */
+#  endif /* LPUART1_CHAR_MATCH */
+
+#  if LPUART1_RX_IT
+#    if LPUART1_RX_DMA
+#      error "LPUART1 can not receive by DMA and interrupt at the same time! "
+#    endif /* LPUART1_RX_DMA */
+#    if !LPUART1_IT_ENABLE
+#      error "LPUART1 interrupt Rx needs LPUART1 interrupt! "
+#    endif /* !LPUART1_IT_ENABLE */
+#  endif /* LPUART1_RX_IT */
+
 #  if LPUART1_TX_DMA
+#    if !LPUART1_IT_ENABLE
+#      error "LPUART1 DMA Tx needs LPUART1 interrupt to chain the transfers! "
+#    endif /* !LPUART1_IT_ENABLE */
 #    define LPUART1_TX_DMA_IRQn                                                  \
       CSP_DMA_CHANNEL_IRQn(LPUART1_TX_DMA_NUMBER, LPUART1_TX_DMA_CHANNEL)
 #    define LPUART1_TX_DMA_IRQHandler                                             \
@@ -186,7 +330,40 @@ uint8_t usart1_deinit(void);
       CSP_DMA_CHANNEL_IRQ(USART1_RX_DMA_NUMBER, USART1_RX_DMA_CHANNEL)
 #  endif /* USART1_RX_DMA */
 
+#  if USART1_FIFO_ENABLE && !USART1_IT_ENABLE
+#    error "USART1 FIFO needs USART1 interrupt to drain and refill it! "
+#  endif /* USART1_FIFO_ENABLE && !USART1_IT_ENABLE */
+
+#  if (USART1_BUS_MODE == 1) && !USART1_RTS
+#    error "USART1 RS-485 mode needs USART1 RTS pin as DE! "
+#  endif /* (USART1_BUS_MODE == 1) && !USART1_RTS */
+
+#  if USART1_MUTE_MODE && (USART1_MUTE_ADDRESS > (USART1_MUTE_ADDR_7BIT ? 127 : 15))
+#    error "USART1 mute mode address is out of range! "
+#  endif /* USART1_MUTE_MODE */
+
+#  if USART1_CHAR_MATCH
+#    if !USART1_IT_ENABLE
+#      error "USART1 character match needs USART1 interrupt! "
+#    endif /* !USART1_IT_ENABLE */
+#    if USART1_MUTE_MODE && (USART1_MUTE_WAKEUP == 0)
+#      error "USART1 character match and address mark mute mode both use the address register! "
+#    endif /* USART1_MUTE_MODE && (USART1_MUTE_WAKEUP == 0) */
+#  endif /* USART1_CHAR_MATCH */
+
+#  if USART1_RX_IT
+#    if USART1_RX_DMA
+#      error "USART1 can not receive by DMA and interrupt at the same time! "
+#    endif /* USART1_RX_DMA */
+#    if !USART1_IT_ENABLE
+#      error "USART1 interrupt Rx needs USART1 interrupt! "
+#    endif /* !USART1_IT_ENABLE */
+#  endif /* USART1_RX_IT */
+
 #  if USART1_TX_DMA
+#    if !USART1_IT_ENABLE
+#      error "USART1 DMA Tx needs USART1 interrupt to chain the transfers! "
+#    endif /* !USART1_IT_ENABLE */
 #    define USART1_TX_DMA_IRQn                                                  \
       CSP_DMA_CHANNEL_IRQn(USART1_TX_DMA_NUMBER, USART1_TX_DMA_CHANNEL)
 #    define USART1_TX_DMA_IRQHandler                                             \
@@ -266,7 +443,40 @@ uint8_t usart2_deinit(void);
       CSP_DMA_CHANNEL_IRQ(USART2_RX_DMA_NUMBER, USART2_RX_DMA_CHANNEL)
 #  endif /* USART2_RX_DMA */
 
+#  if USART2_FIFO_ENABLE && !USART2_IT_ENABLE
+#    error "USART2 FIFO needs USART2 interrupt to drain and refill it! "
+#  endif /* USART2_FIFO_ENABLE && !USART2_IT_ENABLE */
+
+#  if (USART2_BUS_MODE == 1) && !USART2_RTS
+#    error "USART2 RS-485 mode needs USART2 RTS pin as DE! "
+#  endif /* (USART2_BUS_MODE == 1) && !USART2_RTS */
+
+#  if USART2_MUTE_MODE && (USART2_MUTE_ADDRESS > (USART2_MUTE_ADDR_7BIT ? 127 : 15))
+#    error "USART2 mute mode address is out of range! "
+#  endif /* USART2_MUTE_MODE */
+
+#  if USART2_CHAR_MATCH
+#    if !USART2_IT_ENABLE
+#      error "USART2 character match needs USART2 interrupt! "
+#    endif /* !USART2_IT_ENABLE */
+#    if USART2_MUTE_MODE && (USART2_MUTE_WAKEUP == 0)
+#      error "USART2 character match and address mark mute mode both use the address register! "
+#    endif /* USART2_MUTE_MODE && (USART2_MUTE_WAKEUP == 0) */
+#  endif /* USART2_CHAR_MATCH */
+
+#  if USART2_RX_IT
+#    if USART2_RX_DMA
+#      error "USART2 can not receive by DMA and interrupt at the same time! "
+#    endif /* USART2_RX_DMA */
+#    if !USART2_IT_ENABLE
+#      error "USART2 interrupt Rx needs USART2 interrupt! "
+#    endif /* !USART2_IT_ENABLE */
+#  endif /* USART2_RX_IT */
+
 #  if USART2_TX_DMA
+#    if !USART2_IT_ENABLE
+#      error "USART2 DMA Tx needs USART2 interrupt to chain the transfers! "
+#    endif /* !USART2_IT_ENABLE */
 #    define USART2_TX_DMA_IRQn                                                  \
       CSP_DMA_CHANNEL_IRQn(USART2_TX_DMA_NUMBER, USART2_TX_DMA_CHANNEL)
 #    define USART2_TX_DMA_IRQHandler                                             \
@@ -364,7 +574,40 @@ uint8_t usart3_deinit(void);
       CSP_DMA_CHANNEL_IRQ(USART3_RX_DMA_NUMBER, USART3_RX_DMA_CHANNEL)
 #  endif /* USART3_RX_DMA */
 
+#  if USART3_FIFO_ENABLE && !USART3_IT_ENABLE
+#    error "USART3 FIFO needs USART3 interrupt to drain and refill it! "
+#  endif /* USART3_FIFO_ENABLE && !USART3_IT_ENABLE */
+
+#  if (USART3_BUS_MODE == 1) && !USART3_RTS
+#    error "USART3 RS-485 mode needs USART3 RTS pin as DE! "
+#  endif /* (USART3_BUS_MODE == 1) && !USART3_RTS */
+
+#  if USART3_MUTE_MODE && (USART3_MUTE_ADDRESS > (USART3_MUTE_ADDR_7BIT ? 127 : 15))
+#    error "USART3 mute mode address is out of range! "
+#  endif /* USART3_MUTE_MODE */
+
+#  if USART3_CHAR_MATCH
+#    if !USART3_IT_ENABLE
+#      error "USART3 character match needs USART3 interrupt! "
+#    endif /* !USART3_IT_ENABLE */
+#    if USART3_MUTE_MODE && (USART3_MUTE_WAKEUP == 0)
+#      error "USART3 character match and address mark mute mode both use the address register! "
+#    endif /* USART3_MUTE_MODE && (USART3_MUTE_WAKEUP == 0) */
+#  endif /* USART3_CHAR_MATCH */
+
+#  if USART3_RX_IT
+#    if USART3_RX_DMA
+#      error "USART3 can not receive by DMA and interrupt at the same time! "
+#    endif /* USART3_RX_DMA */
+#    if !USART3_IT_ENABLE
+#      error "USART3 interrupt Rx needs USART3 interrupt! "
+#    endif /* !USART3_IT_ENABLE */
+#  endif /* USART3_RX_IT */
+
 #  if USART3_TX_DMA
+#    if !USART3_IT_ENABLE
+#      error "USART3 DMA Tx needs USART3 interrupt to chain the transfers! "
+#    endif /* !USART3_IT_ENABLE */
 #    define USART3_TX_DMA_IRQn                                                  \
       CSP_DMA_CHANNEL_IRQn(USART3_TX_DMA_NUMBER, USART3_TX_DMA_CHANNEL)
 #    define USART3_TX_DMA_IRQHandler                                             \
@@ -428,7 +671,40 @@ uint8_t uart4_deinit(void);
       CSP_DMA_CHANNEL_IRQ(UART4_RX_DMA_NUMBER, UART4_RX_DMA_CHANNEL)
 #  endif /* UART4_RX_DMA */
 
+#  if UART4_FIFO_ENABLE && !UART4_IT_ENABLE
+#    error "UART4 FIFO needs UART4 interrupt to drain and refill it! "
+#  endif /* UART4_FIFO_ENABLE && !UART4_IT_ENABLE */
+
+#  if (UART4_BUS_MODE == 1) && !UART4_RTS
+#    error "UART4 RS-485 mode needs UART4 RTS pin as DE! "
+#  endif /* (UART4_BUS_MODE == 1) && !UART4_RTS */
+
+#  if UART4_MUTE_MODE && (UART4_MUTE_ADDRESS > (UART4_MUTE_ADDR_7BIT ? 127 : 15))
+#    error "UART4 mute mode address is out of range! "
+#  endif /* UART4_MUTE_MODE */
+
+#  if UART4_CHAR_MATCH
+#    if !UART4_IT_ENABLE
+#      error "UART4 character match needs UART4 interrupt! "
+#    endif /* !UART4_IT_ENABLE */
+#    if UART4_MUTE_MODE && (UART4_MUTE_WAKEUP == 0)
+#      error "UART4 character match and address mark mute mode both use the address register! "
+#    endif /* UART4_MUTE_MODE && (UART4_MUTE_WAKEUP == 0) */
+#  endif /* UART4_CHAR_MATCH */
+
+#  if UART4_RX_IT
+#    if UART4_RX_DMA
+#      error "UART4 can not receive by DMA and interrupt at the same time! "
+#    endif /* UART4_RX_DMA */
+#    if !UART4_IT_ENABLE
+#      error "UART4 interrupt Rx needs UART4 interrupt! "
+#    endif /* !UART4_IT_ENABLE */
+#  endif /* UART4_RX_IT */
+
 #  if UART4_TX_DMA
+#    if !UART4_IT_ENABLE
+#      error "UART4 DMA Tx needs UART4 interrupt to chain the transfers! "
+#    endif /* !UART4_IT_ENABLE */
 #    define UART4_TX_DMA_IRQn                                                  \
       CSP_DMA_CHANNEL_IRQn(UART4_TX_DMA_NUMBER, UART4_TX_DMA_CHANNEL)
 #    define UART4_TX_DMA_IRQHandler                                             \
@@ -492,7 +768,40 @@ uint8_t uart5_deinit(void);
       CSP_DMA_CHANNEL_IRQ(UART5_RX_DMA_NUMBER, UART5_RX_DMA_CHANNEL)
 #  endif /* UART5_RX_DMA */
 
+#  if UART5_FIFO_ENABLE && !UART5_IT_ENABLE
+#    error "UART5 FIFO needs UART5 interrupt to drain and refill it! "
+#  endif /* UART5_FIFO_ENABLE && !UART5_IT_ENABLE */
+
+#  if (UART5_BUS_MODE == 1) && !UART5_RTS
+#    error "UART5 RS-485 mode needs UART5 RTS pin as DE! "
+#  endif /* (UART5_BUS_MODE == 1) && !UART5_RTS */
+
+#  if UART5_MUTE_MODE && (UART5_MUTE_ADDRESS > (UART5_MUTE_ADDR_7BIT ? 127 : 15))
+#    error "UART5 mute mode address is out of range! "
+#  endif /* UART5_MUTE_MODE */
+
+#  if UART5_CHAR_MATCH
+#    if !UART5_IT_ENABLE
+#      error "UART5 character match needs UART5 interrupt! "
+#    endif /* !UART5_IT_ENABLE */
+#    if UART5_MUTE_MODE && (UART5_MUTE_WAKEUP == 0)
+#      error "UART5 character match and address mark mute mode both use the address register! "
+#    endif /* UART5_MUTE_MODE && (UART5_MUTE_WAKEUP == 0) */
+#  endif /* UART5_CHAR_MATCH */
+
+#  if UART5_RX_IT
+#    if UART5_RX_DMA
+#      error "UART5 can not receive by DMA and interrupt at the same time! "
+#    endif /* UART5_RX_DMA */
+#    if !UART5_IT_ENABLE
+#      error "UART5 interrupt Rx needs UART5 interrupt! "
+#    endif /* !UART5_IT_ENABLE */
+#  endif /* UART5_RX_IT */
+
 #  if UART5_TX_DMA
+#    if !UART5_IT_ENABLE
+#      error "UART5 DMA Tx needs UART5 interrupt to chain the transfers! "
+#    endif /* !UART5_IT_ENABLE */
 #    define UART5_TX_DMA_IRQn                                                  \
       CSP_DMA_CHANNEL_IRQn(UART5_TX_DMA_NUMBER, UART5_TX_DMA_CHANNEL)
 #    define UART5_TX_DMA_IRQHandler                                             \
@@ -514,17 +823,128 @@ int uart_printf(UART_HandleTypeDef *huart, const char *__format, ...);
 int uart_scanf(UART_HandleTypeDef *huart, const char *__format, ...);
 
 uint32_t uart_dmarx_read(UART_HandleTypeDef *huart, void *buf, size_t len);
+uint32_t uart_dmarx_read_timeout(UART_HandleTypeDef *huart, void *buf,
+                                 size_t buf_size, size_t min_len, int delim,
+                                 uint32_t timeout);
+void uart_dmarx_wait(UART_HandleTypeDef *huart, uint32_t timeout);
+void uart_dmarx_signal(UART_HandleTypeDef *huart);
 uint8_t uart_dmarx_resize_fifo(UART_HandleTypeDef *huart, uint32_t buf_size,
                                uint32_t fifo_size);
 uint32_t uart_dmarx_get_buf_size(UART_HandleTypeDef *huart);
 uint32_t uart_dmarx_get_fifo_size(UART_HandleTypeDef *huart);
+uint32_t uart_dmarx_peek(UART_HandleTypeDef *huart, uart_rx_span_t *span);
+uint32_t uart_dmarx_commit(UART_HandleTypeDef *huart, uint32_t len);
+uint8_t uart_dmarx_set_frame(UART_HandleTypeDef *huart, uint8_t mode,
+                             uint8_t *buf, uint32_t size,
+                             uart_rx_frame_cb_t callback, void *arg);
 
 uint32_t uart_dmatx_write(UART_HandleTypeDef *huart, const void *data,
                           size_t len);
 uint32_t uart_dmatx_send(UART_HandleTypeDef *huart);
+uint8_t uart_dmatx_enqueue(UART_HandleTypeDef *huart, const void *data,
+                           size_t len, uart_tx_cplt_cb_t callback, void *arg);
 uint8_t uart_dmatx_resize_buf(UART_HandleTypeDef *huart, uint32_t size);
 uint32_t uart_damtx_get_buf_szie(UART_HandleTypeDef *huart);
 
+void uart_line_init(uart_line_t *line, char *buf, uint32_t size);
+char *uart_read_until(UART_HandleTypeDef *huart, uart_line_t *line,
+                      uint8_t delim, uint32_t *len);
+char *uart_readline(UART_HandleTypeDef *huart, uart_line_t *line,
+                    uint32_t *len, uint32_t timeout);
+uint32_t uart_tokenize(char *str, const char *delims, char *argv[],
+                       uint32_t max_args);
+
+void uart_stdio_init(void);
+
+uint8_t uart_bridge(UART_HandleTypeDef *from, UART_HandleTypeDef *to,
+                    uint8_t flow_control);
+
+uint8_t uart_modbus_start(UART_HandleTypeDef *huart, uint8_t *buf,
+                          uint32_t size, uart_rx_frame_cb_t callback,
+                          void *arg);
+uint8_t uart_modbus_stop(UART_HandleTypeDef *huart);
+uint8_t uart_modbus_reply(UART_HandleTypeDef *huart, const void *data,
+                          size_t len);
+
+uint8_t uart_mute_config(UART_HandleTypeDef *huart, uint8_t idle_line,
+                         uint8_t addr_7bit, uint8_t address);
+uint8_t uart_mute(UART_HandleTypeDef *huart);
+uint8_t uart_set_match_char(UART_HandleTypeDef *huart, int match_char);
+
+uint8_t uart_baud_plan(UART_HandleTypeDef *huart, uint32_t baud_rate,
+                       uart_baud_plan_t *plan);
+uint32_t uart_baud_max(UART_HandleTypeDef *huart);
+uint8_t uart_set_baud(UART_HandleTypeDef *huart, uint32_t baud_rate,
+                      uart_baud_plan_t *plan);
+
+#if UART_RX_TIMESTAMP
+uint32_t uart_dmarx_read_ts(UART_HandleTypeDef *huart, void *buf,
+                            size_t buf_size, uint32_t *first_ts,
+                            uint32_t *last_ts);
+#endif /* UART_RX_TIMESTAMP */
+
+#if UART_STATS_ENABLE
+uint8_t uart_get_stats(UART_HandleTypeDef *huart, uart_stats_t *stats);
+uint8_t uart_reset_stats(UART_HandleTypeDef *huart);
+#endif /* UART_STATS_ENABLE */
+
+#if UART_LOG_ENABLE
+
+uint8_t uart_log_write(UART_HandleTypeDef *huart, const char *fmt,
+                       const uint32_t *args, uint32_t nargs);
+
+/**
+ * @brief Pass a float argument to `uart_log` without conversion.
+ *
+ * @param value The float value.
+ * @return The bits of value.
+ */
+static inline uint32_t uart_log_f32(float value) {
+    union {
+        float f;
+        uint32_t u;
+    } bits = {.f = value};
+
+    return bits.u;
+}
+
+#ifdef __cplusplus
+#define UART_LOG_STATIC_ASSERT static_assert
+#else /* __cplusplus */
+#define UART_LOG_STATIC_ASSERT _Static_assert
+#endif /* __cplusplus */
+
+/**
+ * @brief Send a binary log record through DMA Tx.
+ *
+ * @param huart The handle of UART.
+ * @param fmt The format string, must be a string literal.
+ * @param ... The arguments, up to `UART_LOG_MAX_ARGS` 32-bit integers. Cast
+ *            pointers to `uint32_t`, pass floats with `uart_log_f32`. More
+ *            arguments fail to compile.
+ * @note The format string is placed in `.uart_log_fmt` section and is never
+ *       sent, its address is the ID of record. Keep it out of flash with
+ *       `.uart_log_fmt 0 (INFO) : { KEEP(*(.uart_log_fmt)) }` in the linker
+ *       script.
+ */
+#define uart_log(huart, fmt, ...)                                              \
+    do {                                                                       \
+        static const char uart_log_fmt_str[]                                   \
+            __attribute__((section(".uart_log_fmt"), used)) = fmt;             \
+        const uint32_t uart_log_args[] = {0, ##__VA_ARGS__};                   \
+        UART_LOG_STATIC_ASSERT(sizeof(uart_log_args) / sizeof(uint32_t) - 1 <= \
+                                   UART_LOG_MAX_ARGS,                          \
+                               "uart_log: more than UART_LOG_MAX_ARGS");       \
+        uart_log_write((huart), uart_log_fmt_str, uart_log_args + 1,           \
+                       sizeof(uart_log_args) / sizeof(uint32_t) - 1);          \
+    } while (0)
+
+#else /* UART_LOG_ENABLE */
+
+#define uart_log(huart, fmt, ...) ((void)(huart))
+
+#endif /* UART_LOG_ENABLE */
+
 /**
  * @}
  */